@@ -1,11 +1,70 @@
 #pragma once
 #include <Arduino.h>
 
+// Print every scene ID at BUILD. Turn off when timing with the event trace
+// (Trace.h); the printf load skews packet timing.
+#define SCENE_LOG_VERBOSE 1
+
+// Prefer clips the Sides report as resident (no SD read) when building scenes.
+// Toggle at runtime with serial 'c'.
+#define CACHE_AWARE_SCENES 1
+#define SIDE_INFO_STALE_MS 20000   // ignore a Side's cache report older than this
+
+// Sound feedback layered over the Sides' loops (PLAY_ONESHOT). Manifest clip
+// IDs, 0 = off; keep them precached or in the soundbank (Sides refuse one-shots
+// that would stream from SD).
+#define STING_CORRECT_ID 0
+#define STING_WRONG_ID   0
+#define TICK_ID          0
+#define TICK_LAST_MS     5000   // tick once a second during the last N ms of a pick
+
 // WiFi/ESP-NOW
 #define WIFI_CHANNEL 6
 
+// Idle power. Sides with IDLE_LIGHT_SLEEP nap for IDLE_NAP_MS (ConfigSide.h)
+// at a time and miss packets meanwhile, so before a game or a job the Master
+// pings HELLO_REQ until each Side answers. Keep the timeout above their nap.
+#define SIDE_WAKE_TIMEOUT_MS  600
+#define SIDE_WAKE_PING_MS     10
+#define MASTER_IDLE_POLL_MS   10    // loop() period while no game runs
+
 // Fill with your Side Feathers' STA MACs (print on Sides at boot)
 static uint8_t SIDE_A_MAC[6] = {0x7C,0xDF,0xA1,0xF8,0xF1,0x40};
 static uint8_t SIDE_B_MAC[6] = {0x7C,0xDF,0xA1,0xF8,0xF0,0x4C};
 
+// One row per table (GameSession): its Side A and Side B. A MAC may appear in
+// one row only. Serial '0'..'9' picks the session 's' and 'e' act on. OTA
+// ('u','a','b') addresses the first row's pair; the firmware relay (broadcast)
+// tracks every row's Sides.
+static const uint8_t* const SESSION_SIDES[][2] = {
+  { SIDE_A_MAC, SIDE_B_MAC },
+};
+#define MAX_SESSIONS 8   // table rows plus simulated sessions
+
+// Scheduler load test (serial 'J'): adds simulated sessions one at a time,
+// SIM_LOAD_STEP_MS each, and prints the deadline jitter at every count.
+// Simulated players pick after SIM_PICK_MIN_MS..SIM_PICK_MAX_MS, wrongly
+// SIM_WRONG_PCT of the time (a game over restarts the session).
+#define SIM_LOAD_STEP_MS  10000
+#define SIM_PICK_MIN_MS   300
+#define SIM_PICK_MAX_MS   3000
+#define SIM_WRONG_PCT     20
+
+// Side firmware relayed over ESP-NOW (serial 'f'/'F', MasterFwRelay). The
+// Master stages the image in its spare OTA partition, so its partition scheme
+// needs two app slots (the Arduino default has them).
+#define OTA_WIFI_SSID           "AndrewiPhone"
+#define OTA_WIFI_PASS           "12345678"
+#define OTA_CONNECT_TIMEOUT_MS  15000
+#define OTA_HTTP_TIMEOUT_MS     45000
+#define FW_CHUNK_GAP_US         2000    // ~120 KB/s; one broadcast frame of air time at 1 Mbps
+#define FW_CHUNK_BURST          8       // chunks a late tick may send back to back
+#define FW_POLL_MS              250     // FW_OFFER repeat while waiting for FW_NACKs
+#define FW_READY_TIMEOUT_MS     30000   // Sides erase their partition first
+#define FW_SIDE_TIMEOUT_MS      5000    // silent this long during a poll = dropped
+#define FW_MAX_ROUNDS           40      // repair passes before giving up on a Side
+
+// Index of the Sides' SD assets (tools/asset_manifest.py), serial 'y'
+#define ASSET_INDEX_URL   "http://172.20.10.3:8000/assets/assets.idx"
+
 #define OTA_URL_SIDE_BIN  "http://172.20.10.3:8000/Seashells/Seashells_Side/build/esp32.esp32.um_feathers3/Seashells_Side.ino.bin"
@@ -0,0 +1,53 @@
+#pragma once
+#include <Arduino.h>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// One game (one table with its two Sides). The Master runs up to MAX_SESSIONS
+// of them from loop(): every pass ticks each session's state machine once and
+// nothing in a tick blocks, so one table's timers never wait on another's.
+//
+// Deadlines (wake timeout, pick window, result pause) are esp_timer
+// microseconds; how late each one is noticed is the scheduling jitter that
+// serial 'j' reports per session.
+//
+// A simulated session (sim) has no radios behind it: commands to its Sides
+// are answered in place and a simulated player picks after a random delay.
+// The 'J' load test adds them one at a time to measure the jitter under load.
+// ─────────────────────────────────────────────────────────────────────────────
+
+enum State : uint8_t { IDLE, WAKE, BUILD, ANNOUNCE, WAIT, PAUSE };
+
+struct GameSession {
+  uint8_t        id = 0;
+  bool           sim = false;
+  const uint8_t* mac[2] = { nullptr, nullptr };   // Side A, Side B (nullptr when sim)
+  uint8_t        side[2] = { 0, 0 };              // rows of the Master's side table
+
+  // State machine
+  State    state = IDLE;
+  State    nextAfterBlink = IDLE;
+  int64_t  dueUs = 0;            // deadline of the current state
+  uint32_t wakeT0Ms = 0;         // WAKE: pings started, HELLOs after this count
+  uint32_t wakePingMs = 0;
+
+  // Game
+  uint8_t  roundIdx = 0, points = 0, lives = 0;
+  uint32_t t0 = 0;               // millis() when the pick window opened
+  uint32_t curTimeoutMs = 0;
+  uint32_t tickSec = UINT32_MAX; // countdown tick already sent for this second
+
+  // Current scene + odd markers, [0] = Side A, [1] = Side B
+  uint16_t scene[2][4] = {};
+  bool     slotIsOdd[2][4] = {};
+
+  // Last BTN_EVENT, written by the ESP-NOW callback
+  volatile uint8_t pickSide = 255, pickSlot = 255;
+
+  // Simulated player: presses at simPickUs (0 = no press pending)
+  int64_t  simPickUs = 0;
+
+  // Scheduling jitter: lateness of every deadline this session hit
+  uint32_t lateN = 0, lateMaxUs = 0;
+  uint64_t lateSumUs = 0;
+  uint32_t rounds = 0;           // scenes built, to show the session progressed
+};
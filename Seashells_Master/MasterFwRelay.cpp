@@ -0,0 +1,404 @@
+#include "MasterFwRelay.h"
+#include "ConfigMaster.h"
+#include "Messages.h"
+
+#include <WiFi.h>
+#include <esp_now.h>
+#include <esp_wifi.h>
+#include <HTTPClient.h>
+#include <esp_ota_ops.h>
+#include <esp_partition.h>
+#include <mbedtls/sha256.h>
+
+enum Phase : uint8_t { PH_IDLE, PH_OFFER, PH_SEND, PH_POLL, PH_COMMIT };
+
+static constexpr uint8_t  kBcast[6] = {0xFF,0xFF,0xFF,0xFF,0xFF,0xFF};
+static constexpr uint8_t  kUnknown  = 0xFF;   // no FW_NACK heard yet
+static constexpr uint32_t kSector   = 4096;
+static constexpr uint8_t  kMaxSides = MAX_SESSIONS * 2;   // peer index: SESSION_SIDES row s -> 2s (A), 2s+1 (B)
+static_assert(kMaxSides <= 16, "MasterFwRelay_start takes a 16-bit side mask");
+
+// Latest FW_NACK per Side, handed from the ESP-NOW callback to the tick
+struct NackBox {
+  bool     fresh = false;
+  uint8_t  state = 0;
+  uint16_t base = 0, nbits = 0;
+  uint8_t  bitmap[FW_NACK_MAX_BITS / 8];
+};
+
+struct SideXfer {
+  bool     wanted = false;       // in this transfer's mask (reported at the end)
+  bool     active = false;
+  bool     heard = false;        // reported since the current poll began
+  uint8_t  state = kUnknown;
+  uint32_t holes = 0;            // missing chunks in its last report (window only)
+};
+
+static const esp_partition_t* s_stage = nullptr;
+static uint32_t s_size = 0, s_chunks = 0;
+static uint8_t  s_sha[32];
+static bool     s_staged = false;
+
+static Phase    s_phase = PH_IDLE;
+static uint8_t  s_xfer = 0;
+static uint8_t* s_need = nullptr;   // bit per chunk still to send this pass
+static uint32_t s_next = 0;         // send cursor
+static uint32_t s_round = 0, s_sent = 0, s_commits = 0;
+static uint32_t s_t0 = 0, s_phaseT0 = 0, s_lastOfferMs = 0, s_lastChunkUs = 0;
+static SideXfer s_sx[kMaxSides];
+static NackBox  s_box[kMaxSides];
+static portMUX_TYPE s_boxMux = portMUX_INITIALIZER_UNLOCKED;
+
+// "Side 0A": table (SESSION_SIDES row) and A/B
+static const char* sideName(int i) {
+  static char name[12];
+  snprintf(name, sizeof(name), "Side %u%c", (unsigned)(i / 2), 'A' + (i & 1));
+  return name;
+}
+
+// ───────────────── Staging download ─────────────────
+
+static void backToNowChannel() {
+  WiFi.disconnect(false, false);
+  esp_wifi_set_promiscuous(true);
+  esp_wifi_set_channel(WIFI_CHANNEL, WIFI_SECOND_CHAN_NONE);
+  esp_wifi_set_promiscuous(false);
+}
+
+static bool fetchInto(const char* url) {
+  HTTPClient http;
+  WiFiClient client;
+  http.setReuse(false);
+  http.setTimeout(OTA_HTTP_TIMEOUT_MS);
+  if (!http.begin(client, url)) { Serial.println("[FWR] http.begin FAIL"); return false; }
+  const char* hdrs[] = { "X-SHA256" };
+  http.collectHeaders(hdrs, 1);
+
+  int code = http.GET();
+  int32_t total = http.getSize();
+  Serial.printf("[FWR] HTTP code %d, %ld bytes\n", code, (long)total);
+  if (code != HTTP_CODE_OK || total <= 0 || (uint32_t)total > s_stage->size) {
+    http.end();
+    return false;
+  }
+  if (esp_partition_erase_range(s_stage, 0, ((uint32_t)total + kSector - 1) & ~(kSector - 1)) != ESP_OK) {
+    Serial.println("[FWR] erase FAIL");
+    http.end();
+    return false;
+  }
+
+  mbedtls_sha256_context ctx;
+  mbedtls_sha256_init(&ctx);
+  mbedtls_sha256_starts(&ctx, 0);
+  WiFiClient* stream = http.getStreamPtr();
+  uint8_t  buf[4096];
+  uint32_t got = 0, lastData = millis();
+  bool ok = true;
+  while (got < (uint32_t)total) {
+    size_t avail = stream->available();
+    if (!avail) {
+      if (!stream->connected() || millis() - lastData > OTA_HTTP_TIMEOUT_MS) { ok = false; break; }
+      delay(1);
+      continue;
+    }
+    int n = stream->read(buf, min(avail, min(sizeof(buf), (size_t)(total - got))));
+    if (n <= 0) continue;
+    if (esp_partition_write(s_stage, got, buf, n) != ESP_OK) { ok = false; break; }
+    mbedtls_sha256_update(&ctx, buf, n);
+    got += n;
+    lastData = millis();
+  }
+  mbedtls_sha256_finish(&ctx, s_sha);
+  mbedtls_sha256_free(&ctx);
+
+  char hex[65];
+  for (int i = 0; i < 32; i++) snprintf(hex + i * 2, 3, "%02x", s_sha[i]);
+  const String expect = http.header("X-SHA256");
+  http.end();
+  if (!ok) { Serial.printf("[FWR] download cut at %lu bytes\n", (unsigned long)got); return false; }
+  Serial.printf("[FWR] sha256 %s\n", hex);
+  if (expect.length() && !expect.equalsIgnoreCase(hex)) {
+    Serial.printf("[FWR] sha256 mismatch, server says %s\n", expect.c_str());
+    return false;
+  }
+  s_size = got;
+  return true;
+}
+
+bool MasterFwRelay_fetch(const char* url) {
+  if (s_phase != PH_IDLE) return false;
+  s_staged = false;
+  s_stage = esp_ota_get_next_update_partition(nullptr);
+  if (!s_stage) { Serial.println("[FWR] no spare OTA partition to stage in"); return false; }
+
+  Serial.printf("[FWR] fetch %s\n", url);
+  WiFi.begin(OTA_WIFI_SSID, OTA_WIFI_PASS);
+  uint32_t t0 = millis();
+  while (WiFi.status() != WL_CONNECTED) {
+    if (millis() - t0 > OTA_CONNECT_TIMEOUT_MS) {
+      Serial.println("[FWR] WiFi connect timeout");
+      backToNowChannel();
+      return false;
+    }
+    delay(100);
+  }
+  const bool ok = fetchInto(url);
+  backToNowChannel();   // Sides listen on WIFI_CHANNEL
+  if (!ok) return false;
+
+  s_chunks = (s_size + FW_CHUNK_BYTES - 1) / FW_CHUNK_BYTES;
+  s_staged = true;
+  Serial.printf("[FWR] staged %lu bytes (%lu chunks) in %lu ms\n",
+                (unsigned long)s_size, (unsigned long)s_chunks, (unsigned long)(millis() - t0));
+  return true;
+}
+
+bool MasterFwRelay_staged() { return s_staged; }
+
+// ───────────────── Broadcast ─────────────────
+
+static void sendOffer() {
+  uint8_t m[38];
+  m[0] = FW_OFFER;
+  m[1] = s_xfer;
+  m[2] = (uint8_t)(s_size >> 24); m[3] = (uint8_t)(s_size >> 16);
+  m[4] = (uint8_t)(s_size >> 8);  m[5] = (uint8_t)s_size;
+  memcpy(m + 6, s_sha, 32);
+  esp_now_send(kBcast, m, sizeof(m));
+  s_lastOfferMs = millis();
+}
+
+static bool sendChunk(uint32_t i) {
+  uint8_t m[4 + FW_CHUNK_BYTES];
+  const uint32_t off = i * FW_CHUNK_BYTES;
+  const uint32_t n = min((uint32_t)FW_CHUNK_BYTES, s_size - off);
+  m[0] = FW_CHUNK;
+  m[1] = s_xfer;
+  m[2] = (uint8_t)(i >> 8);
+  m[3] = (uint8_t)i;
+  if (esp_partition_read(s_stage, off, m + 4, n) != ESP_OK) return false;
+  // Not traced: a pass is thousands of packets and would flush the trace ring
+  return esp_now_send(kBcast, m, 4 + n) == ESP_OK;
+}
+
+// ───────────────── Relay state machine ─────────────────
+
+static void enterPhase(Phase p) {
+  s_phase = p;
+  s_phaseT0 = millis();
+}
+
+static void drop(int i, const char* why) {
+  Serial.printf("[FWR] dropping %s: %s\n", sideName(i), why);
+  s_sx[i].active = false;
+}
+
+static int activeCount() {
+  int n = 0;
+  for (const SideXfer& x : s_sx) n += x.active;
+  return n;
+}
+
+static void finish() {
+  const uint32_t ms = millis() - s_t0;
+  Serial.printf("[FWR] transfer %u done in %lu ms: %lu chunks sent for %lu (%.2fx), %lu round(s)\n",
+                (unsigned)s_xfer, (unsigned long)ms, (unsigned long)s_sent, (unsigned long)s_chunks,
+                s_chunks ? (float)s_sent / (float)s_chunks : 0.0f, (unsigned long)s_round);
+  for (int i = 0; i < kMaxSides; i++) {
+    if (!s_sx[i].wanted) continue;
+    const uint8_t st = s_sx[i].state;
+    Serial.printf("[FWR]   %s: %s\n", sideName(i),
+                  st == FW_ST_COMPLETE ? "complete" : st == FW_ST_FAILED ? "FAILED" :
+                  st == kUnknown ? "no answer" : "incomplete");
+  }
+  free(s_need);
+  s_need = nullptr;
+  enterPhase(PH_IDLE);
+}
+
+static void startPass() {
+  s_next = 0;
+  s_round++;
+  enterPhase(PH_SEND);
+}
+
+static void startPoll() {
+  for (SideXfer& x : s_sx) x.heard = false;
+  sendOffer();
+  enterPhase(PH_POLL);
+}
+
+// Fold fresh FW_NACKs into the Side states (and, while polling, into s_need)
+static void drainNacks() {
+  for (int i = 0; i < kMaxSides; i++) {
+    NackBox b;
+    portENTER_CRITICAL(&s_boxMux);
+    const bool fresh = s_box[i].fresh;
+    if (fresh) { b = s_box[i]; s_box[i].fresh = false; }
+    portEXIT_CRITICAL(&s_boxMux);
+    if (!fresh || !s_sx[i].active) continue;
+
+    SideXfer& x = s_sx[i];
+    x.state = b.state;
+    x.heard = true;
+    if (b.state == FW_ST_FAILED) { drop(i, "reported failure"); continue; }
+    if (b.state != FW_ST_RECEIVING || s_phase != PH_POLL) continue;
+    x.holes = 0;
+    for (uint32_t k = 0; k < b.nbits && b.base + k < s_chunks; k++) {
+      if (!(b.bitmap[k >> 3] & (1u << (k & 7)))) continue;
+      const uint32_t c = b.base + k;
+      s_need[c >> 3] |= (uint8_t)(1u << (c & 7));
+      x.holes++;
+    }
+  }
+}
+
+void MasterFwRelay_onNack(uint8_t side, const uint8_t* data, int len) {
+  if (side >= kMaxSides || len < 8 || data[2] != s_xfer || s_phase == PH_IDLE) return;
+  const uint16_t nbits = (uint16_t)(data[6] << 8 | data[7]);
+  if (nbits > FW_NACK_MAX_BITS || 8 + (nbits + 7) / 8 > len) return;
+  portENTER_CRITICAL(&s_boxMux);
+  NackBox& b = s_box[side];
+  b.state = data[3];
+  b.base  = (uint16_t)(data[4] << 8 | data[5]);
+  b.nbits = nbits;
+  memcpy(b.bitmap, data + 8, (nbits + 7) / 8);
+  b.fresh = true;
+  portEXIT_CRITICAL(&s_boxMux);
+}
+
+bool MasterFwRelay_start(uint16_t sideMask) {
+  if (!s_staged || s_phase != PH_IDLE || !sideMask) return false;
+  free(s_need);
+  s_need = (uint8_t*)malloc((s_chunks + 7) / 8);
+  if (!s_need) return false;
+
+  if (!esp_now_is_peer_exist(kBcast)) {
+    esp_now_peer_info_t p{};
+    memcpy(p.peer_addr, kBcast, 6);
+    p.channel = WIFI_CHANNEL;
+    p.encrypt = false;
+    esp_now_add_peer(&p);
+  }
+
+  static bool seeded = false;
+  if (!seeded) { s_xfer = (uint8_t)random(256); seeded = true; }
+  s_xfer++;   // a Side holding an older transfer starts over
+  for (int i = 0; i < kMaxSides; i++) {
+    s_sx[i] = SideXfer();
+    s_sx[i].wanted = s_sx[i].active = sideMask & (1u << i);
+    s_box[i].fresh = false;
+  }
+  s_round = s_sent = s_commits = 0;
+  s_t0 = millis();
+  Serial.printf("[FWR] transfer %u: %lu bytes to %d Side(s) (mask 0x%04x)\n", (unsigned)s_xfer,
+                (unsigned long)s_size, activeCount(), (unsigned)sideMask);
+  sendOffer();
+  enterPhase(PH_OFFER);
+  return true;
+}
+
+void MasterFwRelay_abort() {
+  if (s_phase == PH_IDLE) return;
+  Serial.println("[FWR] aborted");
+  finish();
+}
+
+bool MasterFwRelay_busy() { return s_phase != PH_IDLE; }
+
+void MasterFwRelay_tick() {
+  if (s_phase == PH_IDLE) return;
+  drainNacks();
+  const uint32_t now = millis();
+
+  switch (s_phase) {
+    case PH_OFFER: {
+      // Chunks only go out once every Side has an erased partition
+      bool ready = true;
+      for (const SideXfer& x : s_sx) if (x.active && x.state != FW_ST_RECEIVING) ready = false;
+      if (!ready && now - s_phaseT0 > FW_READY_TIMEOUT_MS) {
+        for (int i = 0; i < kMaxSides; i++)
+          if (s_sx[i].active && s_sx[i].state != FW_ST_RECEIVING) drop(i, "not ready");
+        ready = true;
+      }
+      if (!activeCount()) { finish(); break; }
+      if (ready) {
+        memset(s_need, 0xFF, (s_chunks + 7) / 8);
+        startPass();
+      } else if (now - s_lastOfferMs >= FW_POLL_MS) {
+        sendOffer();
+      }
+    } break;
+
+    case PH_SEND: {
+      // One chunk per FW_CHUNK_GAP_US; a slow loop catches up by at most FW_CHUNK_BURST
+      const uint32_t us = micros();
+      if (us - s_lastChunkUs > FW_CHUNK_BURST * FW_CHUNK_GAP_US)
+        s_lastChunkUs = us - FW_CHUNK_BURST * FW_CHUNK_GAP_US;
+      while (us - s_lastChunkUs >= FW_CHUNK_GAP_US) {
+        while (s_next < s_chunks && !(s_need[s_next >> 3] & (1u << (s_next & 7)))) s_next++;
+        if (s_next >= s_chunks) break;
+        if (!sendChunk(s_next)) break;   // ESP-NOW queue full: retry next tick
+        s_need[s_next >> 3] &= (uint8_t)~(1u << (s_next & 7));
+        s_next++;
+        s_sent++;
+        s_lastChunkUs += FW_CHUNK_GAP_US;
+      }
+      if (s_next >= s_chunks) startPoll();
+    } break;
+
+    case PH_POLL: {
+      bool allHeard = true, allDone = true;
+      for (const SideXfer& x : s_sx) {
+        if (!x.active) continue;
+        if (!x.heard) allHeard = false;
+        if (x.state != FW_ST_COMPLETE) allDone = false;
+      }
+      if (!activeCount()) { finish(); break; }
+      if (allHeard && allDone) {
+        enterPhase(PH_COMMIT);
+        break;
+      }
+      if (allHeard) {
+        bool any = false;
+        for (uint32_t i = 0; i < (s_chunks + 7) / 8 && !any; i++) any = s_need[i];
+        if (any && s_round >= FW_MAX_ROUNDS) {
+          for (int i = 0; i < kMaxSides; i++)
+            if (s_sx[i].active && s_sx[i].state != FW_ST_COMPLETE) drop(i, "too many rounds");
+          break;
+        }
+        if (any) {
+          uint32_t holes = 0, worst = 0;
+          for (const SideXfer& x : s_sx) {
+            if (!x.active) continue;
+            holes += x.holes;
+            worst = max(worst, x.holes);
+          }
+          Serial.printf("[FWR] round %lu: %lu holes over %d Side(s), worst %lu\n", (unsigned long)s_round,
+                        (unsigned long)holes, activeCount(), (unsigned long)worst);
+          startPass();
+        } else {
+          startPoll();   // still flushing or verifying: ask again
+        }
+        break;
+      }
+      if (now - s_phaseT0 > FW_SIDE_TIMEOUT_MS) {
+        for (int i = 0; i < kMaxSides; i++) if (s_sx[i].active && !s_sx[i].heard) drop(i, "no answer");
+      } else if (now - s_lastOfferMs >= FW_POLL_MS) {
+        sendOffer();
+      }
+    } break;
+
+    case PH_COMMIT: {
+      // Broadcast, so repeat a few times; a Side reboots on the first one it hears
+      if (now - s_lastOfferMs < FW_POLL_MS) break;
+      uint8_t m[2] = { FW_COMMIT, s_xfer };
+      esp_now_send(kBcast, m, sizeof(m));
+      s_lastOfferMs = now;
+      if (++s_commits >= 3) finish();
+    } break;
+
+    default:
+      break;
+  }
+}
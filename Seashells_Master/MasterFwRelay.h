@@ -0,0 +1,31 @@
+#pragma once
+#include <Arduino.h>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Side firmware over ESP-NOW: the Master downloads the image once into its
+// own spare OTA partition (never marked bootable), then broadcasts it to
+// every Side at once (Messages.h, FW_*). No Side joins WiFi.
+//
+//   OFFER  broadcast FW_OFFER until every Side has erased its partition
+//   SEND   broadcast every chunk still needed, paced by FW_CHUNK_GAP_US
+//   POLL   FW_OFFER again; each Side answers with a FW_NACK bitmap of holes,
+//          the union becomes the next SEND pass
+//   COMMIT all Sides verified the SHA-256 -> FW_COMMIT, they reboot
+//
+// Sides that stay silent or fail are dropped so the rest can finish.
+// ─────────────────────────────────────────────────────────────────────────────
+
+// Blocking: joins OTA_WIFI_SSID, fetches `url` into the staging partition,
+// checks X-SHA256 when the server sends it, returns to the ESP-NOW channel.
+bool MasterFwRelay_fetch(const char* url);
+bool MasterFwRelay_staged();
+
+// sideMask bit 2s = row s Side A, bit 2s+1 = its Side B (SESSION_SIDES), the
+// same peer index MasterFwRelay_onNack takes. Every Side hears the broadcasts
+// and erases, so pass every row's pair. False if nothing is staged or a relay runs.
+bool MasterFwRelay_start(uint16_t sideMask);
+void MasterFwRelay_abort();
+bool MasterFwRelay_busy();
+
+void MasterFwRelay_onNack(uint8_t side, const uint8_t* data, int len);   // ESP-NOW callback context
+void MasterFwRelay_tick();                                              // from loop(), never blocks
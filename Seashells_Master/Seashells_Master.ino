@@ -13,6 +13,12 @@
       -> 7 from one sub of a random base, 1 from a different sub of same base
       -> Round 3 is infinite: you never "clear" it by points, only by running out of lives.
 
+  Cache-aware building (CACHE_AWARE_SCENES, toggle with 'c'):
+    Sides report which clips they play without SD (HELLO + HEARTBEAT). Within
+    a bucket, equally valid clips resident on more Sides are tried first, and
+    the "same" clips are swapped between Sides so streamed ones land where
+    they are resident or the SD bus is healthier. The rules above don't change.
+
   Unique-first rule:
     For the "same 7", we:
       - Use as many distinct IDs as available in the chosen bucket
@@ -32,9 +38,23 @@
     - Wrong picks/timeouts do NOT change the timeout; they only cost lives.
 
   Serial:
-    's' => start game (resets lives, points, round, timeout)
+    '0'..'9' => pick the session (table, SESSION_SIDES row) that 's' and 'e' act on
+    's' => start game (resets lives, points, round, timeout); refused during a firmware relay
     'e' => end game
     'u','a','b' => OTA triggers (unchanged)
+    'f' => fetch OTA_URL_SIDE_BIN once and relay it to every SESSION_SIDES Side over ESP-NOW
+    'F' => relay the already fetched image again ('x' aborts a relay)
+    'y' => both Sides sync their SD assets against ASSET_INDEX_URL (changed files only)
+    'r' => both Sides hot-reload their manifest.csv (live from the next scene)
+    'c' => toggle cache-aware scene building and print what each Side reported
+    't' => dump the binary event trace ('T' clears it); merge with tools/trace_merge.py
+    'j' => scheduler jitter: loop pass time and how late each session's deadlines fired
+    'J' => load test: add simulated sessions one at a time and print the jitter for each count
+
+  Sessions (GameSession.h):
+    Every table in SESSION_SIDES is its own game with its own state machine,
+    timers and pair of Sides; loop() ticks them all and never blocks while one
+    is running. Packets are routed to a session by the sender's MAC.
 */
 
 #include <Arduino.h>
@@ -42,10 +62,14 @@
 #include <esp_now.h>
 #include <esp_wifi.h>
 #include <cstring>
+#include <cstdarg>
 
 #include "Messages.h"
 #include "ConfigMaster.h"
 #include "MasterManifest.h"
+#include "Trace.h"
+#include "MasterFwRelay.h"
+#include "GameSession.h"
 
 // ---------- Tuning ----------
 static const uint32_t BASE_TIMEOUT_MS[3] = {
@@ -57,11 +81,16 @@ static const float   TIME_DECAY_FACTOR = 0.8f;   // each correct: timeout *= 0.8
 static const uint32_t MIN_TIMEOUT_MS   = 5000;   // never go below 5 seconds
 static const uint8_t  MAX_LIVES        = 5;
 
-// ---------- Types ----------
-enum State { IDLE, BUILD, ANNOUNCE, WAIT, PAUSE };
+// ---------- Sessions ----------
+static constexpr uint8_t kTableSessions = sizeof(SESSION_SIDES) / sizeof(SESSION_SIDES[0]);
+static constexpr uint8_t MAX_SIDES      = MAX_SESSIONS * 2;   // session s: rows 2s (A), 2s+1 (B)
+static_assert(kTableSessions <= MAX_SESSIONS, "SESSION_SIDES has more rows than MAX_SESSIONS");
+
+static GameSession g_sess[MAX_SESSIONS];
+static uint8_t     g_numSessions = kTableSessions;   // plus simulated ones during 'J'
+static uint8_t     g_selected = 0;                   // session serial 's'/'e' act on
 
-// ---------- Globals ----------
-static State g_state = IDLE;
+static const char* const kStateName[] = { "IDLE", "WAKE", "BUILD", "ANNOUNCE", "WAIT", "PAUSE" };
 
 // Blink cadence
 static const uint8_t  BLINK_REPS              = 3;
@@ -70,17 +99,27 @@ static const uint16_t BLINK_OFF_MS_CORRECT    = 120;
 static const uint16_t BLINK_ON_MS_WRONG       = 160;
 static const uint16_t BLINK_OFF_MS_WRONG      = 140;
 
-// Pause bookkeeping
-static uint32_t resultPauseUntil = 0;
-static State    nextAfterBlink   = IDLE;
-
-static volatile uint8_t lastSide = 255, lastSlot = 255;
+// What each Side reported in HELLO / HEARTBEAT (cache report, Messages.h)
+static constexpr size_t kMaxClipBits = 512;   // bit per MASTER_CLIPS index
+struct SideInfo {
+  bool     valid = false;
+  uint32_t lastMs = 0;
+  uint8_t  flags = 0;
+  uint16_t budgetKB = 0, usedKB = 0;
+  uint8_t  sdHealth = 100;
+  uint8_t  warmPct = 100;
+  uint16_t residentCount = 0;
+  uint8_t  resident[kMaxClipBits / 8] = {0};
+};
+static SideInfo     g_side[MAX_SIDES];
+static volatile uint32_t g_helloMs[MAX_SIDES] = {0};   // last HELLO per Side (wake pings)
+static portMUX_TYPE g_sideMux = portMUX_INITIALIZER_UNLOCKED;
+static bool         g_cacheAware = CACHE_AWARE_SCENES;
 
-// Current scene + odd markers
-static uint16_t sceneA[4] {0,0,0,0};
-static uint16_t sceneB[4] {0,0,0,0};
-static bool     slotIsOdd_A[4] {false,false,false,false};
-static bool     slotIsOdd_B[4] {false,false,false,false};
+// Loop passes while a game runs (serial 'j')
+static int64_t  g_lastPassUs = 0;
+static uint32_t g_passN = 0, g_passMaxUs = 0;
+static uint64_t g_passSumUs = 0;
 
 // ---------- ESP-NOW helpers ----------
 static void addPeer(const uint8_t mac[6]) {
@@ -91,10 +130,65 @@ static void addPeer(const uint8_t mac[6]) {
   esp_now_add_peer(&p);
 }
 
+// Side table row of a MAC (session * 2 + 0/1), TRACE_PEER_MASTER if unknown
+static uint8_t peerIndex(const uint8_t mac[6]) {
+  for (uint8_t s = 0; s < kTableSessions; s++) {
+    for (uint8_t k = 0; k < 2; k++) {
+      if (std::memcmp(mac, SESSION_SIDES[s][k], 6) == 0) return (uint8_t)(s * 2 + k);
+    }
+  }
+  return TRACE_PEER_MASTER;
+}
+
 static void sendPkt(const uint8_t mac[6], const void* data, size_t n) {
+  if (n) Trace_rec(TR_PKT_TX, ((const uint8_t*)data)[0], peerIndex(mac));
   esp_now_send(mac, (const uint8_t*)data, n);
 }
 
+// Send to every Side of every table
+static void sendAllSides(const void* data, size_t n) {
+  for (uint8_t s = 0; s < kTableSessions; s++) {
+    sendPkt(SESSION_SIDES[s][0], data, n);
+    sendPkt(SESSION_SIDES[s][1], data, n);
+  }
+}
+
+// Simulated Side: a wake ping is answered at once, and a scene that starts
+// its loops has a player who presses a while later (simTick)
+static void simRx(GameSession& gs, uint8_t k, const uint8_t* m, size_t n) {
+  if (!n) return;
+  if (m[0] == HELLO_REQ) {
+    g_helloMs[gs.side[k]] = millis();
+  } else if (m[0] == START_LOOP_ALL && k == 0) {
+    gs.simPickUs = esp_timer_get_time() + 1000LL * random(SIM_PICK_MIN_MS, SIM_PICK_MAX_MS + 1);
+  } else if (m[0] == STOP_ALL) {
+    gs.simPickUs = 0;
+  }
+}
+
+// Every command to a session's Side goes through here
+static void sendSide(GameSession& gs, uint8_t k, const void* data, size_t n) {
+  if (gs.sim) simRx(gs, k, (const uint8_t*)data, n);
+  else        sendPkt(gs.mac[k], data, n);
+}
+static void sendBoth(GameSession& gs, const void* data, size_t n) {
+  sendSide(gs, 0, data, n);
+  sendSide(gs, 1, data, n);
+}
+
+// Session-tagged log line. Simulated sessions stay quiet, so the load test
+// measures the scheduler rather than the UART.
+static void sessLog(const GameSession& gs, const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+static void sessLog(const GameSession& gs, const char* fmt, ...) {
+  if (gs.sim) return;
+  char buf[192];
+  va_list ap;
+  va_start(ap, fmt);
+  vsnprintf(buf, sizeof(buf), fmt, ap);
+  va_end(ap);
+  Serial.printf("[Master S%u] %s", (unsigned)gs.id, buf);
+}
+
 static void cmdRoleAssign(const uint8_t mac[6], uint8_t sideId) {
   uint8_t m[2] = { ROLE_ASSIGN, (uint8_t)(sideId&1) };
   sendPkt(mac, m, sizeof(m));
@@ -113,48 +207,57 @@ static void cmdStartLoopAllOne(const uint8_t mac[6]){
   sendPkt(mac, &m, 1);
 }
 
-static void cmdGameMode(bool en){
+static void cmdGameMode(GameSession& gs, bool en){
   uint8_t m[2] = { GAME_MODE, (uint8_t)(en ? 1 : 0) };
-  sendPkt(SIDE_A_MAC, m, sizeof(m));
-  sendPkt(SIDE_B_MAC, m, sizeof(m));
+  sendBoth(gs, m, sizeof(m));
 }
-static void cmdLedAllWhite(){
+static void cmdLedAllWhite(GameSession& gs){
   uint8_t m = LED_ALL_WHITE;
-  sendPkt(SIDE_A_MAC, &m, 1);
-  sendPkt(SIDE_B_MAC, &m, 1);
+  sendBoth(gs, &m, 1);
 }
-static void cmdBlinkAll(uint8_t color, uint16_t on_ms, uint16_t off_ms){
+static void cmdBlinkAll(GameSession& gs, uint8_t color, uint16_t on_ms, uint16_t off_ms){
   uint8_t m[6] = { BLINK_ALL,
                    color,
                    (uint8_t)(on_ms >> 8), (uint8_t)on_ms,
                    (uint8_t)(off_ms >> 8), (uint8_t)off_ms };
-  sendPkt(SIDE_A_MAC, m, sizeof(m));
-  sendPkt(SIDE_B_MAC, m, sizeof(m));
+  sendBoth(gs, m, sizeof(m));
 }
-static void cmdStartLoopAll(){
+static void cmdStartLoopAll(GameSession& gs){
   uint8_t m = START_LOOP_ALL;
-  sendPkt(SIDE_A_MAC, &m, 1);
-  sendPkt(SIDE_B_MAC, &m, 1);
+  sendBoth(gs, &m, 1);
 }
-static void cmdStopAll(){
+static void cmdStopAll(GameSession& gs){
   uint8_t m = STOP_ALL;
-  sendPkt(SIDE_A_MAC, &m, 1);
-  sendPkt(SIDE_B_MAC, &m, 1);
+  sendBoth(gs, &m, 1);
+}
+static void cmdManifestReload(){
+  uint8_t m = MANIFEST_RELOAD;
+  sendAllSides(&m, 1);
 }
-static void cmdSetScene(const uint8_t mac[6], const uint16_t ids[4]){
+static void cmdPlayOneshot(GameSession& gs, uint8_t slot, uint16_t id, uint8_t prio){
+  if (!id) return;
+  uint8_t m[5] = { PLAY_ONESHOT, slot, (uint8_t)(id >> 8), (uint8_t)id, prio };
+  sendBoth(gs, m, sizeof(m));
+}
+static void cmdSetScene(GameSession& gs, uint8_t k){
   uint8_t m[1 + 8];
   m[0] = SET_SCENE;
   for (int i=0;i<4;i++) {
-    m[1 + i*2] = (uint8_t)(ids[i] >> 8);
-    m[2 + i*2] = (uint8_t)(ids[i] & 0xFF);
+    m[1 + i*2] = (uint8_t)(gs.scene[k][i] >> 8);
+    m[2 + i*2] = (uint8_t)(gs.scene[k][i] & 0xFF);
   }
-  sendPkt(mac, m, sizeof(m));
+  sendSide(gs, k, m, sizeof(m));
 }
 
-static void endGame() {
-  cmdStopAll();
-  g_state = IDLE;
-  Serial.println("[Master] Game ended -> IDLE");
+static void endGame(GameSession& gs) {
+  cmdStopAll(gs);
+  gs.state = IDLE;
+  sessLog(gs, "Game ended -> IDLE\n");
+}
+
+static bool allIdle() {
+  for (uint8_t s = 0; s < g_numSessions; s++) if (g_sess[s].state != IDLE) return false;
+  return true;
 }
 
 static void shuffleArray(uint16_t* arr, size_t n) {
@@ -166,7 +269,8 @@ static void shuffleArray(uint16_t* arr, size_t n) {
   }
 }
 
-static void printIdInfo(const char* label, uint16_t id) {
+static void printIdInfo(const GameSession& gs, const char* label, uint16_t id) {
+  if (!SCENE_LOG_VERBOSE || gs.sim) return;
   const MasterClipMeta* cm = MasterManifest_find(id);
   if (!cm) {
     Serial.printf("  %s id=%u (unknown)\n", label, (unsigned)id);
@@ -275,15 +379,142 @@ static uint16_t pickRandomIdByBase(const char* base) {
   return ids[idx];
 }
 
+// ---------- Cache awareness ----------
+
+static void parseCacheReport(uint8_t side, const uint8_t* p, int len) {
+  if (side >= MAX_SIDES || len < 8) return;
+  SideInfo si;
+  si.valid    = true;
+  si.lastMs   = millis();
+  si.flags    = p[0];
+  si.budgetKB = (uint16_t)(p[1] << 8 | p[2]);
+  si.usedKB   = (uint16_t)(p[3] << 8 | p[4]);
+  si.sdHealth = p[5];
+  si.warmPct  = p[6];
+  uint8_t nSeg = p[7];
+  int off = 8;
+  for (uint8_t s = 0; s < nSeg && off + 3 <= len; s++) {
+    uint16_t first = (uint16_t)(p[off] << 8 | p[off + 1]);
+    uint8_t  nbits = p[off + 2];
+    int      bytes = (nbits + 7) / 8;
+    off += 3;
+    if (off + bytes > len) break;
+    for (uint8_t b = 0; b < nbits; b++) {
+      if (!(p[off + b / 8] & (1u << (b % 8)))) continue;
+      const MasterClipMeta* cm = MasterManifest_find((uint16_t)(first + b));
+      if (!cm) continue;
+      size_t idx = (size_t)(cm - MASTER_CLIPS);
+      if (idx >= kMaxClipBits) continue;
+      si.resident[idx / 8] |= (uint8_t)(1u << (idx % 8));
+      si.residentCount++;
+    }
+    off += bytes;
+  }
+  portENTER_CRITICAL(&g_sideMux);
+  const bool wasWarming = g_side[side].valid && (g_side[side].flags & CACHE_FLAG_WARMING);
+  g_side[side] = si;
+  portEXIT_CRITICAL(&g_sideMux);
+
+  // Sides report during their boot precache; resident clips grow as it fills
+  if (si.flags & CACHE_FLAG_WARMING) {
+    Serial.printf("[Master] Side %u%c warming: %u%%, %u resident, cache %u KB\n",
+                  (unsigned)(side / 2), 'A' + side % 2, (unsigned)si.warmPct, (unsigned)si.residentCount, (unsigned)si.usedKB);
+  } else if (wasWarming) {
+    Serial.printf("[Master] Side %u%c warm: %u resident, cache %u KB\n",
+                  (unsigned)(side / 2), 'A' + side % 2, (unsigned)si.residentCount, (unsigned)si.usedKB);
+  }
+}
+
+static bool sideFresh(uint8_t side) {
+  return g_side[side].valid && (millis() - g_side[side].lastMs) < SIDE_INFO_STALE_MS;
+}
+
+static bool residentOn(uint8_t side, uint16_t id) {
+  if (!sideFresh(side)) return false;
+  const MasterClipMeta* cm = MasterManifest_find(id);
+  if (!cm) return false;
+  size_t idx = (size_t)(cm - MASTER_CLIPS);
+  return idx < kMaxClipBits && (g_side[side].resident[idx / 8] & (1u << (idx % 8)));
+}
+
+// Stable partition after a shuffle: clips resident on both Sides, then on
+// one, then on none. Order inside each tier stays random.
+static void preferResident(const GameSession& gs, uint16_t* ids, size_t n) {
+  if (!g_cacheAware) return;
+  uint8_t score[32];
+  if (n > 32) n = 32;
+  for (size_t i = 0; i < n; i++) score[i] = residentOn(gs.side[0], ids[i]) + residentOn(gs.side[1], ids[i]);
+  for (size_t i = 1; i < n; i++) {
+    uint16_t id = ids[i]; uint8_t sc = score[i];
+    size_t j = i;
+    while (j > 0 && score[j - 1] < sc) { ids[j] = ids[j - 1]; score[j] = score[j - 1]; j--; }
+    ids[j] = id; score[j] = sc;
+  }
+}
+
+// Cost of making `side` play `id`: free when resident, else one SD stream
+// weighted up as that Side's SD health drops.
+static uint16_t streamCost(uint8_t side, uint16_t id) {
+  if (!id || residentOn(side, id)) return 0;
+  uint8_t health = sideFresh(side) ? g_side[side].sdHealth : 100;
+  return (uint16_t)(10 + (100 - health));
+}
+
+static uint8_t sdLoads(const uint16_t scene[4], uint8_t side) {
+  uint8_t n = 0;
+  for (int i = 0; i < 4; i++) {
+    bool dup = false;
+    for (int j = 0; j < i; j++) if (scene[j] == scene[i]) dup = true;
+    if (!dup && streamCost(side, scene[i])) n++;
+  }
+  return n;
+}
+
+// Swap "same" clips between Sides when that lowers the total stream cost.
+// Odd slots never move, so which Side/slot holds the odd one is unchanged.
+static void steerScenes(GameSession& gs) {
+  if (!g_cacheAware) return;
+  const uint8_t sa = gs.side[0], sb = gs.side[1];
+  for (int pass = 0; pass < 8; pass++) {
+    bool swapped = false;
+    for (int i = 0; i < 4; i++) {
+      if (gs.slotIsOdd[0][i]) continue;
+      for (int j = 0; j < 4; j++) {
+        if (gs.slotIsOdd[1][j]) continue;
+        uint16_t a = gs.scene[0][i], b = gs.scene[1][j];
+        if (a == b) continue;
+        int before = streamCost(sa, a) + streamCost(sb, b);
+        int after  = streamCost(sa, b) + streamCost(sb, a);
+        if (after < before) { gs.scene[0][i] = b; gs.scene[1][j] = a; swapped = true; }
+      }
+    }
+    if (!swapped) break;
+  }
+}
+
+static void printSideInfo() {
+  Serial.printf("[Master] cache-aware scenes %s\n", g_cacheAware ? "ON" : "OFF");
+  for (uint8_t s = 0; s < kTableSessions * 2; s++) {
+    const SideInfo& si = g_side[s];
+    if (!si.valid) { Serial.printf("  Side %u%c: no report\n", (unsigned)(s / 2), 'A' + s % 2); continue; }
+    Serial.printf("  Side %u%c: %u resident, cache %u/%u KB, sdHealth=%u, age=%lums%s%s\n",
+                  (unsigned)(s / 2), 'A' + s % 2, (unsigned)si.residentCount, (unsigned)si.usedKB, (unsigned)si.budgetKB,
+                  (unsigned)si.sdHealth, (unsigned long)(millis() - si.lastMs),
+                  (si.flags & CACHE_FLAG_TRUNCATED) ? " (truncated)" : "",
+                  (si.flags & CACHE_FLAG_WARMING) ? " (warming)" : "");
+  }
+}
+
 // Fill dest[needed] with unique IDs first, then reuse randomly from uniques if needed
-static void fillWithUniqueThenReuse(uint16_t* dest, size_t needed, uint16_t* uniqueIds, size_t uniqueCount, const char* context) {
+static void fillWithUniqueThenReuse(GameSession& gs, uint16_t* dest, size_t needed, uint16_t* uniqueIds, size_t uniqueCount, const char* context) {
   if (uniqueCount == 0) {
     for (size_t i=0; i<needed; i++) dest[i] = 0;
-    Serial.printf("[Master] WARN: no IDs for context '%s'\n", context ? context : "");
+    sessLog(gs, "WARN: no IDs for context '%s'\n", context ? context : "");
     return;
   }
 
   shuffleArray(uniqueIds, uniqueCount);
+  preferResident(gs, uniqueIds, uniqueCount);
 
   for (size_t i=0; i<needed; i++) {
     if (i < uniqueCount) {
@@ -298,12 +529,12 @@ static void fillWithUniqueThenReuse(uint16_t* dest, size_t needed, uint16_t* uni
 // ---------- Level builders ----------
 
 // Level 2: 7 from baseMain, 1 from baseOdd
-static void buildScenes_level2_randomBases() {
+static void buildScenes_level2_randomBases(GameSession& gs) {
   const char* bases[8];
   size_t baseCount = collectUniqueBases(bases, 8);
 
   if (baseCount < 2) {
-    Serial.println("[Master] Level2: need >=2 bases, falling back to trivial (all from same base)");
+    sessLog(gs, "Level2: need >=2 bases, falling back to trivial (all from same base)\n");
     baseCount = collectUniqueBases(bases, 8);
   }
 
@@ -319,10 +550,10 @@ static void buildScenes_level2_randomBases() {
 
   size_t uCount = collectIdsByBase(baseMain, unique, 32);
   if (uCount == 0) {
-    Serial.println("[Master] Level2: no IDs for baseMain, using any IDs");
+    sessLog(gs, "Level2: no IDs for baseMain, using any IDs\n");
     for (int i=0;i<7;i++) sameIds[i] = MASTER_CLIPS[random((long)MASTER_CLIP_COUNT)].id;
   } else {
-    fillWithUniqueThenReuse(sameIds, 7, unique, uCount, "Level2 baseMain");
+    fillWithUniqueThenReuse(gs, sameIds, 7, unique, uCount, "Level2 baseMain");
   }
 
   uint16_t oddId;
@@ -332,6 +563,7 @@ static void buildScenes_level2_randomBases() {
     oddId = MASTER_CLIPS[random((long)MASTER_CLIP_COUNT)].id;
   } else {
     shuffleArray(uniqueOdd, uOddCount);
+    preferResident(gs, uniqueOdd, uOddCount);
     oddId = uniqueOdd[0];
   }
 
@@ -341,34 +573,35 @@ static void buildScenes_level2_randomBases() {
 
   if (sideOdd == 0) {
     for (int i=0; i<4; i++) {
-      if (i == oddSlot) sceneA[i] = oddId;
-      else              sceneA[i] = sameIds[sameIdx++];
+      if (i == oddSlot) gs.scene[0][i] = oddId;
+      else              gs.scene[0][i] = sameIds[sameIdx++];
     }
-    for (int i=0; i<4; i++) sceneB[i] = sameIds[sameIdx++];
+    for (int i=0; i<4; i++) gs.scene[1][i] = sameIds[sameIdx++];
   } else {
-    for (int i=0; i<4; i++) sceneA[i] = sameIds[sameIdx++];
+    for (int i=0; i<4; i++) gs.scene[0][i] = sameIds[sameIdx++];
     for (int i=0; i<4; i++) {
-      if (i == oddSlot) sceneB[i] = oddId;
-      else              sceneB[i] = sameIds[sameIdx++];
+      if (i == oddSlot) gs.scene[1][i] = oddId;
+      else              gs.scene[1][i] = sameIds[sameIdx++];
     }
   }
 
-  for (int i=0;i<4;i++) slotIsOdd_A[i] = (sceneA[i] == oddId);
-  for (int i=0;i<4;i++) slotIsOdd_B[i] = (sceneB[i] == oddId);
+  for (int i=0;i<4;i++) gs.slotIsOdd[0][i] = (gs.scene[0][i] == oddId);
+  for (int i=0;i<4;i++) gs.slotIsOdd[1][i] = (gs.scene[1][i] == oddId);
+  steerScenes(gs);
 
-  Serial.printf("[Master] Level2: baseMain=%s baseOdd=%s sideOdd=%u oddSlot=%u\n",
-                baseMain, baseOdd, (unsigned)sideOdd, (unsigned)oddSlot);
-  for (int i=0;i<4;i++) printIdInfo("  sceneA", sceneA[i]);
-  for (int i=0;i<4;i++) printIdInfo("  sceneB", sceneB[i]);
+  sessLog(gs, "Level2: baseMain=%s baseOdd=%s sideOdd=%u oddSlot=%u\n",
+              baseMain, baseOdd, (unsigned)sideOdd, (unsigned)oddSlot);
+  for (int i=0;i<4;i++) printIdInfo(gs, "  sceneA", gs.scene[0][i]);
+  for (int i=0;i<4;i++) printIdInfo(gs, "  sceneB", gs.scene[1][i]);
 }
 
 // Level 1: 7 from one sub2 family of a random base, 1 from a different base
-static void buildScenes_level1_sub2() {
+static void buildScenes_level1_sub2(GameSession& gs) {
   const char* bases[8];
   size_t baseCount = collectUniqueBases(bases, 8);
   if (baseCount < 2) {
-    Serial.println("[Master] Level1: need >=2 bases, fallback to Level2");
-    buildScenes_level2_randomBases();
+    sessLog(gs, "Level1: need >=2 bases, fallback to Level2\n");
+    buildScenes_level2_randomBases(gs);
     return;
   }
 
@@ -378,8 +611,8 @@ static void buildScenes_level1_sub2() {
   const char* sub2List[16];
   size_t sub2Count = collectUniqueSub2ForBase(baseMain, sub2List, 16);
   if (sub2Count == 0) {
-    Serial.println("[Master] Level1: no sub2 families for baseMain, fallback to Level2");
-    buildScenes_level2_randomBases();
+    sessLog(gs, "Level1: no sub2 families for baseMain, fallback to Level2\n");
+    buildScenes_level2_randomBases(gs);
     return;
   }
 
@@ -395,11 +628,11 @@ static void buildScenes_level1_sub2() {
 
   size_t uCount = collectIdsByBaseSub2(baseMain, familySub2, unique, 32);
   if (uCount == 0) {
-    Serial.println("[Master] Level1: no IDs for baseMain+sub2, fallback to Level2");
-    buildScenes_level2_randomBases();
+    sessLog(gs, "Level1: no IDs for baseMain+sub2, fallback to Level2\n");
+    buildScenes_level2_randomBases(gs);
     return;
   }
-  fillWithUniqueThenReuse(sameIds, 7, unique, uCount, "Level1 base+sub2");
+  fillWithUniqueThenReuse(gs, sameIds, 7, unique, uCount, "Level1 base+sub2");
 
   uint16_t oddId;
   uint16_t uniqueOdd[32];
@@ -408,6 +641,7 @@ static void buildScenes_level1_sub2() {
     oddId = MASTER_CLIPS[random((long)MASTER_CLIP_COUNT)].id;
   } else {
     shuffleArray(uniqueOdd, uOddCount);
+    preferResident(gs, uniqueOdd, uOddCount);
     oddId = uniqueOdd[0];
   }
 
@@ -417,34 +651,35 @@ static void buildScenes_level1_sub2() {
 
   if (sideOdd == 0) {
     for (int i=0; i<4; i++) {
-      if (i == oddSlot) sceneA[i] = oddId;
-      else              sceneA[i] = sameIds[sameIdx++];
+      if (i == oddSlot) gs.scene[0][i] = oddId;
+      else              gs.scene[0][i] = sameIds[sameIdx++];
     }
-    for (int i=0; i<4; i++) sceneB[i] = sameIds[sameIdx++];
+    for (int i=0; i<4; i++) gs.scene[1][i] = sameIds[sameIdx++];
   } else {
-    for (int i=0; i<4; i++) sceneA[i] = sameIds[sameIdx++];
+    for (int i=0; i<4; i++) gs.scene[0][i] = sameIds[sameIdx++];
     for (int i=0; i<4; i++) {
-      if (i == oddSlot) sceneB[i] = oddId;
-      else              sceneB[i] = sameIds[sameIdx++];
+      if (i == oddSlot) gs.scene[1][i] = oddId;
+      else              gs.scene[1][i] = sameIds[sameIdx++];
     }
   }
 
-  for (int i=0;i<4;i++) slotIsOdd_A[i] = (sceneA[i] == oddId);
-  for (int i=0;i<4;i++) slotIsOdd_B[i] = (sceneB[i] == oddId);
+  for (int i=0;i<4;i++) gs.slotIsOdd[0][i] = (gs.scene[0][i] == oddId);
+  for (int i=0;i<4;i++) gs.slotIsOdd[1][i] = (gs.scene[1][i] == oddId);
+  steerScenes(gs);
 
-  Serial.printf("[Master] Level1: baseMain=%s familySub2=%s baseOdd=%s sideOdd=%u oddSlot=%u\n",
-                baseMain, familySub2, baseOdd, (unsigned)sideOdd, (unsigned)oddSlot);
-  for (int i=0;i<4;i++) printIdInfo("  sceneA", sceneA[i]);
-  for (int i=0;i<4;i++) printIdInfo("  sceneB", sceneB[i]);
+  sessLog(gs, "Level1: baseMain=%s familySub2=%s baseOdd=%s sideOdd=%u oddSlot=%u\n",
+              baseMain, familySub2, baseOdd, (unsigned)sideOdd, (unsigned)oddSlot);
+  for (int i=0;i<4;i++) printIdInfo(gs, "  sceneA", gs.scene[0][i]);
+  for (int i=0;i<4;i++) printIdInfo(gs, "  sceneB", gs.scene[1][i]);
 }
 
 // Level 3: 7 from one sub of a base, 1 from a different sub of same base
-static void buildScenes_level3_subs() {
+static void buildScenes_level3_subs(GameSession& gs) {
   const char* bases[8];
   size_t baseCount = collectUniqueBases(bases, 8);
   if (baseCount == 0) {
-    Serial.println("[Master] Level3: no bases, fallback to Level2");
-    buildScenes_level2_randomBases();
+    sessLog(gs, "Level3: no bases, fallback to Level2\n");
+    buildScenes_level2_randomBases(gs);
     return;
   }
 
@@ -463,8 +698,8 @@ static void buildScenes_level3_subs() {
   }
 
   if (!baseMain || subCount < 2) {
-    Serial.println("[Master] Level3: no base with >=2 subs, fallback to Level2");
-    buildScenes_level2_randomBases();
+    sessLog(gs, "Level3: no base with >=2 subs, fallback to Level2\n");
+    buildScenes_level2_randomBases(gs);
     return;
   }
 
@@ -480,11 +715,11 @@ static void buildScenes_level3_subs() {
 
   size_t uCount = collectIdsByBaseSub(baseMain, subSame, unique, 32);
   if (uCount == 0) {
-    Serial.println("[Master] Level3: no IDs for baseMain+subSame, fallback to Level2");
-    buildScenes_level2_randomBases();
+    sessLog(gs, "Level3: no IDs for baseMain+subSame, fallback to Level2\n");
+    buildScenes_level2_randomBases(gs);
     return;
   }
-  fillWithUniqueThenReuse(sameIds, 7, unique, uCount, "Level3 base+subSame");
+  fillWithUniqueThenReuse(gs, sameIds, 7, unique, uCount, "Level3 base+subSame");
 
   uint16_t oddId;
   uint16_t uniqueOdd[32];
@@ -493,6 +728,7 @@ static void buildScenes_level3_subs() {
     oddId = pickRandomIdByBase(baseMain);
   } else {
     shuffleArray(uniqueOdd, uOddCount);
+    preferResident(gs, uniqueOdd, uOddCount);
     oddId = uniqueOdd[0];
   }
 
@@ -502,32 +738,56 @@ static void buildScenes_level3_subs() {
 
   if (sideOdd == 0) {
     for (int i=0; i<4; i++) {
-      if (i == oddSlot) sceneA[i] = oddId;
-      else              sceneA[i] = sameIds[sameIdx++];
+      if (i == oddSlot) gs.scene[0][i] = oddId;
+      else              gs.scene[0][i] = sameIds[sameIdx++];
     }
-    for (int i=0; i<4; i++) sceneB[i] = sameIds[sameIdx++];
+    for (int i=0; i<4; i++) gs.scene[1][i] = sameIds[sameIdx++];
   } else {
-    for (int i=0; i<4; i++) sceneA[i] = sameIds[sameIdx++];
+    for (int i=0; i<4; i++) gs.scene[0][i] = sameIds[sameIdx++];
     for (int i=0; i<4; i++) {
-      if (i == oddSlot) sceneB[i] = oddId;
-      else              sceneB[i] = sameIds[sameIdx++];
+      if (i == oddSlot) gs.scene[1][i] = oddId;
+      else              gs.scene[1][i] = sameIds[sameIdx++];
     }
   }
 
-  for (int i=0;i<4;i++) slotIsOdd_A[i] = (sceneA[i] == oddId);
-  for (int i=0;i<4;i++) slotIsOdd_B[i] = (sceneB[i] == oddId);
+  for (int i=0;i<4;i++) gs.slotIsOdd[0][i] = (gs.scene[0][i] == oddId);
+  for (int i=0;i<4;i++) gs.slotIsOdd[1][i] = (gs.scene[1][i] == oddId);
+  steerScenes(gs);
+
+  sessLog(gs, "Level3: baseMain=%s subSame=%s subOdd=%s sideOdd=%u oddSlot=%u\n",
+              baseMain, subSame, subOdd, (unsigned)sideOdd, (unsigned)oddSlot);
+  for (int i=0;i<4;i++) printIdInfo(gs, "  sceneA", gs.scene[0][i]);
+  for (int i=0;i<4;i++) printIdInfo(gs, "  sceneB", gs.scene[1][i]);
+}
 
-  Serial.printf("[Master] Level3: baseMain=%s subSame=%s subOdd=%s sideOdd=%u oddSlot=%u\n",
-                baseMain, subSame, subOdd, (unsigned)sideOdd, (unsigned)oddSlot);
-  for (int i=0;i<4;i++) printIdInfo("  sceneA", sceneA[i]);
-  for (int i=0;i<4;i++) printIdInfo("  sceneB", sceneB[i]);
+// Before a job for every Side (OTA, relay, sync, reload) with no game running.
+// Sides may be napping in light sleep: ping HELLO_REQ until each answers, so
+// the command that follows isn't sent into a sleeping radio. A game start
+// wakes its own pair without blocking (WAKE state).
+static void wakeSides() {
+  const uint8_t nSides = kTableSessions * 2;
+  const uint32_t t0 = millis();
+  bool awake[MAX_SIDES] = {};
+  bool all = false;
+  while (!all && millis() - t0 < SIDE_WAKE_TIMEOUT_MS) {
+    all = true;
+    for (uint8_t s = 0; s < nSides; s++) {
+      awake[s] = awake[s] || (int32_t)(g_helloMs[s] - t0) >= 0;
+      if (!awake[s]) { uint8_t m = HELLO_REQ; sendPkt(SESSION_SIDES[s / 2][s % 2], &m, 1); all = false; }
+    }
+    if (!all) delay(SIDE_WAKE_PING_MS);
+  }
+  for (uint8_t s = 0; s < nSides; s++) {
+    if (!awake[s]) Serial.printf("[Master] Side %u%c did not answer the wake ping\n", (unsigned)(s / 2), 'A' + s % 2);
+  }
+  Serial.printf("[Master] wake ping %lu ms\n", (unsigned long)(millis() - t0));
 }
 
-// OTA helper
-static void cmdOtaUpdate(const uint8_t mac[6], const char* url) {
+// OTA helper (also carries ASSET_SYNC's index URL)
+static void cmdOtaUpdate(const uint8_t mac[6], const char* url, uint8_t type = OTA_UPDATE) {
   const size_t ulen = strnlen(url, 200);
   uint8_t m[1 + 1 + 200];
-  m[0] = OTA_UPDATE;
+  m[0] = type;
   m[1] = (uint8_t)ulen;
   memcpy(m+2, url, ulen);
   sendPkt(mac, m, 2 + ulen);
@@ -537,37 +797,59 @@ static void cmdOtaUpdate(const uint8_t mac[6], const char* url) {
 static void onRecv(const esp_now_recv_info_t* info, const uint8_t* data, int len) {
   if (!info || !data || len < 1) return;
   const uint8_t type = data[0];
-  const bool isA = (std::memcmp(info->src_addr, SIDE_A_MAC, 6) == 0);
+  const uint8_t peer = peerIndex(info->src_addr);
+  Trace_rec(TR_PKT_RX, type, peer);
+
+  // Route by sender: the Side table row gives the session and A/B
+  GameSession* gs = (peer < kTableSessions * 2) ? &g_sess[peer / 2] : nullptr;
+  const uint8_t k = peer & 1;
 
   if (type == HELLO && len >= 6) {
     const uint8_t* mac = info->src_addr;
+    if (!gs) {
+      Serial.printf("[Master] HELLO from %02X:%02X:%02X:%02X:%02X:%02X, not in SESSION_SIDES\n",
+                    mac[0], mac[1], mac[2], mac[3], mac[4], mac[5]);
+      return;
+    }
+    g_helloMs[peer] = millis();
 
-    Serial.printf("[Master] HELLO from %s sideId=%u poolA=%u poolB=%u\n",
-                  isA ? "Side A" : "Side B",
+    Serial.printf("[Master] HELLO from Side %u%c sideId=%u poolA=%u poolB=%u\n",
+                  (unsigned)gs->id, 'A' + k,
                   data[1],
                   (uint16_t)(data[2] << 8 | data[3]),
                   (uint16_t)(data[4] << 8 | data[5]));
+    if (len > 6) parseCacheReport(peer, data + 6, len - 6);
 
-    cmdRoleAssign(mac, isA ? 0 : 1);
+    cmdRoleAssign(mac, k);
     cmdGameModeOne(mac, true);
 
-    if (g_state == ANNOUNCE || g_state == WAIT) {
-      cmdSetScene(mac, isA ? sceneA : sceneB);
+    if (gs->state == ANNOUNCE || gs->state == WAIT) {
+      cmdSetScene(*gs, k);
       cmdLedAllWhiteOne(mac);
       cmdStartLoopAllOne(mac);
     }
     return;
   }
 
+  if (type == HEARTBEAT && len >= 2) {
+    parseCacheReport(peer, data + 2, len - 2);
+    return;
+  }
+
   if (type == BTN_EVENT) {
-    if (len >= 3) {
-      lastSide = data[1];
-      lastSlot = data[2];
-      Serial.printf("[Master] BTN_EVENT side=%u slot=%u\n", lastSide, lastSlot);
+    if (gs && len >= 3) {
+      gs->pickSlot = data[2];
+      gs->pickSide = k;   // written last: the session polls pickSide
+      Serial.printf("[Master S%u] BTN_EVENT side=%c slot=%u\n", (unsigned)gs->id, 'A' + k, data[2]);
     }
     return;
   }
 
+  if (type == FW_NACK) {
+    MasterFwRelay_onNack(peer, data, len);
+    return;
+  }
+
   if (type == OTA_STATUS && len >= 3) {
     const char* sideName = (data[1]==0) ? "Side A" : (data[1]==1 ? "Side B" : "Side ?");
     uint8_t code = data[2];
@@ -599,183 +881,411 @@ static void nowInit() {
     return;
   }
   esp_now_register_recv_cb(onRecv);
-  addPeer(SIDE_A_MAC);
-  addPeer(SIDE_B_MAC);
+  for (uint8_t s = 0; s < kTableSessions; s++) {
+    addPeer(SESSION_SIDES[s][0]);
+    addPeer(SESSION_SIDES[s][1]);
+  }
 }
 
-// ---------- Arduino ----------
-void setup() {
-  Serial.begin(115200);
-  delay(100);
-  Serial.println("[Master] Odd One Out (Rounds 1/2/3 + unique-first + lives + shrinking timeout)");
-
-  nowInit();
+// ---------- Session state machine ----------
 
-  uint8_t mac[6];
-  esp_wifi_get_mac(WIFI_IF_STA, mac);
-  Serial.printf("Master STA MAC: %02X:%02X:%02X:%02X:%02X:%02X\n",
-                mac[0],mac[1],mac[2],mac[3],mac[4],mac[5]);
+// A deadline of this session fired; record how late the scheduler noticed it
+static void noteLate(GameSession& gs, int64_t nowUs) {
+  const uint32_t late = (uint32_t)(nowUs - gs.dueUs);
+  gs.lateN++;
+  gs.lateSumUs += late;
+  if (late > gs.lateMaxUs) gs.lateMaxUs = late;
+}
 
-  randomSeed(esp_timer_get_time());
+static void pauseThen(GameSession& gs, State next, uint32_t ms) {
+  gs.dueUs = esp_timer_get_time() + 1000LL * ms;
+  gs.nextAfterBlink = next;
+  gs.state = PAUSE;
+}
 
-  Serial.println("[Master] Manifest summary:");
-  for (size_t i=0; i<MASTER_CLIP_COUNT; i++) {
-    Serial.printf("  id=%u base=%s sub=%s sub2=%s\n",
-                  (unsigned)MASTER_CLIPS[i].id,
-                  MASTER_CLIPS[i].base,
-                  MASTER_CLIPS[i].sub,
-                  MASTER_CLIPS[i].sub2);
+static void startGame(GameSession& gs) {
+  // Relay broadcasts reach every table, and its Sides stop audio to take them
+  if (!gs.sim && MasterFwRelay_busy()) {
+    sessLog(gs, "Game start refused: firmware relay running ('x' aborts it)\n");
+    return;
   }
-
-  cmdGameMode(true);
+  gs.lives = MAX_LIVES;
+  gs.points = 0;
+  gs.roundIdx = 0;
+  gs.curTimeoutMs = BASE_TIMEOUT_MS[0];
+  sessLog(gs, "Game start (round 1, lives=%u, timeout=%lums)\n",
+          (unsigned)gs.lives, (unsigned long)gs.curTimeoutMs);
+  if (gs.state != IDLE) {
+    cmdLedAllWhite(gs);
+    gs.state = BUILD;
+    return;
+  }
+  // Its Sides may be napping: ping them awake first (WAKE)
+  gs.wakeT0Ms   = millis();
+  gs.wakePingMs = gs.wakeT0Ms - SIDE_WAKE_PING_MS;
+  gs.dueUs      = esp_timer_get_time() + 1000LL * SIDE_WAKE_TIMEOUT_MS;
+  gs.state      = WAKE;
 }
 
-void loop() {
-  static uint8_t roundIdx = 0, points = 0, lives = MAX_LIVES;
-  static uint32_t t0 = 0;
-  static uint32_t curTimeoutMs = BASE_TIMEOUT_MS[0];
-
-  if (Serial.available()) {
-    char c = Serial.read();
-    if (c=='s') {
-      lives = MAX_LIVES;
-      points = 0;
-      roundIdx = 0;
-      curTimeoutMs = BASE_TIMEOUT_MS[0];
-      Serial.printf("Game start (round 1, lives=%u, timeout=%lums)\n",
-                    (unsigned)lives, (unsigned long)curTimeoutMs);
-      cmdLedAllWhite();
-      g_state = BUILD;
-    }
-    else if (c=='e') { endGame(); }
-    else if (c=='u') {
-      Serial.println("[Master] OTA both sides");
-      cmdOtaUpdate(SIDE_A_MAC, OTA_URL_SIDE_BIN);
-      delay(200);
-      cmdOtaUpdate(SIDE_B_MAC, OTA_URL_SIDE_BIN);
-    }
-    else if (c=='a') { cmdOtaUpdate(SIDE_A_MAC, OTA_URL_SIDE_BIN); }
-    else if (c=='b') { cmdOtaUpdate(SIDE_B_MAC, OTA_URL_SIDE_BIN); }
+// Simulated player: press the odd slot, or SIM_WRONG_PCT of the time another one
+static void simTick(GameSession& gs, int64_t nowUs) {
+  if (!gs.simPickUs || nowUs < gs.simPickUs) return;
+  gs.simPickUs = 0;
+  const bool right = random(100) >= SIM_WRONG_PCT;
+  // Scan all 8 slots from a random start so a matching one is always found
+  const uint8_t start = (uint8_t)random(8);
+  for (uint8_t n = 0; n < 8; n++) {
+    const uint8_t i = (start + n) & 7, k = i >> 2, slot = i & 3;
+    if (gs.slotIsOdd[k][slot] != right) continue;
+    gs.pickSlot = slot;
+    gs.pickSide = k;
+    return;
   }
+}
+
+static void sessionTick(GameSession& gs) {
+  const int64_t nowUs = esp_timer_get_time();
+  if (gs.sim) simTick(gs, nowUs);
 
-  switch (g_state) {
+  switch (gs.state) {
     case IDLE:
       break;
 
+    case WAKE: {
+      const uint32_t now = millis();
+      bool awake[2], all = true;
+      for (uint8_t k = 0; k < 2; k++) {
+        awake[k] = (int32_t)(g_helloMs[gs.side[k]] - gs.wakeT0Ms) >= 0;
+        all = all && awake[k];
+      }
+      const bool timedOut = !all && nowUs >= gs.dueUs;
+      if (all || timedOut) {
+        if (timedOut) noteLate(gs, nowUs);
+        for (uint8_t k = 0; k < 2; k++) {
+          if (!awake[k]) sessLog(gs, "Side %c did not answer the wake ping\n", 'A' + k);
+        }
+        sessLog(gs, "wake ping %lu ms\n", (unsigned long)(now - gs.wakeT0Ms));
+        cmdLedAllWhite(gs);
+        gs.state = BUILD;
+        break;
+      }
+      if (now - gs.wakePingMs >= SIDE_WAKE_PING_MS) {
+        gs.wakePingMs = now;
+        uint8_t m = HELLO_REQ;
+        for (uint8_t k = 0; k < 2; k++) if (!awake[k]) sendSide(gs, k, &m, 1);
+      }
+    } break;
+
     case BUILD: {
-      if (roundIdx == 0) {
-        buildScenes_level1_sub2();
-        Serial.println("[Master] Using Level 1 (round 1)");
-      } else if (roundIdx == 1) {
-        buildScenes_level2_randomBases();
-        Serial.println("[Master] Using Level 2 (round 2)");
+      if (gs.roundIdx == 0) {
+        buildScenes_level1_sub2(gs);
+        sessLog(gs, "Using Level 1 (round 1)\n");
+      } else if (gs.roundIdx == 1) {
+        buildScenes_level2_randomBases(gs);
+        sessLog(gs, "Using Level 2 (round 2)\n");
       } else {
-        buildScenes_level3_subs();
-        Serial.println("[Master] Using Level 3 (round 3 - infinite)");
+        buildScenes_level3_subs(gs);
+        sessLog(gs, "Using Level 3 (round 3 - infinite)\n");
       }
+      gs.rounds++;
 
-      cmdSetScene(SIDE_A_MAC, sceneA);
-      cmdSetScene(SIDE_B_MAC, sceneB);
+      cmdSetScene(gs, 0);
+      cmdSetScene(gs, 1);
+      if (SCENE_LOG_VERBOSE) {
+        sessLog(gs, "SD loads this round: A=%u B=%u\n",
+                (unsigned)sdLoads(gs.scene[0], gs.side[0]), (unsigned)sdLoads(gs.scene[1], gs.side[1]));
+      }
 
-      Serial.printf("[Master] BUILD done -> ANNOUNCE (curTimeoutMs=%lums)\n",
-                    (unsigned long)curTimeoutMs);
-      g_state = ANNOUNCE;
+      sessLog(gs, "BUILD done -> ANNOUNCE (curTimeoutMs=%lums)\n",
+              (unsigned long)gs.curTimeoutMs);
+      gs.state = ANNOUNCE;
       break;
     }
 
     case ANNOUNCE:
-      cmdStartLoopAll();
-      cmdLedAllWhite();
-      lastSide = lastSlot = 255;
-      t0 = millis();
-      Serial.println("[Master] ANNOUNCE -> WAIT");
-      g_state = WAIT;
+      gs.pickSide = gs.pickSlot = 255;
+      cmdStartLoopAll(gs);
+      cmdLedAllWhite(gs);
+      gs.t0 = millis();
+      gs.tickSec = UINT32_MAX;
+      gs.dueUs = nowUs + 1000LL * gs.curTimeoutMs;
+      sessLog(gs, "ANNOUNCE -> WAIT\n");
+      gs.state = WAIT;
       break;
 
     case WAIT: {
+      // Countdown tick over the loops near the end of the pick window
+      uint32_t waited = millis() - gs.t0;
+      if (TICK_ID && waited < gs.curTimeoutMs && gs.curTimeoutMs - waited <= TICK_LAST_MS) {
+        uint32_t sec = (gs.curTimeoutMs - waited) / 1000;
+        if (sec != gs.tickSec) { gs.tickSec = sec; cmdPlayOneshot(gs, ONESHOT_ALL_SLOTS, TICK_ID, /*prio*/1); }
+      }
+
       // TIMEOUT = lose a life
-      if (millis() - t0 > curTimeoutMs) {
-        cmdStopAll();
-        if (lives > 0) lives--;
-        Serial.printf("[Master] TIMEOUT -> LIFE LOST (lives=%u)\n", (unsigned)lives);
-        cmdBlinkAll(/*red*/0, BLINK_ON_MS_WRONG, BLINK_OFF_MS_WRONG);
-        resultPauseUntil = millis() + BLINK_REPS * (BLINK_ON_MS_WRONG + BLINK_OFF_MS_WRONG) + 100;
-
-        if (lives == 0) {
-          Serial.println("[Master] OUT OF LIVES -> GAME OVER");
-          nextAfterBlink   = IDLE;
-        } else {
-          nextAfterBlink   = BUILD;  // try again, same round/points/timeout
-        }
-        g_state          = PAUSE;
+      if (nowUs > gs.dueUs) {
+        noteLate(gs, nowUs);
+        cmdStopAll(gs);
+        cmdPlayOneshot(gs, ONESHOT_ALL_SLOTS, STING_WRONG_ID, /*prio*/2);
+        if (gs.lives > 0) gs.lives--;
+        sessLog(gs, "TIMEOUT -> LIFE LOST (lives=%u)\n", (unsigned)gs.lives);
+        cmdBlinkAll(gs, /*red*/0, BLINK_ON_MS_WRONG, BLINK_OFF_MS_WRONG);
+
+        if (gs.lives == 0) sessLog(gs, "OUT OF LIVES -> GAME OVER\n");
+        // try again, same round/points/timeout
+        pauseThen(gs, gs.lives == 0 ? IDLE : BUILD,
+                  BLINK_REPS * (BLINK_ON_MS_WRONG + BLINK_OFF_MS_WRONG) + 100);
         break;
       }
 
-      if (lastSide != 255) {
-        Serial.printf("[Master] PICK side=%u slot=%u\n", lastSide, lastSlot);
-        cmdStopAll();
+      if (gs.pickSide != 255) {
+        const uint8_t pickSide = gs.pickSide, pickSlot = gs.pickSlot;
+        sessLog(gs, "PICK side=%u slot=%u\n", pickSide, pickSlot);
+        cmdStopAll(gs);
 
-        bool correct = (lastSide==0) ? slotIsOdd_A[lastSlot & 3]
-                                     : slotIsOdd_B[lastSlot & 3];
+        bool correct = gs.slotIsOdd[pickSide & 1][pickSlot & 3];
 
         if (correct) {
-          Serial.println("[Master] PICK -> CORRECT");
-          cmdBlinkAll(/*green*/1, BLINK_ON_MS_CORRECT, BLINK_OFF_MS_CORRECT);
-          resultPauseUntil = millis() + BLINK_REPS * (BLINK_ON_MS_CORRECT + BLINK_OFF_MS_CORRECT) + 100;
+          sessLog(gs, "PICK -> CORRECT\n");
+          cmdPlayOneshot(gs, ONESHOT_ALL_SLOTS, STING_CORRECT_ID, /*prio*/2);
+          cmdBlinkAll(gs, /*green*/1, BLINK_ON_MS_CORRECT, BLINK_OFF_MS_CORRECT);
 
           // SPEED UP timeout after each correct
-          uint32_t newTimeout = (uint32_t)(curTimeoutMs * TIME_DECAY_FACTOR);
+          uint32_t newTimeout = (uint32_t)(gs.curTimeoutMs * TIME_DECAY_FACTOR);
           if (newTimeout < MIN_TIMEOUT_MS) newTimeout = MIN_TIMEOUT_MS;
-          curTimeoutMs = newTimeout;
-          Serial.printf("[Master] Timeout decayed to %lums\n", (unsigned long)curTimeoutMs);
+          gs.curTimeoutMs = newTimeout;
+          sessLog(gs, "Timeout decayed to %lums\n", (unsigned long)gs.curTimeoutMs);
 
           // Round progression logic
-          if (++points >= 3) {
-            points = 0;
+          if (++gs.points >= 3) {
+            gs.points = 0;
 
-            if (roundIdx < 2) {
+            if (gs.roundIdx < 2) {
               // Finished round 1 or 2 -> go to next round, reset timeout for that round
-              roundIdx++;
-              uint8_t idx = (roundIdx < 3) ? roundIdx : 2;
-              curTimeoutMs = BASE_TIMEOUT_MS[idx];
-              Serial.printf("[Master] Round %u complete -> next round (timeout reset to %lums)\n",
-                            (unsigned)roundIdx, (unsigned long)curTimeoutMs);
-              nextAfterBlink = BUILD;
+              gs.roundIdx++;
+              uint8_t idx = (gs.roundIdx < 3) ? gs.roundIdx : 2;
+              gs.curTimeoutMs = BASE_TIMEOUT_MS[idx];
+              sessLog(gs, "Round %u complete -> next round (timeout reset to %lums)\n",
+                      (unsigned)gs.roundIdx, (unsigned long)gs.curTimeoutMs);
             } else {
               // Round 3 is infinite: stay in round 3, don't "win" by points
-              Serial.println("[Master] Round 3: correct point, staying in infinite round");
-              nextAfterBlink = BUILD;
+              sessLog(gs, "Round 3: correct point, staying in infinite round\n");
             }
           } else {
-            Serial.printf("[Master] Point %u in current round\n", points);
-            nextAfterBlink = BUILD;
+            sessLog(gs, "Point %u in current round\n", gs.points);
           }
-          g_state = PAUSE;
+          pauseThen(gs, BUILD, BLINK_REPS * (BLINK_ON_MS_CORRECT + BLINK_OFF_MS_CORRECT) + 100);
 
         } else {
           // WRONG PICK -> lose a life
-          if (lives > 0) lives--;
-          Serial.printf("[Master] PICK -> WRONG (lives=%u)\n", (unsigned)lives);
-          cmdBlinkAll(/*red*/0, BLINK_ON_MS_WRONG, BLINK_OFF_MS_WRONG);
-          resultPauseUntil = millis() + BLINK_REPS * (BLINK_ON_MS_WRONG + BLINK_OFF_MS_WRONG) + 100;
-
-          if (lives == 0) {
-            Serial.println("[Master] OUT OF LIVES -> GAME OVER");
-            nextAfterBlink   = IDLE;
-          } else {
-            nextAfterBlink   = BUILD;  // same round, same points, same timeout
-          }
-          g_state          = PAUSE;
+          if (gs.lives > 0) gs.lives--;
+          sessLog(gs, "PICK -> WRONG (lives=%u)\n", (unsigned)gs.lives);
+          cmdPlayOneshot(gs, ONESHOT_ALL_SLOTS, STING_WRONG_ID, /*prio*/2);
+          cmdBlinkAll(gs, /*red*/0, BLINK_ON_MS_WRONG, BLINK_OFF_MS_WRONG);
+
+          if (gs.lives == 0) sessLog(gs, "OUT OF LIVES -> GAME OVER\n");
+          // same round, same points, same timeout
+          pauseThen(gs, gs.lives == 0 ? IDLE : BUILD,
+                    BLINK_REPS * (BLINK_ON_MS_WRONG + BLINK_OFF_MS_WRONG) + 100);
         }
       }
     } break;
 
     case PAUSE:
-      if (millis() >= resultPauseUntil) {
-        Serial.printf("[Master] PAUSE done -> %s\n",
-                      (nextAfterBlink==IDLE)?"IDLE":"BUILD");
-        g_state = nextAfterBlink;
+      if (nowUs >= gs.dueUs) {
+        noteLate(gs, nowUs);
+        sessLog(gs, "PAUSE done -> %s\n",
+                (gs.nextAfterBlink==IDLE)?"IDLE":"BUILD");
+        gs.state = gs.nextAfterBlink;
+        if (gs.sim && gs.state == IDLE) startGame(gs);   // load test: keep every table busy
       }
       break;
   }
 }
+
+// ---------- Scheduler jitter / load test ----------
+
+static void resetJitter() {
+  g_passN = 0; g_passSumUs = 0; g_passMaxUs = 0;
+  g_lastPassUs = 0;
+  for (GameSession& gs : g_sess) { gs.lateN = 0; gs.lateSumUs = 0; gs.lateMaxUs = 0; gs.rounds = 0; }
+}
+
+// Time between loop passes, counted while any game runs
+static void notePass(int64_t nowUs) {
+  if (allIdle()) { g_lastPassUs = 0; return; }
+  if (g_lastPassUs) {
+    const uint32_t d = (uint32_t)(nowUs - g_lastPassUs);
+    g_passN++;
+    g_passSumUs += d;
+    if (d > g_passMaxUs) g_passMaxUs = d;
+  }
+  g_lastPassUs = nowUs;
+}
+
+static void printJitter() {
+  Serial.printf("[SCHED] %u session(s), loop pass mean %lu us, max %lu us (%lu passes)\n",
+                (unsigned)g_numSessions,
+                (unsigned long)(g_passN ? g_passSumUs / g_passN : 0),
+                (unsigned long)g_passMaxUs, (unsigned long)g_passN);
+  for (uint8_t s = 0; s < g_numSessions; s++) {
+    const GameSession& gs = g_sess[s];
+    Serial.printf("[SCHED]   S%u%s %-8s %lu rounds, deadlines late mean %lu us, max %lu us (%lu)\n",
+                  (unsigned)gs.id, gs.sim ? " (sim)" : "", kStateName[gs.state],
+                  (unsigned long)gs.rounds,
+                  (unsigned long)(gs.lateN ? gs.lateSumUs / gs.lateN : 0),
+                  (unsigned long)gs.lateMaxUs, (unsigned long)gs.lateN);
+  }
+}
+
+// Serial 'J': one more simulated session every SIM_LOAD_STEP_MS, a line per count
+static bool    g_loadTest = false;
+static int64_t g_loadStepEndUs = 0;
+
+static void loadTestAdd() {
+  GameSession& gs = g_sess[g_numSessions++];
+  gs.simPickUs = 0;
+  gs.state = IDLE;
+  resetJitter();
+  startGame(gs);
+  g_loadStepEndUs = esp_timer_get_time() + 1000LL * SIM_LOAD_STEP_MS;
+}
+
+static void loadTestStart() {
+  if (g_loadTest) { Serial.println("[SCHED] load test already running"); return; }
+  if (kTableSessions >= MAX_SESSIONS) { Serial.println("[SCHED] no room for simulated sessions (MAX_SESSIONS)"); return; }
+  Serial.printf("[SCHED] load test: 1..%u simulated sessions, %u ms each\n",
+                (unsigned)(MAX_SESSIONS - kTableSessions), (unsigned)SIM_LOAD_STEP_MS);
+  Serial.println("[SCHED] sessions  pass mean/max us  late mean/max us  deadlines  rounds");
+  g_loadTest = true;
+  loadTestAdd();
+}
+
+static void loadTestTick() {
+  if (!g_loadTest || esp_timer_get_time() < g_loadStepEndUs) return;
+
+  uint32_t lateN = 0, lateMax = 0, rounds = 0;
+  uint64_t lateSum = 0;
+  for (uint8_t s = 0; s < g_numSessions; s++) {
+    const GameSession& gs = g_sess[s];
+    lateN += gs.lateN; lateSum += gs.lateSumUs; rounds += gs.rounds;
+    if (gs.lateMaxUs > lateMax) lateMax = gs.lateMaxUs;
+  }
+  Serial.printf("[SCHED] %8u  %7lu / %-7lu  %7lu / %-7lu  %9lu  %6lu\n",
+                (unsigned)g_numSessions,
+                (unsigned long)(g_passN ? g_passSumUs / g_passN : 0), (unsigned long)g_passMaxUs,
+                (unsigned long)(lateN ? lateSum / lateN : 0), (unsigned long)lateMax,
+                (unsigned long)lateN, (unsigned long)rounds);
+
+  if (g_numSessions < MAX_SESSIONS) { loadTestAdd(); return; }
+
+  for (uint8_t s = kTableSessions; s < g_numSessions; s++) {
+    g_sess[s].state = IDLE;
+    g_sess[s].simPickUs = 0;
+  }
+  g_numSessions = kTableSessions;
+  g_loadTest = false;
+  Serial.println("[SCHED] load test done");
+}
+
+// ---------- Arduino ----------
+void setup() {
+  Serial.begin(115200);
+  delay(100);
+  Serial.println("[Master] Odd One Out (Rounds 1/2/3 + unique-first + lives + shrinking timeout)");
+  Trace_begin('M');
+
+  for (uint8_t s = 0; s < MAX_SESSIONS; s++) {
+    GameSession& gs = g_sess[s];
+    gs.id = s;
+    gs.sim = (s >= kTableSessions);
+    gs.side[0] = (uint8_t)(s * 2);
+    gs.side[1] = (uint8_t)(s * 2 + 1);
+    if (!gs.sim) { gs.mac[0] = SESSION_SIDES[s][0]; gs.mac[1] = SESSION_SIDES[s][1]; }
+  }
+
+  nowInit();
+
+  uint8_t mac[6];
+  esp_wifi_get_mac(WIFI_IF_STA, mac);
+  Serial.printf("Master STA MAC: %02X:%02X:%02X:%02X:%02X:%02X\n",
+                mac[0],mac[1],mac[2],mac[3],mac[4],mac[5]);
+  Serial.printf("[Master] %u session(s) (SESSION_SIDES)\n", (unsigned)kTableSessions);
+
+  randomSeed(esp_timer_get_time());
+
+  Serial.println("[Master] Manifest summary:");
+  for (size_t i=0; i<MASTER_CLIP_COUNT; i++) {
+    Serial.printf("  id=%u base=%s sub=%s sub2=%s\n",
+                  (unsigned)MASTER_CLIPS[i].id,
+                  MASTER_CLIPS[i].base,
+                  MASTER_CLIPS[i].sub,
+                  MASTER_CLIPS[i].sub2);
+  }
+
+  for (uint8_t s = 0; s < kTableSessions; s++) cmdGameMode(g_sess[s], true);
+}
+
+static void pollSerial() {
+  if (!Serial.available()) return;
+  char c = Serial.read();
+  GameSession& sel = g_sess[g_selected];
+  if (allIdle() && c && strchr("uabfFyr", c)) wakeSides();
+  if (c >= '0' && c <= '9') {
+    if (c - '0' < kTableSessions) {
+      g_selected = (uint8_t)(c - '0');
+      Serial.printf("[Master] session %u selected (%s)\n", (unsigned)g_selected, kStateName[g_sess[g_selected].state]);
+    } else {
+      Serial.printf("[Master] no session %c: SESSION_SIDES has %u row(s)\n", c, (unsigned)kTableSessions);
+    }
+  }
+  else if (c=='s') { startGame(sel); }
+  else if (c=='e') { endGame(sel); }
+  else if (c=='u') {
+    Serial.println("[Master] OTA both sides");
+    cmdOtaUpdate(SIDE_A_MAC, OTA_URL_SIDE_BIN);
+    delay(200);
+    cmdOtaUpdate(SIDE_B_MAC, OTA_URL_SIDE_BIN);
+  }
+  else if (c=='a') { cmdOtaUpdate(SIDE_A_MAC, OTA_URL_SIDE_BIN); }
+  else if (c=='b') { cmdOtaUpdate(SIDE_B_MAC, OTA_URL_SIDE_BIN); }
+  else if (c=='f' || c=='F') {
+    if (!allIdle() || MasterFwRelay_busy()) {
+      Serial.println("[Master] firmware relay needs an idle game");
+    } else if ((c=='F' && MasterFwRelay_staged()) || MasterFwRelay_fetch(OTA_URL_SIDE_BIN)) {
+      uint16_t mask = 0;   // bits 2s, 2s+1: row s (MasterFwRelay.h)
+      for (uint8_t s = 0; s < kTableSessions; s++) mask |= (uint16_t)(3u << (s * 2));
+      MasterFwRelay_start(mask);
+    }
+  }
+  else if (c=='x') { MasterFwRelay_abort(); }
+  else if (c=='y') {
+    Serial.println("[Master] asset sync all sides");
+    for (uint8_t s = 0; s < kTableSessions; s++) {
+      cmdOtaUpdate(SESSION_SIDES[s][0], ASSET_INDEX_URL, ASSET_SYNC);
+      cmdOtaUpdate(SESSION_SIDES[s][1], ASSET_INDEX_URL, ASSET_SYNC);
+    }
+  }
+  else if (c=='r') {
+    Serial.println("[Master] manifest reload all sides");
+    cmdManifestReload();
+  }
+  else if (c=='t') { Trace_dump(Serial); }
+  else if (c=='T') { Trace_clear(); Serial.println("[Master] trace cleared"); }
+  else if (c=='c') { g_cacheAware = !g_cacheAware; printSideInfo(); }
+  else if (c=='j') { printJitter(); resetJitter(); }
+  else if (c=='J') { loadTestStart(); }
+}
+
+// One non-blocking pass over every session
+void loop() {
+  MasterFwRelay_tick();
+
+  // Between games there is nothing to time: let the CPU idle between polls
+  if (allIdle() && !MasterFwRelay_busy()) delay(MASTER_IDLE_POLL_MS);
+
+  pollSerial();
+  loadTestTick();
+
+  notePass(esp_timer_get_time());
+  for (uint8_t s = 0; s < g_numSessions; s++) sessionTick(g_sess[s]);
+}
@@ -0,0 +1,37 @@
+#include "Trace.h"
+
+TraceRec              g_traceRing[kTraceCap];
+std::atomic<uint32_t> g_traceHead{0};
+
+static char s_devTag = '?';
+
+void Trace_begin(char devTag) {
+  s_devTag = devTag;
+  Trace_clear();
+}
+
+void Trace_setDevice(char devTag) { s_devTag = devTag; }
+
+void Trace_clear() {
+  g_traceHead.store(0, std::memory_order_relaxed);
+  memset(g_traceRing, 0, sizeof(g_traceRing));
+}
+
+void Trace_dump(Print& out) {
+  // Snapshot the head; records written while we print may show up torn at the
+  // oldest end, which the decoder tolerates (it drops ev==0 / out-of-order rows).
+  const uint32_t head  = g_traceHead.load(std::memory_order_acquire);
+  const uint32_t count = (head < kTraceCap) ? head : kTraceCap;
+  const uint32_t first = head - count;
+
+  out.printf("#TRACE dev=%c now=%lu count=%lu dropped=%lu\n",
+             s_devTag, (unsigned long)(uint32_t)esp_timer_get_time(),
+             (unsigned long)count, (unsigned long)(head - count));
+  for (uint32_t i = first; i < head; i++) {
+    const TraceRec r = g_traceRing[i & (kTraceCap - 1)];
+    if (r.ev == TR_NONE) continue;
+    out.printf("T %08lx %02x %02x %04x\n",
+               (unsigned long)r.t_us, (unsigned)r.ev, (unsigned)r.a, (unsigned)r.b);
+  }
+  out.printf("#TRACE end dev=%c\n", s_devTag);
+}
@@ -0,0 +1,60 @@
+#pragma once
+#include <Arduino.h>
+#include <esp_timer.h>
+#include <atomic>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Compact binary event trace shared by Master and Sides.
+//
+// Every record is 8 bytes: a 32-bit microsecond timestamp (esp_timer, wraps
+// after ~71 min), an event code and two small arguments. Writers only do an
+// atomic fetch_add on the head index, so Trace_rec() is safe from the ESP-NOW
+// callback, the main loop and worker tasks alike, and costs far less than a
+// Serial.printf.
+//
+// Dump over Serial with Trace_dump(); tools/trace_merge.py merges the dumps of
+// all devices onto one timeline. Keep this file identical on Master and Side.
+// ─────────────────────────────────────────────────────────────────────────────
+
+enum TraceEvent : uint8_t {
+  TR_NONE         = 0,
+  TR_PKT_TX       = 1,  // a = msg type, b = peer (0=A, 1=B, 0xFF=Master)
+  TR_PKT_RX       = 2,  // a = msg type, b = peer (0=A, 1=B, 0xFF=Master)
+  TR_SCENE_COMMIT = 3,  // a = mask of slots with a clip, b = slot 0 id
+  TR_FIRST_AUDIO  = 4,  // a = slot, b = sample offset inside the rendered frame
+  TR_BTN_EDGE     = 5,  // a = slot, b = 1 press / 0 release
+  TR_BLINK_START  = 6,  // a = color, b = on_ms
+  TR_MARK         = 7   // free-form marker, a/b user defined
+};
+
+#define TRACE_PEER_MASTER 0xFF
+
+struct TraceRec {
+  uint32_t t_us;
+  uint8_t  ev;
+  uint8_t  a;
+  uint16_t b;
+};
+static_assert(sizeof(TraceRec) == 8, "TraceRec must stay 8 bytes");
+
+static constexpr uint32_t kTraceCap = 1024;   // records, power of two (8 KB)
+
+extern TraceRec              g_traceRing[kTraceCap];
+extern std::atomic<uint32_t> g_traceHead;
+
+// Set the device tag printed in dumps ('M', 'A', 'B' or '?').
+void Trace_begin(char devTag);
+void Trace_setDevice(char devTag);
+
+static inline void Trace_rec(uint8_t ev, uint8_t a = 0, uint16_t b = 0) {
+  const uint32_t i = g_traceHead.fetch_add(1, std::memory_order_relaxed);
+  TraceRec& r = g_traceRing[i & (kTraceCap - 1)];
+  r.t_us = (uint32_t)esp_timer_get_time();
+  r.a    = a;
+  r.b    = b;
+  r.ev   = ev;
+}
+
+// Print the ring (oldest first) as "T <hex>" lines framed by #TRACE headers.
+void Trace_dump(Print& out);
+void Trace_clear();
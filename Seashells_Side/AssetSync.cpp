@@ -0,0 +1,368 @@
+#include "AssetSync.h"
+#include "ConfigSide.h"
+#include "GameBusSide.h"
+#include "Manifest.h"
+#include "OtaUpdate.h"
+#include "SdBus.h"
+
+#include <SD.h>
+#include <WiFi.h>
+#include <HTTPClient.h>
+#include <mbedtls/sha256.h>
+
+extern void side_stopAll();
+extern void side_setScene(uint16_t ids[4]);
+extern void side_blinkAll(uint8_t color, uint16_t on_ms, uint16_t off_ms);
+extern void otaShowProgress(uint8_t pct);
+
+static volatile bool s_syncRequested = false;
+static char          s_indexUrl[ASSET_URL_MAX] = ASSET_INDEX_URL;
+
+static const char* kLocalIndex = "/assets.idx";
+
+struct AssetEntry {
+  char     sha[65];
+  uint32_t size;
+  char     path[ASSET_PATH_MAX];
+  bool     present;   // remote: on SD with this hash after the sync; local: still listed remotely
+};
+
+struct SyncStats {
+  uint32_t checked = 0, same = 0, adopted = 0, fetched = 0, removed = 0, failed = 0;
+  uint32_t bytesOnAir = 0, bytesHashed = 0;
+};
+
+void side_setAssetUrl(const char* p, uint8_t n) {
+  n = (uint8_t)min((int)n, ASSET_URL_MAX - 1);
+  memcpy(s_indexUrl, p, n);
+  s_indexUrl[n] = 0;
+  Serial.printf("[SYNC] index URL set: %s\n", s_indexUrl);
+}
+void side_requestAssetSync() { s_syncRequested = true; }
+
+// ───────────────── Index files ─────────────────
+
+// "<sha256> <size> <path>"; the path runs to the end of the line
+static bool parseLine(const char* s, AssetEntry& e) {
+  while (*s == ' ') s++;
+  if (*s == '#' || !*s) return false;
+  int n = 0;
+  while (n < 64 && isxdigit((unsigned char)s[n])) { e.sha[n] = (char)tolower(s[n]); n++; }
+  if (n != 64 || s[64] != ' ') return false;
+  e.sha[64] = 0;
+  char* end = nullptr;
+  e.size = (uint32_t)strtoul(s + 65, &end, 10);
+  if (!end || *end != ' ' || end[1] != '/') return false;
+  size_t len = strcspn(end + 1, "\r\n");
+  if (len >= sizeof(e.path)) return false;
+  memcpy(e.path, end + 1, len);
+  e.path[len] = 0;
+  e.present = false;
+  return true;
+}
+
+static size_t parseIndex(const char* text, size_t textLen, AssetEntry* out, size_t maxOut) {
+  size_t n = 0;
+  for (size_t i = 0; i < textLen && n < maxOut; ) {
+    const char* line = text + i;
+    const char* nl = (const char*)memchr(line, '\n', textLen - i);
+    size_t len = nl ? (size_t)(nl - line) : textLen - i;
+    if (len < 200) {
+      char buf[200];
+      memcpy(buf, line, len);
+      buf[len] = 0;
+      if (parseLine(buf, out[n])) n++;
+    }
+    i += len + 1;
+  }
+  return n;
+}
+
+static size_t loadLocalIndex(AssetEntry* out, size_t maxOut) {
+  File f = SD.open(kLocalIndex, FILE_READ);
+  if (!f) return 0;
+  size_t n = 0;
+  while (f.available() && n < maxOut) {
+    String line = f.readStringUntil('\n');
+    if (parseLine(line.c_str(), out[n])) n++;
+  }
+  f.close();
+  return n;
+}
+
+// Written to a temporary name first; a sync cut short keeps the old index
+static bool saveLocalIndex(const AssetEntry* e, size_t n) {
+  char tmp[32];
+  snprintf(tmp, sizeof(tmp), "%s.tmp", kLocalIndex);
+  File f = SD.open(tmp, FILE_WRITE);
+  if (!f) return false;
+  for (size_t i = 0; i < n; i++)
+    if (e[i].present) f.printf("%s %lu %s\n", e[i].sha, (unsigned long)e[i].size, e[i].path);
+  f.close();
+  SD.remove(kLocalIndex);
+  return SD.rename(tmp, kLocalIndex);
+}
+
+static const AssetEntry* findPath(const AssetEntry* e, size_t n, const char* path) {
+  for (size_t i = 0; i < n; i++) if (!strcmp(e[i].path, path)) return &e[i];
+  return nullptr;
+}
+
+// ───────────────── Files ─────────────────
+
+static void hexDigest(const uint8_t d[32], char out[65]) {
+  for (int i = 0; i < 32; i++) snprintf(out + i * 2, 3, "%02x", d[i]);
+}
+
+static bool hashSdFile(const char* path, char out[65], SyncStats& st) {
+  File f = SD.open(path, FILE_READ);
+  if (!f) return false;
+  mbedtls_sha256_context ctx;
+  mbedtls_sha256_init(&ctx);
+  mbedtls_sha256_starts(&ctx, 0);
+  uint8_t buf[2048];
+  int n;
+  while ((n = f.read(buf, sizeof(buf))) > 0) { mbedtls_sha256_update(&ctx, buf, n); st.bytesHashed += n; }
+  f.close();
+  uint8_t d[32];
+  mbedtls_sha256_finish(&ctx, d);
+  mbedtls_sha256_free(&ctx);
+  hexDigest(d, out);
+  return true;
+}
+
+static void makeParentDirs(const char* path) {
+  char dir[ASSET_PATH_MAX];
+  for (const char* p = strchr(path + 1, '/'); p; p = strchr(p + 1, '/')) {
+    size_t len = (size_t)(p - path);
+    memcpy(dir, path, len);
+    dir[len] = 0;
+    if (!SD.exists(dir)) SD.mkdir(dir);
+  }
+}
+
+// GET url into RAM (the remote index); caller frees
+static char* fetchText(const char* url, size_t* outLen, SyncStats& st) {
+  HTTPClient http;
+  WiFiClient client;
+  http.setReuse(false);
+  http.setTimeout(OTA_HTTP_TIMEOUT_MS);
+  if (!http.begin(client, url)) return nullptr;
+  int code = http.GET();
+  if (code != HTTP_CODE_OK) {
+    Serial.printf("[SYNC] index HTTP %d\n", code);
+    http.end();
+    return nullptr;
+  }
+  String body = http.getString();
+  http.end();
+  st.bytesOnAir += body.length();
+  char* text = (char*)ps_malloc(body.length() + 1);
+  if (!text) return nullptr;
+  memcpy(text, body.c_str(), body.length() + 1);
+  *outLen = body.length();
+  return text;
+}
+
+// GET url into <path>.tmp, check size + hash, then replace path
+static bool fetchFile(const char* url, const AssetEntry& e, SyncStats& st) {
+  char tmp[ASSET_PATH_MAX + 4];
+  snprintf(tmp, sizeof(tmp), "%s.tmp", e.path);
+
+  HTTPClient http;
+  WiFiClient client;
+  http.setReuse(false);
+  http.setTimeout(OTA_HTTP_TIMEOUT_MS);
+  if (!http.begin(client, url)) return false;
+  int code = http.GET();
+  if (code != HTTP_CODE_OK) {
+    Serial.printf("[SYNC] %s: HTTP %d\n", e.path, code);
+    http.end();
+    return false;
+  }
+
+  makeParentDirs(e.path);
+  File f = SD.open(tmp, FILE_WRITE);
+  if (!f) {
+    Serial.printf("[SYNC] cannot create %s\n", tmp);
+    http.end();
+    return false;
+  }
+
+  mbedtls_sha256_context ctx;
+  mbedtls_sha256_init(&ctx);
+  mbedtls_sha256_starts(&ctx, 0);
+  WiFiClient* stream = http.getStreamPtr();
+  uint8_t  buf[4096];
+  uint32_t got = 0, lastData = millis();
+  bool ok = true;
+  while (got < e.size) {
+    size_t avail = stream->available();
+    if (!avail) {
+      if (!stream->connected() || millis() - lastData > OTA_STALL_MS) { ok = false; break; }
+      delay(1);
+      continue;
+    }
+    int n = stream->read(buf, min(avail, min(sizeof(buf), (size_t)(e.size - got))));
+    if (n <= 0) continue;
+    if (f.write(buf, n) != (size_t)n) { ok = false; break; }
+    mbedtls_sha256_update(&ctx, buf, n);
+    got += n;
+    lastData = millis();
+  }
+  f.close();
+  http.end();
+  st.bytesOnAir += got;
+
+  uint8_t d[32];
+  char hex[65];
+  mbedtls_sha256_finish(&ctx, d);
+  mbedtls_sha256_free(&ctx);
+  hexDigest(d, hex);
+  if (!ok || got != e.size || strcmp(hex, e.sha) != 0) {
+    Serial.printf("[SYNC] %s: bad download (%lu/%lu bytes%s)\n", e.path, (unsigned long)got,
+                  (unsigned long)e.size, ok && got == e.size ? ", sha256 mismatch" : "");
+    SD.remove(tmp);
+    return false;
+  }
+  // FAT can't rename over a file. Until the rename lands the old index still
+  // names the old hash, so a cut here is simply fetched again next time.
+  if (SD.exists(e.path)) SD.remove(e.path);
+  if (!SD.rename(tmp, e.path)) {
+    Serial.printf("[SYNC] rename %s failed\n", tmp);
+    return false;
+  }
+  return true;
+}
+
+// ───────────────── Sync ─────────────────
+
+static bool syncFiles(const char* indexUrl, SyncStats& st, const char** changed, size_t* nChanged) {
+  AssetEntry* remote = (AssetEntry*)ps_malloc(ASSET_MAX_FILES * sizeof(AssetEntry));
+  AssetEntry* local  = (AssetEntry*)ps_malloc(ASSET_MAX_FILES * sizeof(AssetEntry));
+  if (!remote || !local) { free(remote); free(local); Serial.println("[SYNC] alloc FAIL"); return false; }
+
+  size_t textLen = 0;
+  char* text = fetchText(indexUrl, &textLen, st);
+  if (!text) { free(remote); free(local); return false; }
+  const size_t nRemote = parseIndex(text, textLen, remote, ASSET_MAX_FILES);
+  free(text);
+  const size_t nLocal = loadLocalIndex(local, ASSET_MAX_FILES);
+  Serial.printf("[SYNC] remote index %u files, local %u\n", (unsigned)nRemote, (unsigned)nLocal);
+
+  // File URLs sit next to the index
+  char url[ASSET_URL_MAX + ASSET_PATH_MAX];
+  const char* slash = strrchr(indexUrl, '/');
+  const size_t baseLen = slash ? (size_t)(slash - indexUrl) : strlen(indexUrl);
+
+  *nChanged = 0;
+  for (size_t i = 0; i < nRemote; i++) {
+    AssetEntry& r = remote[i];
+    st.checked++;
+    otaShowProgress((uint8_t)(i * 100 / nRemote));
+
+    File f = SD.open(r.path, FILE_READ);
+    const bool onCard = (bool)f;
+    const uint32_t cardSize = onCard ? (uint32_t)f.size() : 0;
+    if (onCard) f.close();
+
+    const AssetEntry* l = findPath(local, nLocal, r.path);
+    if (onCard && cardSize == r.size) {
+      if (l && !strcmp(l->sha, r.sha)) { r.present = true; st.same++; continue; }
+      char hex[65];
+      if (!l && hashSdFile(r.path, hex, st) && !strcmp(hex, r.sha)) { r.present = true; st.adopted++; continue; }
+    }
+
+    snprintf(url, sizeof(url), "%.*s%s", (int)baseLen, indexUrl, r.path);
+    Serial.printf("[SYNC] fetch %s (%lu bytes)\n", r.path, (unsigned long)r.size);
+    if (fetchFile(url, r, st)) {
+      r.present = true;
+      st.fetched++;
+      if (*nChanged < ASSET_MAX_CHANGED) changed[(*nChanged)++] = strdup(r.path);
+    } else {
+      st.failed++;
+      // Keep the old entry if the old file survived the failed fetch (it is
+      // removed just before the rename) so the index stays truthful
+      if (onCard && SD.exists(r.path)) {
+        if (l) { r = *l; r.present = true; }
+      } else if (onCard && *nChanged < ASSET_MAX_CHANGED) {
+        changed[(*nChanged)++] = strdup(r.path);   // gone: drop its cached copy
+      }
+    }
+  }
+
+  // Remove what the last sync installed and the server no longer lists
+  for (size_t i = 0; i < nLocal; i++) {
+    if (findPath(remote, nRemote, local[i].path)) continue;
+    if (SD.exists(local[i].path) && SD.remove(local[i].path)) {
+      Serial.printf("[SYNC] removed %s\n", local[i].path);
+      st.removed++;
+      if (*nChanged < ASSET_MAX_CHANGED) changed[(*nChanged)++] = strdup(local[i].path);
+    }
+  }
+
+  if (!saveLocalIndex(remote, nRemote)) Serial.println("[SYNC] could not write /assets.idx");
+  free(remote);
+  free(local);
+  return st.failed == 0;
+}
+
+bool AssetSync_run(const char* indexUrl) {
+  Serial.printf("[SYNC] index %s\n", indexUrl);
+  const uint32_t t0 = millis();
+
+  // Nothing may hold a file or a cached buffer while they're replaced
+  side_stopAll();
+  uint16_t none[4] = {0, 0, 0, 0};
+  side_setScene(none);
+  side_blinkAll(/*white*/2, 60, 60);
+  otaShowProgress(0);
+
+  bool ok = false;
+  SyncStats st;
+  const char* changed[ASSET_MAX_CHANGED];
+  size_t nChanged = 0;
+  if (Ota_joinWifi()) {
+    SdBus_lock();
+    ok = syncFiles(indexUrl, st, changed, &nChanged);
+    SdBus_unlock();
+  }
+  WiFi.disconnect(true, true);
+  GameBus_deinit();
+  GameBus_init();   // back on the ESP-NOW channel
+  const uint32_t netMs = millis() - t0;
+
+  // Incremental refresh: only the cached clips behind changed files
+  bool manifestChanged = false;
+  for (size_t i = 0; i < nChanged; i++) manifestChanged |= !strcmp(changed[i], "/manifest.csv");
+  if (manifestChanged) {
+    // Changed clips load in the background; the scene is empty, so loop()
+    // swaps the catalog in as soon as they are read
+    Manifest_reload(changed, nChanged);
+  } else if (nChanged) {
+    SdBus_lock();
+    Manifest_refreshPaths(changed, nChanged);
+    SdBus_unlock();
+  }
+  for (size_t i = 0; i < nChanged; i++) free((void*)changed[i]);
+
+  Serial.printf("[SYNC] %lu files: %lu unchanged, %lu matched on card, %lu fetched, %lu removed, %lu failed\n",
+                (unsigned long)st.checked, (unsigned long)st.same, (unsigned long)st.adopted,
+                (unsigned long)st.fetched, (unsigned long)st.removed, (unsigned long)st.failed);
+  Serial.printf("[SYNC] %lu bytes over WiFi, %lu hashed on card, sync %lu ms, refresh %lu ms\n",
+                (unsigned long)st.bytesOnAir, (unsigned long)st.bytesHashed,
+                (unsigned long)netMs, (unsigned long)(millis() - t0 - netMs));
+
+  otaShowProgress(100);
+  if (ok) side_blinkAll(/*green*/1, 140, 120);
+  else    side_blinkAll(/*red*/0, 160, 120);
+  return ok;
+}
+
+void AssetSync_loopTick() {
+  if (!s_syncRequested) return;
+  // The refresh afterwards needs the boot precache and any reload done
+  if (Manifest_warming() || Manifest_reloadLoading()) return;
+  s_syncRequested = false;
+  AssetSync_run(s_indexUrl);
+}
@@ -0,0 +1,27 @@
+#pragma once
+#include <Arduino.h>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Incremental SD asset sync over the OTA WiFi path.
+//
+// The server publishes an index (tools/asset_manifest.py), one file per line:
+//     <sha256 hex> <size> </path/on/sd>
+// next to the files themselves (URL = index directory + path). The Side keeps
+// the index of what it installed in /assets.idx and only downloads entries
+// whose hash differs; a file the index doesn't know yet is hashed on SD
+// first, so a first sync doesn't re-download a card that's already right.
+// Downloads go to <path>.tmp, are hash-checked, then renamed over the old
+// file. Files the previous index listed but the new one doesn't are removed.
+// Afterwards the cached clips of changed files are reloaded; when
+// /manifest.csv changed the catalog is hot-reloaded (Manifest_reload).
+// ─────────────────────────────────────────────────────────────────────────────
+
+// Called from GameBusSide.cpp's ASSET_SYNC handler (same payload as OTA_UPDATE)
+void side_setAssetUrl(const char* p, uint8_t n);
+void side_requestAssetSync();
+
+// Blocking: stops playback, joins WiFi, syncs, returns to ESP-NOW
+bool AssetSync_run(const char* indexUrl);
+
+// Call from loop(); runs a requested sync
+void AssetSync_loopTick();
@@ -1,4 +1,6 @@
 #include "AudioEngine.h"
+#include "Meter.h"
+#include "SdBus.h"
 #include <SPI.h>
 #include <math.h>
 
@@ -145,6 +147,14 @@ static bool parseWavHeader(File& f, WavInfo& wi, const char* tag) {
   return true;
 }
 
+// Point the SD stream at the WAV data chunk, narrowed to the manifest trim.
+static void setSdRange(TrackSD& sd, const WavInfo& wi) {
+  sd.dataStart = wi.dataStart;
+  sd.dataEnd   = wi.dataStart + wi.dataBytes;
+  if (sd.trimEnd && wi.dataStart + sd.trimEnd * 2 < sd.dataEnd) sd.dataEnd = wi.dataStart + sd.trimEnd * 2;
+  if (sd.dataStart + sd.trimStart * 2 < sd.dataEnd)             sd.dataStart += sd.trimStart * 2;
+}
+
 void listRootOnce() {
   Serial.println(F("SD root listing:"));
   File root = SD.open("/");
@@ -166,43 +176,38 @@ bool remountSD(uint32_t hz) {
   return ok;
 }
 
-bool remountAndReopenAll(uint32_t hz1, uint32_t hz2) {
-  if (!remountSD(hz1)) if (!remountSD(hz2)) return false;
-  bool any = false;
-  for (int i=0;i<4;++i) {
-    if (ch[i].useRAM || ch[i].isTone) { any = true; continue; } // RAM cached or tone: nothing to reopen
-    if (!ch[i].path.length()) continue;
-
-    File f = SD.open(ch[i].path.c_str(), FILE_READ);
-    if (f) {
-      WavInfo wi;
-      if (!parseWavHeader(f, wi, "REOPEN")) {
-        Serial.printf("CH%d: REOPEN WAV PARSE FAIL %s\n", i+1, ch[i].path.c_str());
-        f.close();
-        continue;
-      }
-      ch[i].sd.f = f;
-      ch[i].sd.dataStart = wi.dataStart;
-      ch[i].sd.dataEnd   = wi.dataStart + wi.dataBytes;
-      ch[i].sd.cur = 0;
-      ch[i].sd.f.seek(ch[i].sd.dataStart);
-      Serial.printf("CH%d: REOPENED %s (dataStart=%lu)\n", i+1, ch[i].path.c_str(), (unsigned long)wi.dataStart);
-      any = true;
-    } else {
-      Serial.printf("CH%d: REOPEN FAILED %s\n", i+1, ch[i].path.c_str());
-    }
+// Runs on the SdBus worker with the bus held. The cursor is left alone so the
+// stream resumes where the fault interrupted it.
+bool reopenAtCursor(Channel& C, int idx) {
+  if (C.sd.f) C.sd.f.close();
+  File f = SD.open(C.path(), FILE_READ);
+  if (!f) {
+    Serial.printf("CH%d: REOPEN FAILED %s\n", idx+1, C.path());
+    return false;
   }
-  return any;
+  WavInfo wi;
+  if (!parseWavHeader(f, wi, "REOPEN")) {
+    Serial.printf("CH%d: REOPEN WAV PARSE FAIL %s\n", idx+1, C.path());
+    f.close();
+    return false;
+  }
+  C.sd.f = f;
+  setSdRange(C.sd, wi);
+  if (C.sd.cur > C.sd.dataEnd - C.sd.dataStart) C.sd.cur = 0;
+  C.sd.f.seek(C.sd.dataStart + C.sd.cur);
+  C.sd.fault = false;
+  Serial.printf("CH%d: REOPENED %s @%lu\n", idx+1, C.path(), (unsigned long)C.sd.cur);
+  return true;
 }
 
 bool openForSD(Channel& C, int idx) {
   if (C.sd.f) C.sd.f.close();
-  if (!C.path.length()) {
+  if (!C.path()[0]) {
     Serial.printf("CH%d: OPEN (no path)\n", idx+1);
     return false;
   }
-  C.sd.f = SD.open(C.path.c_str(), FILE_READ);
-  Serial.printf("CH%d: OPEN %s %s\n", idx+1, C.path.c_str(), C.sd.f?"OK":"FAIL");
+  C.sd.f = SD.open(C.path(), FILE_READ);
+  if (SCENE_LOG_VERBOSE || !C.sd.f) Serial.printf("CH%d: OPEN %s %s\n", idx+1, C.path(), C.sd.f?"OK":"FAIL");
   if (!C.sd.f) return false;
 
   WavInfo wi;
@@ -213,8 +218,7 @@ bool openForSD(Channel& C, int idx) {
     return false;
   }
 
-  C.sd.dataStart = wi.dataStart;
-  C.sd.dataEnd   = wi.dataStart + wi.dataBytes;
+  setSdRange(C.sd, wi);
   if (C.sd.dataEnd <= C.sd.dataStart) {
     Serial.printf("CH%d: BAD WAV data range (%lu..%lu)\n", idx+1,
                   (unsigned long)C.sd.dataStart, (unsigned long)C.sd.dataEnd);
@@ -226,33 +230,59 @@ bool openForSD(Channel& C, int idx) {
   return true;
 }
 
-bool loadWavIntoRam(const char* path, const char* tag, int16_t** outBuf, size_t* outSamples) {
+// bg: a background loader that takes the SD bus itself, one SD_BG_CHUNK_BYTES
+// read at a time, so streaming slots and scene setup get it in between.
+// Otherwise the caller holds the bus throughout.
+static bool loadWav(const char* path, const char* tag, int16_t** outBuf, size_t* outSamples, size_t maxBytes,
+                    size_t* capBytes, bool bg) {
+  if (bg) SdBus_lockChunk();
   File f = SD.open(path, FILE_READ);
-  if (!f) { Serial.printf("%s: RAM load OPEN FAIL %s\n", tag, path); return false; }
-
   WavInfo wi;
-  if (!parseWavHeader(f, wi, tag)) { f.close(); return false; }
+  const bool headerOk = f && parseWavHeader(f, wi, tag);
+  if (bg) SdBus_unlockChunk();
+  auto closeFile = [&]() {
+    if (bg) SdBus_lockChunk();
+    f.close();
+    if (bg) SdBus_unlockChunk();
+  };
+  if (!f) { Serial.printf("%s: RAM load OPEN FAIL %s\n", tag, path); return false; }
+  if (!headerOk) { closeFile(); return false; }
 
   size_t dataBytes = (size_t)wi.dataBytes;
   size_t samples   = dataBytes / 2;
+  if (maxBytes && dataBytes > maxBytes) {
+    Serial.printf("%s: RAM load skipped (%u bytes > %u)\n", tag, (unsigned)dataBytes, (unsigned)maxBytes);
+    closeFile();
+    return false;
+  }
 
-  int16_t* buf = (int16_t*)ps_malloc(dataBytes);
-  if (!buf) { Serial.printf("%s: RAM alloc FAIL (%u bytes)\n", tag, (unsigned)dataBytes); f.close(); return false; }
+  int16_t* buf = nullptr;
+  if (capBytes && *outBuf && *capBytes >= dataBytes) {
+    buf = *outBuf;
+  } else {
+    if (capBytes) { free(*outBuf); *outBuf = nullptr; *capBytes = 0; }
+    buf = (int16_t*)ps_malloc(dataBytes);
+    if (!buf) { Serial.printf("%s: RAM alloc FAIL (%u bytes)\n", tag, (unsigned)dataBytes); closeFile(); return false; }
+    if (capBytes) { *outBuf = buf; *capBytes = dataBytes; }
+  }
 
-  f.seek(wi.dataStart);
   size_t off=0;
   while (off < dataBytes) {
-    size_t n = f.read(((uint8_t*)buf)+off, dataBytes - off);
+    const size_t want = bg ? min((size_t)SD_BG_CHUNK_BYTES, dataBytes - off) : dataBytes - off;
+    if (bg) SdBus_lockChunk();
+    f.seek(wi.dataStart + off);
+    size_t n = f.read(((uint8_t*)buf)+off, want);
+    if (bg) SdBus_unlockChunk();
     if (n == 0) {
       Serial.printf("%s: RAM read FAIL @%u\n", tag, (unsigned)off);
-      free(buf);
-      f.close();
+      if (!capBytes) free(buf);
+      closeFile();
       return false;
     }
     off += n;
     yield();
   }
-  f.close();
+  closeFile();
 
   *outBuf = buf;
   *outSamples = samples;
@@ -261,53 +291,44 @@ bool loadWavIntoRam(const char* path, const char* tag, int16_t** outBuf, size_t*
   return true;
 }
 
+bool loadWavIntoRam(const char* path, const char* tag, int16_t** outBuf, size_t* outSamples, size_t maxBytes,
+                    size_t* capBytes) {
+  return loadWav(path, tag, outBuf, outSamples, maxBytes, capBytes, false);
+}
+
+bool loadWavIntoRamBackground(const char* path, const char* tag, int16_t** outBuf, size_t* outSamples,
+                              size_t maxBytes, size_t* capBytes) {
+  return loadWav(path, tag, outBuf, outSamples, maxBytes, capBytes, true);
+}
+
+// Called from the audio path with the bus held. A read that fails twice marks
+// the channel faulted and hands it to the SdBus worker; recovery (reopen,
+// remount, backoff) never runs here.
 size_t sdReadReliable(Channel& C, uint8_t* dst, size_t want) {
-  if (C.useRAM || C.isTone) return 0; // not used here
-  uint8_t retries = 0; bool remounted = false;
+  if (C.useRAM || C.isTone || C.sd.fault) return 0;
+  uint8_t retries = 0;
   size_t total = 0;
   uint32_t dataBytes = C.sd.dataEnd - C.sd.dataStart;
   while (total < want) {
     if (C.sd.cur >= dataBytes) break; // EOF
     if (!C.sd.f) {
-      if (retries < 2) {
-        retries++;
-        if (C.path.length()) {
-          File f = SD.open(C.path.c_str(), FILE_READ);
-          if (f) {
-            // Re-parse to recover correct dataStart if the file has extra chunks.
-            WavInfo wi;
-            if (parseWavHeader(f, wi, "RECOVER")) {
-              C.sd.dataStart = wi.dataStart;
-              C.sd.dataEnd   = wi.dataStart + wi.dataBytes;
-              C.sd.f = f;
-              C.sd.f.seek(C.sd.dataStart + C.sd.cur);
-              continue;
-            }
-            f.close();
-          }
-        }
-      }
-      if (!remounted) {
-        remounted = true;
-        if (remountAndReopenAll()) {
-          if (C.sd.f) {
-            C.sd.f.seek(C.sd.dataStart + C.sd.cur);
-            continue;
-          }
-        }
-      }
+      C.sd.fault = true;
+      SdBus_requestRecovery();
       break;
     }
+    const uint32_t t0 = micros();
     C.sd.f.seek(C.sd.dataStart + C.sd.cur);
     uint32_t maxNow = dataBytes - C.sd.cur;
     size_t chunk = min((size_t)maxNow, want - total);
     size_t n = C.sd.f.read(dst + total, chunk);
     if (n == 0) {
-      delay(1);
-      if (++retries <= 2) continue;
-      if (!remounted) { remounted = true; if (remountAndReopenAll()) continue; }
+      if (++retries <= 1) continue;
+      SdBus_noteError();
+      C.sd.fault = true;
+      SdBus_requestRecovery();
       break;
     }
+    SdBus_noteRead(micros() - t0, retries != 0);
     C.sd.cur += n;
     total += n;
   }
@@ -317,7 +338,7 @@ size_t sdReadReliable(Channel& C, uint8_t* dst, size_t want) {
 // ───────────────── Tone synthesis ─────────────────
 
 // Generate a single sample for a tone channel, in [-1.0, +1.0].
-static float synthNextSample(Channel& C) {
+float synthNextSample(Channel& C) {
   const float sr = (float)SAMPLE_RATE;
   float s = 0.0f;
 
@@ -429,7 +450,9 @@ static float synthNextSample(Channel& C) {
 // If a looping clip ends mid-frame and we pad the remainder with zeros, you'll hear a "click"/"gap"
 // when the loop restarts. To avoid that, LOOPING channels wrap within the SAME frame so every frame
 // stays fully filled with audio.
-// We also apply a very short declick ramp at wrap boundaries.
+// Buffers without baked loop points (SD streams, short clips) also get a very
+// short declick ramp at wrap boundaries. The ramps step a Q16 gain, so there is
+// one division per ramp rather than one per sample.
 
 static constexpr size_t kLoopDeclickSamples = 96; // a hair longer than before (~2.2ms @ 44.1kHz)
 static uint16_t s_loopFadeIn[4] = {0,0,0,0};
@@ -437,10 +460,10 @@ static uint16_t s_loopFadeIn[4] = {0,0,0,0};
 static inline void rampIn(int16_t* buf, size_t n) {
   if (n == 0) return;
   if (n == 1) { buf[0] = 0; return; }
-  const int32_t denom = (int32_t)(n - 1);
-  for (size_t i=0;i<n;i++) {
-    int32_t num = (int32_t)i;
-    buf[i] = (int16_t)((int32_t)buf[i] * num / denom);
+  const int32_t step = 65536 / (int32_t)(n - 1);
+  int32_t g = 0;
+  for (size_t i=0;i<n;i++, g += step) {
+    buf[i] = (int16_t)(((int32_t)buf[i] * min(g, (int32_t)65536)) >> 16);
   }
 }
 
@@ -448,11 +471,11 @@ static inline void rampOutTail(int16_t* buf, size_t total, size_t n) {
   if (n == 0 || total == 0) return;
   if (n > total) n = total;
   if (n == 1) { buf[total-1] = 0; return; }
-  const int32_t denom = (int32_t)(n - 1);
-  for (size_t i=0;i<n;i++) {
-    int32_t num = (int32_t)(denom - (int32_t)i);
+  const int32_t step = 65536 / (int32_t)(n - 1);
+  int32_t g = 65536;
+  for (size_t i=0;i<n;i++, g -= step) {
     size_t idx = (total - n) + i;
-    buf[idx] = (int16_t)((int32_t)buf[idx] * num / denom);
+    buf[idx] = (int16_t)(((int32_t)buf[idx] * max(g, (int32_t)0)) >> 16);
   }
 }
 
@@ -464,14 +487,51 @@ static inline void declickBoundaryToZero(int16_t* buf, size_t wrapAt) {
   if (N == 0) return;
   if (N == 1) { buf[wrapAt-1] = 0; buf[wrapAt] = 0; return; }
 
-  const int32_t denom = (int32_t)(N - 1);
-  for (size_t i=0;i<N;i++) {
-    const int32_t head = (int32_t)i;
-    const int32_t tail = denom - head;
+  const int32_t step = 65536 / (int32_t)(N - 1);
+  int32_t head = 0;
+  for (size_t i=0;i<N;i++, head += step) {
+    const int32_t h = min(head, (int32_t)65536);
     size_t ti = wrapAt - N + i;
     size_t hi = wrapAt + i;
-    buf[ti] = (int16_t)((int32_t)buf[ti] * tail / denom);
-    buf[hi] = (int16_t)((int32_t)buf[hi] * head / denom);
+    buf[ti] = (int16_t)(((int32_t)buf[ti] * (65536 - h)) >> 16);
+    buf[hi] = (int16_t)(((int32_t)buf[hi] * h) >> 16);
+  }
+}
+
+// Buffers with baked loop points wrap loopEnd -> loopStart with plain copies:
+// no ramps, no per-sample math. The last xfade samples of each pass come from
+// the crossfade stored after the clip. One-shots play the clip as recorded, to
+// the end of the buffer. Tones keep looping until stopped (PLAYING included),
+// like real-time synthesis.
+static void fillRamSeamless(Channel& C, int16_t* dst) {
+  const bool wrap = ((C.state == LOOPING) || C.isTone) && C.ram.loopEnd > C.ram.loopStart;
+  const size_t end = wrap ? C.ram.loopEnd : C.ram.samples;
+  const size_t tailAt = (wrap && C.ram.xfade) ? end - C.ram.xfade : end;
+  size_t outPos = 0;
+  while (outPos < kFrameSamples) {
+    if (C.idx >= end) {
+      if (!wrap) {
+        C.state = IDLE;
+        C.idx = 0;
+        memset(dst + outPos, 0, (kFrameSamples - outPos) * 2);
+        return;
+      }
+      C.idx = C.ram.loopStart;
+    }
+    const int16_t* src = C.ram.data + C.idx;
+    size_t stop = tailAt;
+    if (C.idx >= tailAt) {
+      src  = C.ram.data + C.ram.samples + (C.idx - tailAt);
+      stop = end;
+    }
+    size_t run = min(stop - C.idx, kFrameSamples - outPos);
+    memcpy(dst + outPos, src, run * 2);
+    C.idx += run;
+    outPos += run;
+  }
+  if (!wrap && C.idx >= end) {
+    C.state = IDLE;
+    C.idx = 0;
   }
 }
 
@@ -484,20 +544,21 @@ void fillChannelFrame(int idx, int16_t* dst) {
     return;
   }
 
-  // Tone-backed channel
-  if (C.isTone && C.toneMode != TONE_NONE) {
+  // Tone-backed channel (real-time synthesis unless pre-rendered into ToneCache)
+  if (C.isTone && C.toneMode != TONE_NONE && !C.useRAM) {
     for (size_t n = 0; n < kFrameSamples; n++) {
-      float s = synthNextSample(C);
-      int32_t v = (int32_t)(s * 32767.0f);
-      if (v >  32767) v =  32767;
-      if (v < -32768) v = -32768;
-      dst[n] = (int16_t)v;
+      dst[n] = toneToPcm(synthNextSample(C));
     }
     return;
   }
 
   // RAM mode
   if (C.useRAM && C.ram.data) {
+    if (C.ram.seamless) {
+      fillRamSeamless(C, dst);
+      return;
+    }
+
     size_t outPos = 0;
     size_t wrapAt = (size_t)-1;
 
@@ -542,7 +603,13 @@ void fillChannelFrame(int idx, int16_t* dst) {
     return;
   }
 
-  // SD mode
+  // SD mode. Never waits on the card: while the SdBus worker holds the bus or
+  // this channel is faulted, play silence and keep the cursor.
+  if (C.sd.fault || !SdBus_tryLock()) {
+    memset(dst, 0, kBytesPerCh);
+    return;
+  }
+
   const uint32_t dataBytes = (C.sd.dataEnd > C.sd.dataStart) ? (C.sd.dataEnd - C.sd.dataStart) : 0;
   size_t filled = 0;
   size_t wrapAt = (size_t)-1;
@@ -551,6 +618,7 @@ void fillChannelFrame(int idx, int16_t* dst) {
   while (filled < kBytesPerCh) {
     size_t got = sdReadReliable(C, ((uint8_t*)dst) + filled, kBytesPerCh - filled);
 
+    if (got == 0 && C.sd.fault) break;   // pad with silence, resume at the cursor later
     if (got == 0) {
       if (C.state == LOOPING && dataBytes > 0 && safety++ < 4) {
         if (wrapAt == (size_t)-1) wrapAt = filled / 2;
@@ -580,6 +648,8 @@ void fillChannelFrame(int idx, int16_t* dst) {
     }
   }
 
+  SdBus_unlock();
+
   if (filled < kBytesPerCh) memset(((uint8_t*)dst) + filled, 0, kBytesPerCh - filled);
   if (wrapAt != (size_t)-1) declickBoundaryToZero(dst, wrapAt);
 
@@ -590,33 +660,6 @@ void fillChannelFrame(int idx, int16_t* dst) {
   }
 }
 
-// ───────────────── I2S init ─────────────────
-
-void i2s_init_common(i2s_port_t port, int dout, int bclk, int lrck) {
-  i2s_config_t cfg = {
-    .mode = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_TX),
-    .sample_rate = SAMPLE_RATE,
-    .bits_per_sample = I2S_BITS_PER_SAMPLE_16BIT,
-    .channel_format = I2S_CHANNEL_FMT_RIGHT_LEFT,
-    .communication_format = I2S_COMM_FORMAT_I2S,
-    .intr_alloc_flags = ESP_INTR_FLAG_LEVEL1,
-    .dma_buf_count = 8,
-    .dma_buf_len   = 1024,
-    .use_apll      = true,
-    .tx_desc_auto_clear = true
-  };
-  ESP_ERROR_CHECK(i2s_driver_install(port, &cfg, 0, nullptr));
-  i2s_pin_config_t pins = {
-    .bck_io_num   = bclk,
-    .ws_io_num    = lrck,
-    .data_out_num = dout,
-    .data_in_num  = I2S_PIN_NO_CHANGE
-  };
-  ESP_ERROR_CHECK(i2s_set_pin(port, &pins));
-  i2s_set_clk(port, SAMPLE_RATE, I2S_BITS_PER_SAMPLE_16BIT, I2S_CHANNEL_STEREO);
-  i2s_zero_dma_buffer(port);
-}
-
 // ───────────────── Volume helpers ─────────────────
 //
 // IMPORTANT:
@@ -659,6 +702,37 @@ void applyGain(int16_t* buf, size_t n, int32_t g) {
   }
 }
 
+// Same saturation as applyGain, but also tracks |peak| and the sum of squares
+// of the output samples. Squares are pre-shifted by 10 so a full 1024-sample
+// frame at full scale still fits in 32 bits.
+void applyGainMeter(int16_t* buf, size_t n, int32_t g, uint8_t slot) {
+  int32_t  peak  = 0;
+  uint32_t sumSq = 0;
+  if (g == 32768) {
+    for (size_t i=0; i<n; i++) {
+      int32_t v = buf[i];
+      int32_t a = (v < 0) ? -v : v;
+      if (a > peak) peak = a;
+      sumSq += (uint32_t)(v * v) >> 10;
+    }
+  } else {
+    for (size_t i=0; i<n; i++) {
+      int64_t t = (int64_t)buf[i] * (int64_t)g;
+      t >>= 15;
+      if (t >  32767) t =  32767;
+      if (t < -32768) t = -32768;
+      int32_t v = (int32_t)t;
+      buf[i] = (int16_t)v;
+      int32_t a = (v < 0) ? -v : v;
+      if (a > peak) peak = a;
+      sumSq += (uint32_t)(v * v) >> 10;
+    }
+  }
+  if (peak > 32767) peak = 32767;
+  uint16_t rms = n ? (uint16_t)sqrtf((float)sumSq * 1024.0f / (float)n) : 0;
+  Meter_publish(slot, (uint16_t)peak, rms);
+}
+
 // Default to 0 dB; set this from your .ino at startup:
 //   masterGainQ15 = q15_from_db(MASTER_GAIN_DB);
 int32_t masterGainQ15 = q15_from_db(0);
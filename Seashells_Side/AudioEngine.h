@@ -1,8 +1,8 @@
 #pragma once
 #include <Arduino.h>
 #include <SD.h>
-#include "driver/i2s.h"
 #include "ConfigSide.h"   // pins, SAMPLE_RATE, SD_* defines
+#include "Manifest.h"
 
 // ---- Playback state & channel types ----
 enum PlayState : uint8_t { IDLE=0, PLAYING=1, LOOPING=2 };
@@ -19,12 +19,25 @@ enum ToneMode : uint8_t {
   TONE_TRIPLE_BEEP = 7
 };
 
-struct TrackRAM { int16_t* data = nullptr; size_t samples = 0; };
-struct TrackSD  { File f; uint32_t dataStart = 44, dataEnd = 44, cur = 0; };
+struct TrackRAM {
+  const int16_t* data = nullptr;   // PSRAM cache, shared clip, tone period or mapped soundbank
+  size_t   samples = 0;
+  bool     seamless = false;   // [loopStart, loopEnd) loops click-free as-is (no declick ramps)
+  uint32_t loopStart = 0;      // valid when seamless
+  uint32_t loopEnd   = 0;
+  uint16_t xfade     = 0;      // seamless: the loop's last xfade samples come from data[samples..]
+};
+struct TrackSD  {
+  File f;
+  uint32_t dataStart = 44, dataEnd = 44, cur = 0;
+  uint32_t trimStart = 0, trimEnd = 0;   // samples into the data chunk (manifest); 0/0 = whole clip
+  volatile bool fault = false;           // read failed; SdBus worker is reopening (cur is kept)
+};
 
 struct Channel {
   // File-backed audio fields
-  String   path;
+  const ClipMeta* clip = nullptr;   // catalog entry (clip handle); nullptr = none
+  const char* path() const { return clip ? clip->path : ""; }
   PlayState state = IDLE;
   uint8_t   vol   = 255;
   size_t    idx   = 0;
@@ -32,6 +45,7 @@ struct Channel {
   TrackRAM  ram;
   TrackSD   sd;
   int32_t   gainQ15 = 32768;   // Q15 (1.0 == 32768)
+  uint16_t  sharedId = 0;      // != 0 while ram.data is a ClipSource reference
 
   // Tone synthesis fields (used when isTone = true)
   bool      isTone = false;
@@ -50,17 +64,35 @@ extern Channel ch[4];
 // ---- Prototypes (same names you already use) ----
 void     listRootOnce();
 bool     remountSD(uint32_t hz);
-bool     remountAndReopenAll(uint32_t hz1 = 12000000, uint32_t hz2 = 8000000);
 bool     openForSD(Channel& C, int idx);
-bool     loadWavIntoRam(const char* path, const char* tag, int16_t** outBuf, size_t* outSamples);
-size_t   sdReadReliable(Channel& C, uint8_t* dst, size_t want);
+bool     reopenAtCursor(Channel& C, int idx);   // SdBus worker: reopen keeping sd.cur
+// With capBytes, *outBuf / *capBytes are a block the caller keeps: it is
+// reused when big enough, replaced when not, and never freed on failure.
+bool     loadWavIntoRam(const char* path, const char* tag, int16_t** outBuf, size_t* outSamples,
+                        size_t maxBytes = 0, size_t* capBytes = nullptr);  // 0 = no limit
+// Same for a background task that doesn't hold the bus: it is taken per
+// SD_BG_CHUNK_BYTES read (SdBus_lockChunk), never for the whole clip
+bool     loadWavIntoRamBackground(const char* path, const char* tag, int16_t** outBuf, size_t* outSamples,
+                                  size_t maxBytes = 0, size_t* capBytes = nullptr);
+size_t   sdReadReliable(Channel& C, uint8_t* dst, size_t want);  // never blocks; short read = EOF or fault
 void     fillChannelFrame(int idx, int16_t* dst);  // uses internal frame constants
-void     i2s_init_common(i2s_port_t port, int dout, int bclk, int lrck);
+
+// Tone synthesis: next sample of a tone channel in [-1, +1], and the exact
+// float -> PCM conversion the engine uses (shared with ToneCache).
+float    synthNextSample(Channel& C);
+static inline int16_t toneToPcm(float s) {
+  int32_t v = (int32_t)(s * 32767.0f);
+  if (v >  32767) v =  32767;
+  if (v < -32768) v = -32768;
+  return (int16_t)v;
+}
 
 // Volume helpers & master gain (moved out of .ino)
 int32_t  q15_from_db(int8_t db);
 int32_t  q15_mul(int32_t a, int32_t b);
 void     applyGain(int16_t* buf, size_t n, int32_t g);
+// applyGain plus peak/RMS metering in the same pass; publishes to g_slotMeter[slot]
+void     applyGainMeter(int16_t* buf, size_t n, int32_t g, uint8_t slot);
 
 // Exposed so you can set it once from the .ino, e.g.:
 //   masterGainQ15 = q15_from_db(MASTER_GAIN_DB);
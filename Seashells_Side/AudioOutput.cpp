@@ -0,0 +1,358 @@
+#include "AudioOutput.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(ARDUINO)
+#include <atomic>
+#include "ConfigSide.h"
+#include "driver/i2s_std.h"
+#include "SdBus.h"
+#define AOUT_LOG(...) Serial.printf(__VA_ARGS__)
+static inline uint32_t clockUs() { return micros(); }
+static inline uint32_t clockMs() { return millis(); }
+static inline void     sleepMs(uint32_t ms) { delay(ms); }
+#else
+// Host build: the same clock over std::chrono, logs on stdout
+#include <chrono>
+#include <thread>
+#ifndef SAMPLE_RATE
+#define SAMPLE_RATE 44100   // ConfigSide.h
+#endif
+#define AOUT_LOG(...) printf(__VA_ARGS__)
+
+static uint32_t clockUs() {
+  using namespace std::chrono;
+  static const steady_clock::time_point t0 = steady_clock::now();
+  return (uint32_t)duration_cast<microseconds>(steady_clock::now() - t0).count();
+}
+static uint32_t clockMs() { return clockUs() / 1000; }
+static void     sleepMs(uint32_t ms) { std::this_thread::sleep_for(std::chrono::milliseconds(ms)); }
+#endif
+
+// ───────────────── Pacing for file/null sinks ─────────────────
+//
+// Realtime sinks owe frames at SAMPLE_RATE since begin(); otherwise they take
+// anything, so a host run renders as fast as the CPU allows.
+
+class PacedSink : public AudioOutput {
+public:
+  explicit PacedSink(bool realtime) : m_realtime(realtime) {}
+
+  bool begin(uint32_t sampleRate) override {
+    m_rate = sampleRate;
+    m_t0Us = clockUs();
+    m_frames = 0;
+    return true;
+  }
+
+  size_t writable() override {
+    if (!m_realtime) return kUnpaced;
+    uint64_t due = (uint64_t)(uint32_t)(clockUs() - m_t0Us) * m_rate / 1000000ULL;
+    return due > m_frames ? (size_t)(due - m_frames) : 0;
+  }
+
+  bool waitWritable(size_t frames, uint32_t timeoutMs) override {
+    uint32_t t0 = clockMs();
+    while (writable() < frames) {
+      if (clockMs() - t0 >= timeoutMs) return false;
+      sleepMs(1);
+    }
+    return true;
+  }
+
+protected:
+  static constexpr size_t kUnpaced = 1u << 20;
+  bool     m_realtime;
+  uint32_t m_rate = SAMPLE_RATE;
+  uint32_t m_t0Us = 0;
+  uint64_t m_frames = 0;   // frames accepted since begin()
+};
+
+// ───────────────── Null sink ─────────────────
+
+class NullOutput : public PacedSink {
+public:
+  using PacedSink::PacedSink;
+  void write(const int16_t*, const int16_t*, size_t frames) override { m_frames += frames; }
+  const char* name() const override { return m_realtime ? "null (realtime)" : "null"; }
+};
+
+// ───────────────── WAV file sink ─────────────────
+//
+// Four channels in port order (L0 R0 L1 R1). Plain stdio so the same code
+// writes to the SD card through the VFS ("/sd/...") and to a host file. The
+// RIFF sizes are patched in end(); a capture cut short still holds its audio.
+//
+// On the device the card is shared with streaming slots, the precache and the
+// SdBus worker, so every file operation runs under the SD bus. Frames are
+// staged in RAM and flushed whenever the bus is free (SdBus_tryLock, like an
+// SD slot); only a full stage waits for it.
+
+#if defined(ARDUINO)
+static bool busLock(bool wait) {
+  if (wait) { SdBus_lock(); return true; }
+  return SdBus_tryLock();
+}
+static void busUnlock() { SdBus_unlock(); }
+#else
+static bool busLock(bool) { return true; }
+static void busUnlock() {}
+#endif
+
+class WavOutput : public PacedSink {
+public:
+  using PacedSink::PacedSink;
+
+  void setPath(const char* path) {
+    snprintf(m_path, sizeof(m_path), "%s", path);
+  }
+
+  bool begin(uint32_t sampleRate) override {
+    PacedSink::begin(sampleRate);
+    if (!m_stage) m_stage = (int16_t*)malloc(kStageFrames * kFrameBytes);
+    if (!m_stage) {
+      AOUT_LOG("[AOUT] no memory for the capture stage\n");
+      return false;
+    }
+    m_staged = 0;
+    busLock(true);
+    m_file = fopen(m_path, "wb");
+    if (m_file) writeHeader(0);
+    busUnlock();
+    if (!m_file) {
+      AOUT_LOG("[AOUT] cannot create %s\n", m_path);
+      return false;
+    }
+    AOUT_LOG("[AOUT] recording to %s\n", m_path);
+    return true;
+  }
+
+  void end() override {
+    if (!m_file) return;
+    flush(true);
+    closeFile();
+  }
+
+  void write(const int16_t* lr0, const int16_t* lr1, size_t frames) override {
+    m_frames += frames;
+    if (!m_file) return;
+    for (size_t n = 0; n < frames; n++) {
+      if (m_staged == kStageFrames && !flush(true)) return;
+      int16_t* q = m_stage + m_staged++ * 4;
+      q[0] = lr0[n * 2];
+      q[1] = lr0[n * 2 + 1];
+      q[2] = lr1[n * 2];
+      q[3] = lr1[n * 2 + 1];
+    }
+    flush(false);
+  }
+
+  const char* name() const override { return "wav"; }
+
+private:
+  static constexpr size_t   kStageFrames = 8192;   // ~186 ms @ 44.1 kHz, 64 KB
+  static constexpr uint32_t kFrameBytes = 4 * sizeof(int16_t);
+
+  static void put16(uint8_t* p, uint16_t v) { p[0] = v; p[1] = v >> 8; }
+  static void put32(uint8_t* p, uint32_t v) { put16(p, (uint16_t)v); put16(p + 2, (uint16_t)(v >> 16)); }
+
+  // Staged frames to the file. wait = false gives up while the bus is busy
+  // (they stay staged); false only when the write failed and the capture ended.
+  bool flush(bool wait) {
+    if (!m_staged) return true;
+    if (!busLock(wait)) return true;
+    const size_t n = fwrite(m_stage, kFrameBytes, m_staged, m_file);
+    busUnlock();
+    if (n != m_staged) {
+      AOUT_LOG("[AOUT] write to %s failed, capture stopped\n", m_path);
+      m_frames -= m_staged - n;   // the header counts what reached the file
+      m_staged = 0;
+      closeFile();
+      return false;
+    }
+    m_staged = 0;
+    return true;
+  }
+
+  void closeFile() {
+    busLock(true);
+    writeHeader((uint32_t)(m_frames * kFrameBytes));
+    fclose(m_file);
+    busUnlock();
+    m_file = nullptr;
+    AOUT_LOG("[AOUT] %s: %.2f s\n", m_path, (double)m_frames / m_rate);
+  }
+
+  // Caller holds the bus
+  void writeHeader(uint32_t dataBytes) {
+    uint8_t h[44];
+    memcpy(h, "RIFF", 4);      put32(h + 4, 36 + dataBytes);
+    memcpy(h + 8, "WAVEfmt ", 8);
+    put32(h + 16, 16);         put16(h + 20, 1);              // PCM
+    put16(h + 22, 4);          put32(h + 24, m_rate);
+    put32(h + 28, m_rate * kFrameBytes);
+    put16(h + 32, kFrameBytes); put16(h + 34, 16);
+    memcpy(h + 36, "data", 4); put32(h + 40, dataBytes);
+    fseek(m_file, 0, SEEK_SET);
+    fwrite(h, 1, sizeof(h), m_file);
+    fseek(m_file, 0, SEEK_END);
+  }
+
+  char     m_path[64] = "render.wav";
+  FILE*    m_file = nullptr;
+  int16_t* m_stage = nullptr;   // kStageFrames x 4 channels, kept across captures
+  size_t   m_staged = 0;
+};
+
+// ───────────────── I2S (i2s_std, DMA-event driven) ─────────────────
+//
+// Each port's TX channel reports every DMA buffer it finishes with on_sent.
+// The ISR credits that buffer's frames to the port and wakes the render task;
+// writable() is the smaller credit of the two ports, so a frame is only
+// rendered once both can take it and i2s_channel_write() never waits.
+// tx auto_clear plays silence if the render loop falls behind; the ISR counts
+// it as an underrun when a port's credit exceeds the whole DMA ring.
+
+#if defined(ARDUINO)
+
+class I2sStdOutput : public AudioOutput {
+public:
+  I2sStdOutput() { m_port[0].owner = m_port[1].owner = this; }
+
+  bool begin(uint32_t sampleRate) override {
+    m_task = xTaskGetCurrentTaskHandle();
+    const int pins[2][3] = { { I2S0_BCLK, I2S0_LRCK, I2S0_DOUT },
+                             { I2S1_BCLK, I2S1_LRCK, I2S1_DOUT } };
+    for (int p = 0; p < 2; p++) {
+      Port& P = m_port[p];
+      P.credit = 0;
+      i2s_chan_config_t cc = I2S_CHANNEL_DEFAULT_CONFIG(p == 0 ? I2S_NUM_0 : I2S_NUM_1, I2S_ROLE_MASTER);
+      cc.dma_desc_num  = I2S_DMA_DESC;
+      cc.dma_frame_num = I2S_DMA_FRAMES;
+      cc.auto_clear    = true;
+      if (i2s_new_channel(&cc, &P.tx, nullptr) != ESP_OK) {
+        Serial.printf("[AOUT] i2s port %d: new_channel FAIL\n", p);
+        return false;
+      }
+      i2s_std_config_t sc = {
+        .clk_cfg  = I2S_STD_CLK_DEFAULT_CONFIG(sampleRate),
+        .slot_cfg = I2S_STD_PHILIPS_SLOT_DEFAULT_CONFIG(I2S_DATA_BIT_WIDTH_16BIT, I2S_SLOT_MODE_STEREO),
+        .gpio_cfg = {
+          .mclk = I2S_GPIO_UNUSED,
+          .bclk = (gpio_num_t)pins[p][0],
+          .ws   = (gpio_num_t)pins[p][1],
+          .dout = (gpio_num_t)pins[p][2],
+          .din  = I2S_GPIO_UNUSED,
+          .invert_flags = { false, false, false },
+        },
+      };
+      ESP_ERROR_CHECK(i2s_channel_init_std_mode(P.tx, &sc));
+      i2s_event_callbacks_t cbs = {};
+      cbs.on_sent = onSent;
+      ESP_ERROR_CHECK(i2s_channel_register_event_callback(P.tx, &cbs, &P));
+    }
+    // Back to back so the two ports start within a few microseconds
+    ESP_ERROR_CHECK(i2s_channel_enable(m_port[0].tx));
+    ESP_ERROR_CHECK(i2s_channel_enable(m_port[1].tx));
+    Serial.printf("[AOUT] i2s_std %u Hz, %u x %u frames DMA per port\n",
+                  (unsigned)sampleRate, (unsigned)I2S_DMA_DESC, (unsigned)I2S_DMA_FRAMES);
+    return true;
+  }
+
+  void end() override {
+    for (Port& P : m_port) {
+      if (!P.tx) continue;
+      i2s_channel_disable(P.tx);
+      i2s_del_channel(P.tx);
+      P.tx = nullptr;
+    }
+  }
+
+  // Idle gating: no DMA traffic, BCLK/LRCK stop, amps see a quiet line.
+  // Nothing was playing, so whatever the ring still holds is silence.
+  void suspend() override {
+    for (Port& P : m_port) if (P.tx) i2s_channel_disable(P.tx);
+  }
+
+  void resume() override {
+    for (Port& P : m_port) P.credit = 0;   // on_sent re-credits as buffers go out
+    if (m_port[0].tx) i2s_channel_enable(m_port[0].tx);
+    if (m_port[1].tx) i2s_channel_enable(m_port[1].tx);
+  }
+
+  size_t writable() override {
+    return min(m_port[0].credit.load(), m_port[1].credit.load());
+  }
+
+  bool waitWritable(size_t frames, uint32_t timeoutMs) override {
+    uint32_t t0 = millis();
+    while (writable() < frames) {
+      uint32_t waited = millis() - t0;
+      if (waited >= timeoutMs) return false;
+      ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(timeoutMs - waited));
+    }
+    return true;
+  }
+
+  void write(const int16_t* lr0, const int16_t* lr1, size_t frames) override {
+    const int16_t* src[2] = { lr0, lr1 };
+    for (int p = 0; p < 2; p++) {
+      size_t w = 0;
+      i2s_channel_write(m_port[p].tx, src[p], frames * 4, &w, 0);
+      m_port[p].credit.fetch_sub((uint32_t)(w / 4));
+    }
+  }
+
+  const char* name() const override { return "i2s"; }
+  uint32_t underruns() const override { return m_port[0].underruns + m_port[1].underruns; }
+
+private:
+  struct Port {
+    i2s_chan_handle_t     tx = nullptr;
+    std::atomic<uint32_t> credit{0};   // frames free in the DMA ring
+    volatile uint32_t     underruns = 0;
+    I2sStdOutput*         owner = nullptr;
+  };
+
+  static bool IRAM_ATTR onSent(i2s_chan_handle_t, i2s_event_data_t* ev, void* ctx) {
+    Port& P = *(Port*)ctx;
+    const uint32_t ring = (uint32_t)I2S_DMA_DESC * I2S_DMA_FRAMES;
+    const uint32_t n = (uint32_t)(ev->size / 4);
+    if (P.credit.fetch_add(n) + n > ring) {
+      P.credit.store(ring);
+      P.underruns = P.underruns + 1;
+    }
+    BaseType_t woken = pdFALSE;
+    if (P.owner->m_task) vTaskNotifyGiveFromISR(P.owner->m_task, &woken);
+    return woken == pdTRUE;
+  }
+
+  Port         m_port[2];
+  TaskHandle_t m_task = nullptr;
+};
+
+#endif
+
+// ───────────────── Factories ─────────────────
+
+AudioOutput* AudioOutput_null(bool realtime) {
+  static NullOutput s_rt(true), s_fast(false);
+  return realtime ? (AudioOutput*)&s_rt : (AudioOutput*)&s_fast;
+}
+
+AudioOutput* AudioOutput_wav(const char* path, bool realtime) {
+  static WavOutput s_rt(true), s_fast(false);
+  WavOutput* w = realtime ? &s_rt : &s_fast;
+  w->setPath(path);
+  return w;
+}
+
+AudioOutput* AudioOutput_i2s() {
+#if defined(ARDUINO)
+  static I2sStdOutput s_i2s;
+  return &s_i2s;
+#else
+  return AudioOutput_null(true);   // host: keep real-time pacing, no hardware
+#endif
+}
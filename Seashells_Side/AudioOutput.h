@@ -0,0 +1,52 @@
+#pragma once
+#if defined(ARDUINO)
+#include <Arduino.h>
+#else
+#include <stddef.h>
+#include <stdint.h>
+#endif
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Where rendered audio goes. The engine renders the Side's two stereo ports
+// (speakers 1/2 on port 0, 3/4 on port 1) one frame at a time and hands both
+// to the backend together, so neither port can run ahead of the other.
+//
+// The render loop is paced by the backend: it asks for room with
+// waitWritable() and only renders when a whole frame fits, instead of parking
+// inside a blocking write.
+//
+//   AudioOutput_i2s()  – i2s_std driver, DMA completion (on_sent) interrupts
+//                        report free space; writes never block
+//   AudioOutput_wav()  – 4-channel 16-bit WAV file (L0 R0 L1 R1), for captures
+//                        on the SD card or deterministic host renders
+//   AudioOutput_null() – discards audio (host runs, render benchmarks)
+//
+// File/null sinks either pace themselves at SAMPLE_RATE (realtime) or accept
+// everything immediately so a host run renders as fast as it can. They build
+// off the device too (no ARDUINO: plain g++, std::chrono clock, stdout logs),
+// where AudioOutput_i2s() falls back to the realtime null sink.
+// ─────────────────────────────────────────────────────────────────────────────
+
+class AudioOutput {
+public:
+  virtual ~AudioOutput() {}
+  virtual bool begin(uint32_t sampleRate) = 0;
+  virtual void end() {}
+  // Frames per port that write() accepts right now without blocking.
+  virtual size_t writable() = 0;
+  // Wait until at least `frames` are writable; false on timeout.
+  virtual bool waitWritable(size_t frames, uint32_t timeoutMs) = 0;
+  // Interleaved L/R for each port, `frames` each. Call only when writable.
+  virtual void write(const int16_t* lr0, const int16_t* lr1, size_t frames) = 0;
+  virtual const char* name() const = 0;
+  // Stop the hardware while nothing plays (IdleGovernor) and bring it back;
+  // resume() returns with writable() counting up again from empty.
+  virtual void suspend() {}
+  virtual void resume() {}
+  // Times the hardware ran dry and played silence (I2S only).
+  virtual uint32_t underruns() const { return 0; }
+};
+
+AudioOutput* AudioOutput_i2s();
+AudioOutput* AudioOutput_wav(const char* path, bool realtime);
+AudioOutput* AudioOutput_null(bool realtime);
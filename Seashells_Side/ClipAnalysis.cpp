@@ -0,0 +1,95 @@
+#include "ClipAnalysis.h"
+#include <math.h>
+
+#include "ConfigSide.h"
+
+static constexpr float kHalfPi = 1.57079632679f;
+
+// Slope over a few samples, robust against single-sample noise
+static inline int32_t slopeAt(const int16_t* b, size_t i) {
+  return (int32_t)b[i + 2] - (int32_t)b[i - 2];
+}
+
+static inline bool risingZero(const int16_t* b, size_t i) {
+  return b[i - 1] < 0 && b[i] >= 0;
+}
+
+bool ClipAnalysis_bakeLoop(const int16_t* buf, size_t samples, int16_t* tail,
+                           uint32_t* loopStart, uint32_t* loopEnd, uint16_t* xfade) {
+  size_t K = LOOP_XFADE_SAMPLES;
+  if (K > samples / 4) K = samples / 4;
+  if (!buf || !tail || K < 32) return false;
+
+  const size_t search = min((size_t)LOOP_SEARCH_SAMPLES, samples / 4);
+
+  // loopStart: first rising zero crossing after the crossfade lead-in
+  size_t ls = K;
+  for (size_t i = K; i < K + search && i + 2 < samples; i++) {
+    if (risingZero(buf, i)) { ls = i; break; }
+  }
+
+  // loopEnd: rising crossing near the end whose slope best matches loopStart
+  const int32_t refSlope = slopeAt(buf, ls);
+  size_t  le = samples;
+  int32_t best = INT32_MAX;
+  const size_t lo = samples - search;
+  for (size_t i = samples - 3; i > lo; i--) {
+    if (!risingZero(buf, i)) continue;
+    if (i < ls + 2 * K) break;
+    int32_t cost = abs(slopeAt(buf, i) - refSlope) + abs((int32_t)buf[i] - (int32_t)buf[ls]);
+    if (cost < best) { best = cost; le = i; }
+  }
+  if (le < ls + 2 * K) return false;
+
+  // Equal-power crossfade: tail fades out (cos), pre-loopStart audio fades in (sin)
+  for (size_t j = 0; j < K; j++) {
+    const float t  = ((float)j + 0.5f) / (float)K;
+    const float gO = cosf(t * kHalfPi);
+    const float gI = sinf(t * kHalfPi);
+    float v = (float)buf[le - K + j] * gO + (float)buf[ls - K + j] * gI;
+    if (v >  32767.0f) v =  32767.0f;
+    if (v < -32768.0f) v = -32768.0f;
+    tail[j] = (int16_t)lrintf(v);
+  }
+
+  *loopStart = (uint32_t)ls;
+  *loopEnd   = (uint32_t)le;
+  *xfade     = (uint16_t)K;
+  return true;
+}
+
+// ───────────────── Onset / tail trimming ─────────────────
+
+static void findTrim(const int16_t* buf, size_t samples, uint32_t* start, uint32_t* end) {
+  const int32_t thr = (int32_t)(32767.0f * powf(10.0f, TRIM_THRESHOLD_DB / 20.0f));
+  const size_t  pad = (size_t)SAMPLE_RATE * TRIM_PAD_MS / 1000;
+
+  size_t on = 0;
+  while (on < samples && abs((int32_t)buf[on]) <= thr) on++;
+  if (on == samples) { *start = 0; *end = samples; return; }   // all quiet: leave alone
+
+  size_t off = samples;
+  while (off > on && abs((int32_t)buf[off - 1]) <= thr) off--;
+
+  *start = (uint32_t)(on > pad ? on - pad : 0);
+  *end   = (uint32_t)min(off + pad, samples);
+}
+
+bool ClipAnalysis_trim(int16_t** buf, size_t* samples, uint32_t* trimStart, uint32_t* trimEnd,
+                       bool shrink) {
+  const size_t n = *samples;
+  uint32_t s = *trimStart, e = *trimEnd;
+  if (s == 0 && e == 0) findTrim(*buf, n, &s, &e);
+  if (e == 0 || e > n) e = n;
+  if (s >= e) s = 0;
+
+  *trimStart = s; *trimEnd = e;
+  if (s == 0 && e == n) return false;
+
+  const size_t keep = e - s;
+  if (s) memmove(*buf, *buf + s, keep * 2);
+  int16_t* shrunk = shrink ? (int16_t*)ps_realloc(*buf, keep * 2) : nullptr;
+  if (shrunk) *buf = shrunk;   // otherwise the old (larger) block still holds the audio
+  *samples = keep;
+  return true;
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include <Arduino.h>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// One-time analysis of cached PCM (runs at cache-load time, never per frame).
+// ─────────────────────────────────────────────────────────────────────────────
+
+// Pick loop points on rising zero crossings whose local slope matches, then
+// render an equal-power crossfade over the *xfade samples before loopEnd into
+// tail (room for LOOP_XFADE_SAMPLES; callers put it right after the clip):
+// it blends from the clip's own tail into the audio that precedes loopStart.
+// Loop playback reads tail in place of [loopEnd - xfade, loopEnd) and jumps
+// back seamlessly, with no ramp to zero. The clip itself is not written, so
+// one-shot playback of [0, samples) is exactly the recorded audio.
+//
+// Returns false (tail untouched) if the clip is too short to loop this way.
+bool ClipAnalysis_bakeLoop(const int16_t* buf, size_t samples, int16_t* tail,
+                           uint32_t* loopStart, uint32_t* loopEnd, uint16_t* xfade);
+
+// Trim leading/trailing silence (below TRIM_THRESHOLD_DB, keeping TRIM_PAD_MS
+// either side) from a freshly loaded PSRAM clip: the audio is moved to the
+// front and (with shrink) the buffer shrunk in place. *trimStart / *trimEnd are sample
+// offsets into the original data; when the manifest already supplies them
+// (non-zero on entry) they are used as-is, otherwise they are detected.
+// Returns true if the buffer changed; on false both offsets describe the
+// whole clip (0 .. samples).
+bool ClipAnalysis_trim(int16_t** buf, size_t* samples, uint32_t* trimStart, uint32_t* trimEnd,
+                       bool shrink = true);
@@ -0,0 +1,161 @@
+#include "ClipSource.h"
+#include "AudioEngine.h"
+#include "ClipAnalysis.h"
+#include "Manifest.h"
+
+enum SharedState : uint8_t { SH_FREE = 0, SH_LOADING, SH_READY, SH_FAILED };
+
+struct SharedClip {
+  uint16_t id      = 0;
+  uint8_t  refs    = 0;
+  volatile uint8_t state = SH_FREE;
+  bool     queued  = false;     // waiting for the fill task
+  char     path[ASSET_PATH_MAX] = "";   // copied: a reload may swap the catalog mid-fill
+  int16_t* data    = nullptr;   // kept after release and reused (cap bytes)
+  size_t   cap     = 0;
+  size_t   samples = 0;
+  uint32_t trimStart = 0;       // manifest trim in, applied trim out
+  uint32_t trimEnd   = 0;
+  uint32_t loopStart = 0;
+  uint32_t loopEnd   = 0;
+  uint16_t xfade     = 0;
+};
+
+// A 4-slot scene can hold at most 2 distinct duplicated IDs, but old and new
+// scenes overlap briefly while side_setScene swaps them.
+static SharedClip s_shared[4];
+static portMUX_TYPE s_mux = portMUX_INITIALIZER_UNLOCKED;
+static bool s_filling = false;   // fill task running
+
+// Runs on the fill task, which owns s.data while the state is SH_LOADING
+static bool fillOne(SharedClip& s) {
+  char tag[12];
+  snprintf(tag, sizeof(tag), "SH%u", (unsigned)s.id);
+  size_t n = 0;
+  if (!loadWavIntoRamBackground(s.path, tag, &s.data, &n, SHARED_CLIP_MAX_BYTES, &s.cap)) return false;
+
+  uint32_t ts = TRIM_ENABLE ? s.trimStart : 0, te = TRIM_ENABLE ? s.trimEnd : 0;
+  if (TRIM_ENABLE) ClipAnalysis_trim(&s.data, &n, &ts, &te, /*shrink=*/false);
+  else             ts = 0;
+
+  // The loop crossfade goes after the clip; grow the block if it has no room
+  const size_t need = (n + LOOP_XFADE_SAMPLES) * 2;
+  if (s.cap < need) {
+    if (int16_t* p = (int16_t*)ps_realloc(s.data, need)) { s.data = p; s.cap = need; }
+  }
+  uint32_t ls = 0, le = 0;
+  uint16_t xf = 0;
+  if (s.cap >= need) ClipAnalysis_bakeLoop(s.data, n, s.data + n, &ls, &le, &xf);
+
+  s.samples = n;
+  s.trimStart = ts;
+  s.loopStart = ls; s.loopEnd = le; s.xfade = xf;
+  return true;
+}
+
+// Reads queued clips chunk by chunk (the bus is taken per SD_BG_CHUNK_BYTES),
+// so a scene change never holds the card for a whole shared clip
+static void fillTask(void*) {
+  for (;;) {
+    SharedClip* s = nullptr;
+    portENTER_CRITICAL(&s_mux);
+    for (SharedClip& c : s_shared) if (c.queued) { c.queued = false; s = &c; break; }
+    if (!s) s_filling = false;
+    portEXIT_CRITICAL(&s_mux);
+    if (!s) break;
+
+    const uint32_t t0 = millis();
+    const uint16_t id = s->id;
+    const bool ok = fillOne(*s);
+    portENTER_CRITICAL(&s_mux);
+    if (!s->refs)  { s->state = SH_FREE; s->id = 0; }   // released while loading
+    else           s->state = ok ? SH_READY : SH_FAILED;
+    portEXIT_CRITICAL(&s_mux);
+    if (ok) Serial.printf("[SHARED] id=%u ready in %lu ms\n", (unsigned)id, (unsigned long)(millis() - t0));
+  }
+  vTaskDelete(nullptr);
+}
+
+bool ClipSource_acquire(uint16_t id, const char* path, uint32_t trimStart, uint32_t trimEnd) {
+  // A clip released while still filling is picked up again as it is
+  for (SharedClip& s : s_shared) {
+    if ((s.refs || s.state == SH_LOADING) && s.id == id) {
+      portENTER_CRITICAL(&s_mux);
+      s.refs++;
+      portEXIT_CRITICAL(&s_mux);
+      return true;
+    }
+  }
+
+  // The free slot with the biggest block, so blocks stop growing once they
+  // have seen the largest shared clips. A slot still filling for a released
+  // clip is not free yet.
+  SharedClip* slot = nullptr;
+  for (SharedClip& s : s_shared) {
+    if (!s.refs && s.state != SH_LOADING && (!slot || s.cap > slot->cap)) slot = &s;
+  }
+  if (!slot) return false;
+
+  slot->id = id; slot->refs = 1; slot->samples = 0;
+  snprintf(slot->path, sizeof(slot->path), "%s", path);
+  slot->trimStart = trimStart; slot->trimEnd = trimEnd;
+  slot->loopStart = slot->loopEnd = 0; slot->xfade = 0;
+
+  portENTER_CRITICAL(&s_mux);
+  slot->state  = SH_LOADING;
+  slot->queued = true;
+  const bool start = !s_filling;
+  s_filling = true;
+  portEXIT_CRITICAL(&s_mux);
+
+  if (start && xTaskCreatePinnedToCore(fillTask, "shared", PRECACHE_TASK_STACK, nullptr, 1, nullptr,
+                                       PRECACHE_TASK_CORE) != pdPASS) {
+    portENTER_CRITICAL(&s_mux);
+    for (SharedClip& s : s_shared) if (s.queued) { s.queued = false; s.state = SH_FAILED; }
+    s_filling = false;
+    portEXIT_CRITICAL(&s_mux);
+    Serial.println("[SHARED] fill task failed to start; slots keep streaming");
+  }
+  return true;
+}
+
+bool ClipSource_ready(uint16_t id, const int16_t** data, size_t* samples, uint32_t* loopStart,
+                      uint32_t* loopEnd, uint16_t* xfade, uint32_t* trimStart) {
+  for (SharedClip& s : s_shared) {
+    if (s.refs && s.id == id && s.state == SH_READY) {
+      *data = s.data; *samples = s.samples;
+      *loopStart = s.loopStart; *loopEnd = s.loopEnd; *xfade = s.xfade;
+      *trimStart = s.trimStart;
+      return true;
+    }
+  }
+  return false;
+}
+
+bool ClipSource_addRef(uint16_t id, const int16_t** data, size_t* samples) {
+  for (SharedClip& s : s_shared) {
+    if (s.refs && s.id == id && s.state == SH_READY) {
+      s.refs++;
+      *data = s.data; *samples = s.samples;
+      return true;
+    }
+  }
+  return false;
+}
+
+void ClipSource_release(uint16_t id) {
+  if (!id) return;
+  for (SharedClip& s : s_shared) {
+    if (s.refs && s.id == id) {
+      portENTER_CRITICAL(&s_mux);
+      if (--s.refs == 0 && s.state != SH_LOADING) {   // the fill task frees a loading one
+        s.state = SH_FREE; s.id = 0;
+        s.samples = 0;
+        s.loopStart = s.loopEnd = 0;
+        s.xfade = 0;
+      }
+      portEXIT_CRITICAL(&s_mux);
+      return;
+    }
+  }
+}
@@ -0,0 +1,34 @@
+#pragma once
+#include <Arduino.h>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Refcounted PSRAM sources for clips that appear in more than one slot of a
+// scene (the master reuses IDs when a bucket has fewer than 7 clips).
+//
+// The first acquire queues the WAV for a background fill task that reads it
+// once, SD_BG_CHUNK_BYTES per bus lock; later acquires of the same ID just
+// bump the refcount. Slots stream from SD until ClipSource_ready, then move to
+// the shared copy. Every channel keeps its own read cursor (Channel::idx) over
+// the shared samples, so SD traffic scales with unique clips, not slots.
+// Clips larger than SHARED_CLIP_MAX_BYTES (or that fail to load) never become
+// ready and keep streaming per channel.
+// A slot keeps its PSRAM block after release and reuses it (growing only when
+// a bigger clip arrives), so scene changes stop allocating once warmed up.
+// Loop points are baked on load (ClipAnalysis); loopEnd == 0 when there are none,
+// and the loop crossfade (xfade samples) sits right after the clip.
+// ─────────────────────────────────────────────────────────────────────────────
+
+// Takes a reference (release it later); false when no slot is free. Never
+// reads SD. trimStart/trimEnd are the manifest's, as the SD stream uses them.
+bool ClipSource_acquire(uint16_t id, const char* path, uint32_t trimStart, uint32_t trimEnd);
+void ClipSource_release(uint16_t id);
+
+// The filled copy of a clip this caller holds a reference to; false while it
+// is still loading. *trimStart is the trim actually applied (samples cut from
+// the front of the file), to carry an SD stream's cursor over.
+bool ClipSource_ready(uint16_t id, const int16_t** data, size_t* samples, uint32_t* loopStart,
+                      uint32_t* loopEnd, uint16_t* xfade, uint32_t* trimStart);
+
+// Another reference to a clip that is already loaded (a slot of the current
+// scene holds it); false without reading SD when it isn't. For one-shots.
+bool ClipSource_addRef(uint16_t id, const int16_t** data, size_t* samples);
@@ -3,6 +3,10 @@
 
 #include "Role.h"
 
+// Per-slot [SCENE] prints on every SET_SCENE. Turn off when timing with the
+// event trace (Trace.h); the printf load skews the audio loop.
+#define SCENE_LOG_VERBOSE 1
+
 // ------- ESP-NOW / WiFi -------
 #define WIFI_CHANNEL 6
 
@@ -14,18 +18,99 @@
 #define OTA_CONNECT_TIMEOUT_MS 15000
 #define OTA_HTTP_TIMEOUT_MS    45000
 
+// OTA copy pipeline: the loop task receives into one buffer while a writer
+// task commits the previous ones to flash. One buffer = one flash sector.
+#define OTA_PIPE_BUFS       3
+#define OTA_PIPE_BUF_BYTES  4096
+
+// Resumable OTA: flash is erased this far ahead of the writes, raw images
+// checkpoint their offset to NVS every OTA_CKPT_BYTES, and a dropped link is
+// retried with a Range request after OTA_BACKOFF_MS, doubling up to the max.
+#define OTA_ERASE_BYTES     65536   // 64 KB block erase is much faster per byte than sectors
+#define OTA_CKPT_BYTES      65536
+#define OTA_STALL_MS        15000   // no data this long = dropped
+#define OTA_BACKOFF_MS      1000
+#define OTA_BACKOFF_MAX_MS  16000
+#define OTA_RETRY_MAX       8       // consecutive attempts without progress
+
+// Firmware relayed by the Master over ESP-NOW (FwRelay). Chunks wait in a
+// queue between the ESP-NOW callback and the loop's flash writes; overflow is
+// simply re-requested. FW_RELAY_DROP_PCT throws away that share of received
+// chunks to exercise the repair passes on real hardware (0 in production).
+#define FW_RX_QUEUE               32
+#define FW_VERIFY_BYTES_PER_TICK  16384
+#define FW_RELAY_DROP_PCT         0
+
+// SD asset sync (AssetSync, serial 'y' or ASSET_SYNC from the Master) over the
+// OTA WiFi. The index lists "<sha256> <size> <path>" per file, made by
+// tools/asset_manifest.py; files are fetched from the index's directory.
+#define ASSET_INDEX_URL    "http://172.20.10.3:8000/assets/assets.idx"
+#define ASSET_URL_MAX      200
+#define ASSET_PATH_MAX     96
+#define ASSET_MAX_FILES    512
+#define ASSET_MAX_CHANGED  64     // changed files whose cached clips are refreshed
+
 // Fill with your Master Feather's STA MAC (print on Master at boot)
 static uint8_t MASTER_MAC[6] = {0xEC,0xDA,0x3B,0x5B,0x8C,0x30};
 
+// Cache residency + SD health report to the Master (HEARTBEAT message)
+#define HEARTBEAT_MS 5000
+#define HEARTBEAT_WARM_MS 1000   // while the boot precache runs, so the Master sees it fill
+
+// Boot precache runs in the background after HELLO (Manifest_precacheStart)
+#define PRECACHE_TASK_STACK 6144
+#define PRECACHE_TASK_CORE  0      // WiFi's core; the loop task renders audio on core 1
+
+// Background loads hold the SD bus one chunk at a time; a streaming slot that
+// finds the bus taken by a chunk waits this long for it (the I2S DMA ring
+// holds ~90 ms) instead of playing silence
+#define SD_BG_CHUNK_BYTES   4096   // ~2 ms at 20 MHz
+#define SD_BG_WAIT_MS       4
+
+// Catalog strings (path, base, sub, sub2, tags) live in a fixed arena per
+// catalog block (Manifest.cpp); rows past it are dropped with a warning.
+// ~40 bytes a clip with category strings shared between neighbouring rows.
+#define MANIFEST_ARENA_BYTES  32768
+#define MANIFEST_LINE_MAX     256    // longer manifest rows are cut here
+
 // ------- AUDIO SETTINGS -------
 #define SAMPLE_RATE     44100  // 44100 or 48000; keep all files at the same rate
 
+// Clips repeated within a scene are read into PSRAM once and shared by their
+// slots (ClipSource). Bigger clips keep streaming per slot.
+#define SHARED_CLIP_MAX_BYTES (2u * 1024u * 1024u)
+
+// Tones are rendered once (one loop period) into PSRAM at scene set and played
+// from RAM instead of being synthesized every frame (ToneCache).
+#define TONE_CACHE_ENABLE      1
+#define TONE_CACHE_MAX_SAMPLES (SAMPLE_RATE * 2)
+
+// Clips held in PSRAM get zero-crossing loop points and a baked equal-power
+// crossfade at load time (ClipAnalysis), so their loops wrap without ramps.
+// The crossfade is stored after the clip (LOOP_XFADE_SAMPLES x 2 bytes more
+// per buffer) and only loop playback reads it.
+#define LOOP_XFADE_SAMPLES   256   // ~5.8 ms @ 44.1 kHz (capped at 1/4 clip)
+#define LOOP_SEARCH_SAMPLES 2048   // how far from each end to look for crossings
+
+// Leading/trailing silence is cut from PSRAM clips at load, and skipped on SD
+// streams when manifest.csv carries trim_start/trim_end (tools/clip_trim.py).
+#define TRIM_ENABLE        1
+#define TRIM_THRESHOLD_DB  (-50.0f)  // dBFS; quieter than this counts as silence
+#define TRIM_PAD_MS        4         // kept before the onset and after the tail
+
 // ------- SD on SPI1 pins (Unexpected Maker Feather S3) -------
 #define SD_CS    5
 #define SD_MOSI 35
 #define SD_MISO 37
 #define SD_SCK  36
 
+// SD clock governor (SdBus): steps 4..40 MHz from the 12 MHz boot clock
+#define SD_GOV_ENABLE        1
+#define SD_GOV_MAX_MHZ      40     // highest step the governor may try
+#define SD_GOV_WINDOW_READS 2000   // clean reads needed before stepping up
+#define SD_GOV_RETRY_PCT     2     // step down when retries exceed this % of reads
+#define SD_GOV_PERIOD_MS   1000    // how often the worker judges the window
+
 // ------- I2S #0 (Speakers 1 & 2) -------
 #define I2S0_DOUT 12
 #define I2S0_BCLK 43
@@ -36,13 +121,37 @@ static uint8_t MASTER_MAC[6] = {0xEC,0xDA,0x3B,0x5B,0x8C,0x30};
 #define I2S1_BCLK 8
 #define I2S1_LRCK 9
 
+// ------- Idle power (IdleGovernor, serial 'i') -------
+// Silence gates the I2S ports and amplifiers; light sleep is opt-in because
+// it also drops the USB serial console while napping.
+#define IDLE_GOVERNOR     1
+#define IDLE_GATE_MS      2000    // silence before the I2S ports stop
+#define IDLE_POLL_MS      5       // loop() period while gated (commands, buttons)
+#define AMP_EN_PIN        -1      // amplifier enable/shutdown line, -1 = none wired
+#define AMP_WAKE_MS       0       // amp settle time after enable (datasheet)
+#define IDLE_LIGHT_SLEEP  0       // 1 = light-sleep naps once idle for IDLE_SLEEP_MS
+#define IDLE_SLEEP_MS     30000   // no commands/buttons this long before napping
+#define IDLE_NAP_MS       250     // keep SIDE_WAKE_TIMEOUT_MS (ConfigMaster.h) above this
+#define IDLE_LISTEN_MS    20      // radio awake between naps
+
+// ------- One-shot voices (VoicePool) -------
+#define VOICES_PER_SLOT   4     // one-shots that can overlap one slot's loop
+#define ONESHOT_TONE_MS   250   // tones are cached as one period; play this long
+
+// ------- I2S DMA ring (per port, i2s_std driver) -------
+// The ring is the output latency and the render loop's slack against SD or
+// WiFi stalls: 8 x 512 frames ~= 93 ms at 44.1 kHz. A DMA buffer tops out
+// at 4092 bytes (1023 stereo 16-bit frames).
+#define I2S_DMA_DESC    8
+#define I2S_DMA_FRAMES  512
+
 // ------- Buttons (external pull-ups, active-low) -------
 #define BTN1_PIN 10
 #define BTN2_PIN 18
 #define BTN3_PIN 11
 #define BTN4_PIN 1
 
-// ------- RGB pins (one NeoPixel per button) -------
+// ------- RGB pins (one WS2812 per button, driven by RMT) -------
 #define RGB1_PIN 33
 #define RGB2_PIN 7
 #define RGB3_PIN 6
@@ -51,3 +160,12 @@ static uint8_t MASTER_MAC[6] = {0xEC,0xDA,0x3B,0x5B,0x8C,0x30};
 // Debounce
 #define DEBOUNCE_MS   20
 #define BRIGHTNESS    255
+#define LED_TICK_MS   5     // LED effect engine period (blink/progress timing resolution)
+
+// ------- LED level meter (each button pulses with its clip) -------
+#define LED_METER_ENABLE  1         // LED_ALL_WHITE shows per-slot level instead of flat white
+#define METER_USE_PEAK    0         // 0 = follow RMS, 1 = follow peak
+#define METER_FLOOR_DB    -48       // levels at/below this show METER_COLOR_LO
+#define METER_RELEASE_MS  150       // envelope decay time constant (attack is instant)
+#define METER_COLOR_LO    0x181818  // 0xRRGGBB at the floor (keep >0 so idle slots stay visible)
+#define METER_COLOR_HI    0xFFFFFF  // 0xRRGGBB at full scale
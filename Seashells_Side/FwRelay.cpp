@@ -0,0 +1,211 @@
+#include "FwRelay.h"
+#include "ConfigSide.h"
+#include "GameBusSide.h"
+#include "Messages.h"
+
+#include <esp_ota_ops.h>
+#include <esp_partition.h>
+#include <mbedtls/sha256.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+
+extern void side_stopAll();
+extern void side_blinkAll(uint8_t color, uint16_t on_ms, uint16_t off_ms);
+extern void otaShowProgress(uint8_t pct);
+
+static constexpr uint8_t  kIdle   = 0xFF;   // no transfer (not sent on the wire)
+static constexpr uint32_t kSector = 4096;
+
+struct FwChunk {
+  uint8_t  xfer;
+  uint8_t  len;
+  uint16_t index;
+  uint8_t  data[FW_CHUNK_BYTES];
+};
+
+static QueueHandle_t s_q = nullptr;
+static volatile uint8_t s_state = kIdle;
+static volatile uint8_t s_xfer  = 0;
+
+static const esp_partition_t* s_part = nullptr;
+static uint32_t s_size = 0, s_chunks = 0, s_have = 0;
+static uint32_t s_firstMissing = 0;     // every chunk below this is in flash
+static uint8_t  s_sha[32];
+static uint8_t* s_got = nullptr;        // bit per chunk
+static uint32_t s_erasedTo = 0, s_eraseEnd = 0;
+static bool     s_verifying = false;    // all chunks in, hashing the partition
+static uint32_t s_verifyOfs = 0;
+static uint32_t s_t0 = 0, s_dropped = 0;
+static uint8_t  s_pct = 0;
+static mbedtls_sha256_context s_ctx;
+
+static inline bool haveChunk(uint32_t i) { return s_got[i >> 3] & (1u << (i & 7)); }
+
+static uint32_t chunkLen(uint32_t i) {
+  return (i + 1 < s_chunks) ? FW_CHUNK_BYTES : s_size - i * FW_CHUNK_BYTES;
+}
+
+// FW_NACK: state plus the holes from the first missing chunk on
+static void sendReport() {
+  uint8_t  bm[FW_NACK_MAX_BITS / 8];
+  uint16_t base = 0, nbits = 0;
+  const uint8_t st = s_state;
+  if (st == FW_ST_RECEIVING && s_got && !s_verifying) {
+    while (s_firstMissing < s_chunks && haveChunk(s_firstMissing)) s_firstMissing++;
+    base  = (uint16_t)s_firstMissing;
+    nbits = (uint16_t)min((uint32_t)FW_NACK_MAX_BITS, s_chunks - s_firstMissing);
+    memset(bm, 0, (nbits + 7) / 8);
+    for (uint16_t k = 0; k < nbits; k++)
+      if (!haveChunk(base + k)) bm[k >> 3] |= (uint8_t)(1u << (k & 7));
+  }
+  GameBus_sendFwNack(s_xfer, st, base, nbits, bm);
+}
+
+static void fail(const char* why) {
+  Serial.printf("[FW] transfer %u failed: %s\n", (unsigned)s_xfer, why);
+  s_state = FW_ST_FAILED;
+  GameBus_sendOtaStatus(OTA_STATUS_FAIL_UPD);
+  sendReport();
+  side_blinkAll(/*red*/0, 160, 120);
+}
+
+void FwRelay_onChunk(const uint8_t* data, int len) {
+  if (s_state != FW_ST_RECEIVING || !s_q || len < 5) return;
+  if (FW_RELAY_DROP_PCT && random(100) < FW_RELAY_DROP_PCT) { s_dropped++; return; }
+  FwChunk c;
+  c.xfer  = data[1];
+  c.index = (uint16_t)(data[2] << 8 | data[3]);
+  c.len   = (uint8_t)min(len - 4, (int)FW_CHUNK_BYTES);
+  memcpy(c.data, data + 4, c.len);
+  if (xQueueSend(s_q, &c, 0) != pdTRUE) s_dropped++;   // full: the next NACK asks again
+}
+
+void FwRelay_onOffer(const uint8_t* p, uint8_t len) {
+  if (len < 37) return;
+  const uint8_t  xfer = p[0];
+  const uint32_t size = (uint32_t)p[1] << 24 | (uint32_t)p[2] << 16 | (uint32_t)p[3] << 8 | p[4];
+
+  // Repeated offer = status poll
+  if (s_state != kIdle && xfer == s_xfer && size == s_size && !memcmp(p + 5, s_sha, 32)) {
+    sendReport();
+    return;
+  }
+
+  if (!s_q) s_q = xQueueCreate(FW_RX_QUEUE, sizeof(FwChunk));
+  s_state = kIdle;             // callback stops queueing while the session is rebuilt
+  if (s_q) xQueueReset(s_q);
+  free(s_got);
+  s_got = nullptr;
+  if (s_verifying) { mbedtls_sha256_free(&s_ctx); s_verifying = false; }
+
+  s_xfer = xfer;
+  s_size = size;
+  memcpy(s_sha, p + 5, 32);
+  s_chunks = (size + FW_CHUNK_BYTES - 1) / FW_CHUNK_BYTES;
+  s_have = s_firstMissing = 0;
+  s_dropped = 0;
+  s_pct = 0;
+  s_t0 = millis();
+  Serial.printf("[FW] offer %u: %lu bytes in %lu chunks\n",
+                (unsigned)xfer, (unsigned long)size, (unsigned long)s_chunks);
+
+  s_part = esp_ota_get_next_update_partition(nullptr);
+  s_got  = (uint8_t*)calloc((s_chunks + 7) / 8, 1);
+  s_state = FW_ST_ERASING;
+  if (!s_q || !s_got)         { fail("alloc"); return; }
+  if (!s_part)                { fail("no OTA partition"); return; }
+  if (!size || size > s_part->size) { fail("image too large"); return; }
+
+  side_stopAll();               // flash erase/write stalls the caches audio reads through
+  otaShowProgress(0);
+  GameBus_sendOtaStatus(OTA_STATUS_BEGIN);
+  s_erasedTo = 0;
+  s_eraseEnd = (size + kSector - 1) & ~(kSector - 1);
+  sendReport();
+}
+
+void FwRelay_onCommit(const uint8_t* p, uint8_t len) {
+  if (len < 1 || p[0] != s_xfer || s_state != FW_ST_COMPLETE) return;
+  esp_err_t e = esp_ota_set_boot_partition(s_part);   // validates the image
+  if (e != ESP_OK) {
+    Serial.printf("[FW] set boot partition: %s\n", esp_err_to_name(e));
+    fail("image rejected");
+    return;
+  }
+  Serial.println("[FW] commit, rebooting");
+  GameBus_sendOtaStatus(OTA_STATUS_OK);
+  otaShowProgress(100);
+  side_blinkAll(/*green*/1, 140, 120);
+  delay(200);
+  ESP.restart();
+}
+
+bool FwRelay_busy() { return s_state == FW_ST_ERASING || s_state == FW_ST_RECEIVING; }
+
+void FwRelay_tick() {
+  if (s_state == FW_ST_ERASING) {
+    // One block per tick keeps GameBus and the buttons polled
+    uint32_t n = min((uint32_t)OTA_ERASE_BYTES, s_eraseEnd - s_erasedTo);
+    if (n && esp_partition_erase_range(s_part, s_erasedTo, n) != ESP_OK) { fail("erase"); return; }
+    s_erasedTo += n;
+    if (s_erasedTo >= s_eraseEnd) {
+      Serial.printf("[FW] partition ready in %lu ms\n", (unsigned long)(millis() - s_t0));
+      s_state = FW_ST_RECEIVING;
+      sendReport();
+    }
+    return;
+  }
+  if (s_state != FW_ST_RECEIVING) return;
+
+  if (s_verifying) {
+    uint8_t buf[1024];
+    const uint32_t end = min(s_size, s_verifyOfs + FW_VERIFY_BYTES_PER_TICK);
+    while (s_verifyOfs < end) {
+      uint32_t n = min((uint32_t)sizeof(buf), end - s_verifyOfs);
+      if (esp_partition_read(s_part, s_verifyOfs, buf, n) != ESP_OK) break;
+      mbedtls_sha256_update(&s_ctx, buf, n);
+      s_verifyOfs += n;
+    }
+    if (s_verifyOfs < end) {
+      mbedtls_sha256_free(&s_ctx);
+      s_verifying = false;
+      fail("read back");
+      return;
+    }
+    if (s_verifyOfs < s_size) return;
+    uint8_t digest[32];
+    mbedtls_sha256_finish(&s_ctx, digest);
+    mbedtls_sha256_free(&s_ctx);
+    s_verifying = false;
+    if (memcmp(digest, s_sha, 32) != 0) { fail("sha256 mismatch"); return; }
+    Serial.printf("[FW] image verified in %lu ms (%lu chunks dropped on receive)\n",
+                  (unsigned long)(millis() - s_t0), (unsigned long)s_dropped);
+    s_state = FW_ST_COMPLETE;
+    sendReport();
+    return;
+  }
+
+  FwChunk c;
+  while (xQueueReceive(s_q, &c, 0) == pdTRUE) {
+    if (c.xfer != s_xfer || c.index >= s_chunks || haveChunk(c.index)) continue;
+    if (c.len != chunkLen(c.index)) continue;
+    if (esp_partition_write(s_part, (size_t)c.index * FW_CHUNK_BYTES, c.data, c.len) != ESP_OK) {
+      fail("write");
+      return;
+    }
+    s_got[c.index >> 3] |= (uint8_t)(1u << (c.index & 7));
+    s_have++;
+  }
+
+  const uint8_t pct = (uint8_t)((uint64_t)s_have * 100 / s_chunks);
+  if (pct != s_pct) { s_pct = pct; otaShowProgress(pct); }
+
+  if (s_have == s_chunks) {
+    Serial.printf("[FW] all %lu chunks in after %lu ms, verifying\n",
+                  (unsigned long)s_chunks, (unsigned long)(millis() - s_t0));
+    mbedtls_sha256_init(&s_ctx);
+    mbedtls_sha256_starts(&s_ctx, 0);
+    s_verifyOfs = 0;
+    s_verifying = true;
+  }
+}
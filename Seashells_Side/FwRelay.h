@@ -0,0 +1,20 @@
+#pragma once
+#include <Arduino.h>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Receiving a firmware image the Master broadcasts over ESP-NOW (Messages.h,
+// FW_*), the alternative to every Side fetching OTA_UPDATE's URL over WiFi.
+//
+// FW_OFFER picks the next OTA partition and erases it a block per tick;
+// chunks are then queued straight from the ESP-NOW callback and written at
+// chunk * FW_CHUNK_BYTES in any order, so the Master's repair passes can fill
+// holes. Every FW_OFFER is answered with a FW_NACK (state + missing bitmap).
+// Once all chunks are in, the partition is hashed against the offer and the
+// Side waits for FW_COMMIT to boot it.
+// ─────────────────────────────────────────────────────────────────────────────
+
+void FwRelay_onChunk(const uint8_t* data, int len);    // ESP-NOW callback context: queues only
+void FwRelay_onOffer(const uint8_t* p, uint8_t len);   // payload after the type byte
+void FwRelay_onCommit(const uint8_t* p, uint8_t len);
+void FwRelay_tick();                                   // from loop(): erase, write, verify
+bool FwRelay_busy();
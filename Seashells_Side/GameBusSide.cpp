@@ -5,6 +5,11 @@
 #include "Manifest.h"
 #include "Role.h"
 #include "OtaUpdate.h"
+#include "Trace.h"
+#include "SdBus.h"
+#include "FwRelay.h"
+#include "AssetSync.h"
+#include "IdleGovernor.h"
 
 // Externs implemented in the .ino (audio/led functions)
 extern void side_setScene(uint16_t ids[4]);
@@ -14,10 +19,12 @@ extern void side_blinkAll(uint8_t color, uint16_t on_ms, uint16_t off_ms);
 extern void side_setGameMode(bool en);
 extern void side_startLoopAll();
 extern void side_stopAll();
+extern void side_playOneshot(uint8_t slot, uint16_t id, uint8_t prio);
+extern void side_reloadManifest();
 
 // ─────────────────────────────────────────────────────────────────────────────
 // IMPORTANT: ESP-NOW receive callbacks run in the WiFi task context.
-// Doing SD I/O, NeoPixel .show(), or other heavy work inside the callback can
+// Doing SD I/O, LED pushes, or other heavy work inside the callback can
 // cause random glitches (including missed LED updates).
 //
 // Fix: queue inbound commands in the callback, then process them in the main
@@ -74,16 +81,33 @@ static inline bool qPop(CmdMsg& out) {
   return true;
 }
 
+static void sendToMaster(const uint8_t* pkt, size_t n) {
+  Trace_rec(TR_PKT_TX, pkt[0], TRACE_PEER_MASTER);
+  esp_now_send(MASTER_MAC, pkt, n);
+}
+
 void GameBus_sendOtaStatus(uint8_t code) {
   uint8_t sid = (Role::get()==0xFF) ? 255 : Role::get();   // 255 = UNASSIGNED
   uint8_t pkt[3] = { OTA_STATUS, sid, code };
-  esp_now_send(MASTER_MAC, pkt, sizeof(pkt));
+  sendToMaster(pkt, sizeof(pkt));
 }
 
 void GameBus_sendOtaProgress(uint8_t percent) {
   uint8_t sid = (Role::get()==0xFF) ? 255 : Role::get();
   uint8_t pkt[4] = { OTA_STATUS, sid, OTA_STATUS_PROGRESS, percent };
-  esp_now_send(MASTER_MAC, pkt, sizeof(pkt));
+  sendToMaster(pkt, sizeof(pkt));
+}
+
+void GameBus_sendFwNack(uint8_t xfer, uint8_t state, uint16_t base, uint16_t nbits, const uint8_t* bitmap) {
+  uint8_t pkt[8 + FW_NACK_MAX_BITS / 8];
+  uint8_t sid = (Role::get()==0xFF) ? 255 : Role::get();
+  if (nbits > FW_NACK_MAX_BITS) nbits = FW_NACK_MAX_BITS;
+  pkt[0] = FW_NACK; pkt[1] = sid; pkt[2] = xfer; pkt[3] = state;
+  pkt[4] = base >> 8;  pkt[5] = base & 0xFF;
+  pkt[6] = nbits >> 8; pkt[7] = nbits & 0xFF;
+  const size_t bytes = (nbits + 7) / 8;
+  if (bytes) memcpy(pkt + 8, bitmap, bytes);
+  sendToMaster(pkt, 8 + bytes);
 }
 
 // v3 core signature
@@ -96,6 +120,11 @@ static void onDataRecv(const esp_now_recv_info_t* info, const uint8_t* data, int
   }
 
   const uint8_t type = data[0];
+
+  // Firmware chunks bypass the command queue (too big, too many) and the trace
+  if (type == FW_CHUNK) { FwRelay_onChunk(data, len); return; }
+
+  Trace_rec(TR_PKT_RX, type, TRACE_PEER_MASTER);
   const uint8_t plen = (len > 1) ? (uint8_t)min(len - 1, (int)kCmdMaxPayload) : 0;
 
   // Queue payload bytes (everything after the type)
@@ -120,25 +149,83 @@ void GameBus_deinit() {
   esp_now_deinit();
 }
 
+// Append the cache report (Messages.h) at out; returns bytes written
+static size_t buildCacheReport(uint8_t* out, size_t maxLen) {
+  static uint16_t ids[256];
+  const size_t n = Manifest_residentIds(ids, 256);
+  const uint32_t usedKB   = (uint32_t)(Manifest_cacheBytes() / 1024);
+  const uint32_t budgetKB = ESP.getPsramSize() / 1024;
+
+  size_t p = 0;
+  out[p++] = Manifest_warming() ? CACHE_FLAG_WARMING : 0;   // TRUNCATED added below
+  out[p++] = (uint8_t)(min(budgetKB, 0xFFFFu) >> 8); out[p++] = (uint8_t)min(budgetKB, 0xFFFFu);
+  out[p++] = (uint8_t)(min(usedKB,   0xFFFFu) >> 8); out[p++] = (uint8_t)min(usedKB,   0xFFFFu);
+  out[p++] = SdBus_health();
+  out[p++] = Manifest_warmPercent();
+  const size_t nSegAt = p++;
+  uint8_t nSeg = 0;
+
+  size_t i = 0;
+  while (i < n) {
+    // One segment covers IDs within CACHE_SEG_MAX_BITS of its first ID
+    const uint16_t first = ids[i];
+    size_t j = i;
+    while (j + 1 < n && ids[j + 1] - first < CACHE_SEG_MAX_BITS) j++;
+    const uint8_t nbits = (uint8_t)(ids[j] - first + 1);
+    const size_t  bytes = (nbits + 7) / 8;
+    if (p + 3 + bytes > maxLen) { out[0] |= CACHE_FLAG_TRUNCATED; break; }
+
+    out[p++] = (uint8_t)(first >> 8); out[p++] = (uint8_t)first;
+    out[p++] = nbits;
+    memset(out + p, 0, bytes);
+    for (size_t k = i; k <= j; k++) {
+      const uint16_t bit = ids[k] - first;
+      out[p + bit / 8] |= (uint8_t)(1u << (bit % 8));
+    }
+    p += bytes;
+    nSeg++;
+    i = j + 1;
+  }
+  out[nSegAt] = nSeg;
+  return p;
+}
+
 void GameBus_sendHello(uint16_t poolA_count, uint16_t poolB_count) {
-  uint8_t pkt[1+1+2+2];
+  uint8_t pkt[ESP_NOW_MAX_DATA_LEN];
   pkt[0]=HELLO;
   pkt[1]=Role::get()==0xFF ? 255 : Role::get();   // report 255 if unassigned
   pkt[2]=poolA_count>>8; pkt[3]=poolA_count&0xFF;
   pkt[4]=poolB_count>>8; pkt[5]=poolB_count&0xFF;
-  esp_now_send(MASTER_MAC, pkt, sizeof(pkt));
+  size_t n = 6 + buildCacheReport(pkt + 6, sizeof(pkt) - 6);
+  sendToMaster(pkt, n);
+}
+
+void GameBus_sendHeartbeat() {
+  uint8_t pkt[ESP_NOW_MAX_DATA_LEN];
+  pkt[0]=HEARTBEAT;
+  pkt[1]=Role::get()==0xFF ? 255 : Role::get();
+  size_t n = 2 + buildCacheReport(pkt + 2, sizeof(pkt) - 2);
+  sendToMaster(pkt, n);
 }
 
 void GameBus_sendBtnEvent(uint8_t slotIdx) {
   uint8_t pkt[3] = { BTN_EVENT, (uint8_t)(Role::get()==0xFF?255:Role::get()), (uint8_t)slotIdx };
-  esp_now_send(MASTER_MAC, pkt, sizeof(pkt));
+  sendToMaster(pkt, sizeof(pkt));
 }
 
 // Pump queued commands from the Arduino loop (safe context)
 void GameBus_pump() {
   CmdMsg m;
   while (qPop(m)) {
+    IdleGov_kick();   // the Master is talking to us: no light sleep for a while
     switch (m.type) {
+      case HELLO_REQ: {
+        // Also the Master's wake ping for a napping Side
+        uint16_t a = 0, b = 0;
+        Manifest_poolCounts(&a, &b);
+        GameBus_sendHello(a, b);
+      } break;
+
       case SET_SCENE: {
         if (m.len < 8) break;
         uint16_t ids[4];
@@ -183,11 +270,17 @@ void GameBus_pump() {
         GB_onStopAll();
       } break;
 
+      case PLAY_ONESHOT: {
+        if (m.len < 4) break;
+        GB_onPlayOneshot(m.payload[0], (uint16_t)m.payload[1] << 8 | m.payload[2], m.payload[3]);
+      } break;
+
       case ROLE_ASSIGN: {
         if (m.len < 1) break;
         uint8_t newId = m.payload[0] & 1;          // 0=A, 1=B
         Serial.printf("[SIDE] ROLE_ASSIGN %u\n", newId);
         Role::set(newId, /*persist*/true);
+        Trace_setDevice(newId ? 'B' : 'A');
       } break;
 
       case OTA_UPDATE: {
@@ -199,6 +292,26 @@ void GameBus_pump() {
         side_requestOtaStart();
       } break;
 
+      case ASSET_SYNC: {
+        if (m.len < 1) break;
+        uint8_t ulen = m.payload[0];
+        if (ulen == 0 || ulen > (uint8_t)(m.len - 1)) break;
+        side_setAssetUrl((const char*)(m.payload + 1), ulen);
+        side_requestAssetSync();
+      } break;
+
+      case MANIFEST_RELOAD: {
+        side_reloadManifest();
+      } break;
+
+      case FW_OFFER: {
+        FwRelay_onOffer(m.payload, m.len);
+      } break;
+
+      case FW_COMMIT: {
+        FwRelay_onCommit(m.payload, m.len);
+      } break;
+
       default:
         break;
     }
@@ -236,7 +349,7 @@ void GB_onRequestRandom(uint8_t needA, uint8_t needB) {
   for (uint8_t i=0;i<nB && i<4;i++){ pkt[idx++]=b[i]>>8; pkt[idx++]=b[i]&0xFF; }
   for (uint8_t pad=nB; pad<4; pad++){ pkt[idx++]=0; pkt[idx++]=0; }
 
-  esp_now_send(MASTER_MAC, pkt, idx);
+  sendToMaster(pkt, idx);
 }
 
 void GB_onPlaySlot(uint8_t slot) { side_playSlot(slot); }
@@ -250,3 +363,4 @@ void GB_onStartLoopAll() {
   side_startLoopAll();
 }
 void GB_onStopAll() { side_stopAll(); }
+void GB_onPlayOneshot(uint8_t slot, uint16_t id, uint8_t prio) { side_playOneshot(slot, id, prio); }
@@ -10,9 +10,11 @@ void GameBus_init();
 void GameBus_deinit();
 void GameBus_pump();  // call this from loop() to process queued ESP-NOW commands
 void GameBus_sendHello(uint16_t poolA_count, uint16_t poolB_count);
+void GameBus_sendHeartbeat();   // cache residency + SD health, every HEARTBEAT_MS
 void GameBus_sendBtnEvent(uint8_t slotIdx);
 void GameBus_sendOtaStatus(uint8_t code);
 void GameBus_sendOtaProgress(uint8_t percent);
+void GameBus_sendFwNack(uint8_t xfer, uint8_t state, uint16_t base, uint16_t nbits, const uint8_t* bitmap);
 
 // Handlers called by GameBus when packets arrive:
 void GB_onSetScene(uint16_t ids[4]);
@@ -23,3 +25,4 @@ void GB_onBlinkAll(uint8_t color, uint16_t on_ms, uint16_t off_ms);
 void GB_onGameMode(bool enabled);
 void GB_onStartLoopAll();
 void GB_onStopAll();
+void GB_onPlayOneshot(uint8_t slot, uint16_t id, uint8_t prio);
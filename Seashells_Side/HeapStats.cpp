@@ -0,0 +1,85 @@
+#include "HeapStats.h"
+#include <esp_heap_caps.h>
+
+static const uint32_t kInternal = MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT;
+static const uint32_t kPsram    = MALLOC_CAP_SPIRAM;
+
+#if CONFIG_HEAP_USE_HOOKS
+// Called by the allocator from any task or ISR: counters only
+static volatile uint32_t s_allocs = 0, s_frees = 0;
+
+extern "C" void IRAM_ATTR esp_heap_trace_alloc_hook(void* ptr, size_t size, uint32_t caps) {
+  (void)ptr; (void)size; (void)caps;
+  __atomic_fetch_add(&s_allocs, 1, __ATOMIC_RELAXED);
+}
+extern "C" void IRAM_ATTR esp_heap_trace_free_hook(void* ptr) {
+  if (ptr) __atomic_fetch_add(&s_frees, 1, __ATOMIC_RELAXED);
+}
+#endif
+
+static uint32_t s_markMs = 0;
+#if CONFIG_HEAP_USE_HOOKS
+static uint32_t s_markAllocs = 0, s_markFrees = 0;
+static uint32_t s_commitAllocs = 0, s_commitFrees = 0;
+#endif
+static size_t   s_markBlocks[2] = { 0, 0 };   // internal, PSRAM
+static long     s_commitBlocks[2] = { 0, 0 };  // change during the scene commit
+static uint32_t s_commitMs = 0;
+
+static size_t allocatedBlocks(uint32_t caps) {
+  multi_heap_info_t info;
+  heap_caps_get_info(&info, caps);
+  return info.allocated_blocks;
+}
+
+void HeapStats_mark() {
+  s_markMs = millis();
+#if CONFIG_HEAP_USE_HOOKS
+  s_markAllocs = s_allocs;
+  s_markFrees  = s_frees;
+#endif
+  s_markBlocks[0] = allocatedBlocks(kInternal);
+  s_markBlocks[1] = allocatedBlocks(kPsram);
+}
+
+void HeapStats_commitDone() {
+  s_commitMs = millis() - s_markMs;
+#if CONFIG_HEAP_USE_HOOKS
+  s_commitAllocs = s_allocs - s_markAllocs;
+  s_commitFrees  = s_frees - s_markFrees;
+#endif
+  s_commitBlocks[0] = (long)allocatedBlocks(kInternal) - (long)s_markBlocks[0];
+  s_commitBlocks[1] = (long)allocatedBlocks(kPsram) - (long)s_markBlocks[1];
+}
+
+static void heapLine(Print& out, const char* name, uint32_t caps, size_t markBlocks) {
+  multi_heap_info_t info;
+  heap_caps_get_info(&info, caps);
+  if (!info.total_free_bytes && !info.total_allocated_bytes) return;   // no PSRAM fitted
+  out.printf("[HEAP] %-8s free %u, low-water %u, largest block %u; %u blocks (%+ld since mark)\n",
+             name, (unsigned)info.total_free_bytes, (unsigned)info.minimum_free_bytes,
+             (unsigned)info.largest_free_block, (unsigned)info.allocated_blocks,
+             (long)info.allocated_blocks - (long)markBlocks);
+}
+
+void HeapStats_report(Print& out) {
+  heapLine(out, "internal", kInternal, s_markBlocks[0]);
+  heapLine(out, "psram", kPsram, s_markBlocks[1]);
+#if CONFIG_HEAP_USE_HOOKS
+  out.printf("[HEAP] scene commit (%lu ms): %lu allocs / %lu frees, blocks %+ld internal %+ld psram\n",
+             (unsigned long)s_commitMs, (unsigned long)s_commitAllocs, (unsigned long)s_commitFrees,
+             s_commitBlocks[0], s_commitBlocks[1]);
+#else
+  out.printf("[HEAP] scene commit (%lu ms): blocks %+ld internal %+ld psram\n",
+             (unsigned long)s_commitMs, s_commitBlocks[0], s_commitBlocks[1]);
+#endif
+#if CONFIG_HEAP_USE_HOOKS
+  const uint32_t a = s_allocs, f = s_frees;
+  out.printf("[HEAP] %lu allocs / %lu frees since boot; %lu / %lu in the %lu ms since the mark\n",
+             (unsigned long)a, (unsigned long)f, (unsigned long)(a - s_markAllocs),
+             (unsigned long)(f - s_markFrees), (unsigned long)(millis() - s_markMs));
+#else
+  out.printf("[HEAP] %lu ms since the mark; no heap hooks in this build, block deltas only\n",
+             (unsigned long)(millis() - s_markMs));
+#endif
+}
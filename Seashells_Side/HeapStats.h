@@ -0,0 +1,25 @@
+#pragma once
+#include <Arduino.h>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Heap accounting, to check that gameplay runs without allocating.
+//
+// Every malloc/free is counted through the IDF heap hooks when the core is
+// built with CONFIG_HEAP_USE_HOOKS; otherwise the change in allocated blocks
+// per heap stands in for the count (it misses an alloc freed again in the
+// same window). Free memory, its low-water mark since boot and the largest
+// free block are read for internal RAM and PSRAM.
+//
+// side_setScene() marks the start of each scene commit and closes the commit
+// when it returns, so serial 'h' prints the commit's own allocations (SD.open
+// File objects, first-use ToneCache buffers, shared clip blocks) on one line
+// and everything since the mark on another. Their difference is gameplay:
+// with streaming slots only SD reopens after a fault should show up there.
+// ─────────────────────────────────────────────────────────────────────────────
+
+// Start a new window (allocations since the mark)
+void HeapStats_mark();
+// End of the scene commit that started at the mark
+void HeapStats_commitDone();
+
+void HeapStats_report(Print& out);
@@ -0,0 +1,121 @@
+#include "IdleGovernor.h"
+#include "ConfigSide.h"
+#include <esp_sleep.h>
+#include <driver/gpio.h>
+
+enum IdleState : uint8_t { IDLE_ACTIVE, IDLE_GATED };
+
+static IdleState s_state = IDLE_ACTIVE;
+static uint32_t  s_silentSinceMs = 0;     // 0 = not silent
+static uint32_t  s_gatedAtMs = 0;
+static uint32_t  s_activityMs = 0;        // last kick, for light sleep
+static uint32_t  s_napEndMs = 0;          // listen window after a nap starts here
+static int64_t   s_wakeStartUs = -1;      // pending wake-to-first-sample measurement
+static int64_t   s_buttonWakeUs = -1;     // a button ended the last nap at this time
+
+static uint32_t s_gates = 0, s_naps = 0, s_buttonWakes = 0;
+static uint64_t s_gatedMs = 0, s_sleptUs = 0;
+static uint32_t s_wakeLastUs = 0, s_wakeMaxUs = 0;
+
+static const uint8_t kWakePins[4] = { BTN1_PIN, BTN2_PIN, BTN3_PIN, BTN4_PIN };
+
+static void ampEnable(bool on) {
+  if (AMP_EN_PIN < 0) return;
+  pinMode(AMP_EN_PIN, OUTPUT);
+  digitalWrite(AMP_EN_PIN, on ? HIGH : LOW);
+}
+
+static void gate(AudioOutput* out, uint32_t now) {
+  out->suspend();
+  ampEnable(false);
+  s_state = IDLE_GATED;
+  s_gatedAtMs = now;
+  s_activityMs = now;   // light sleep counts from the gate or the last kick after it
+  s_gates++;
+  Serial.printf("[IDLE] silent %lu ms: audio gated\n", (unsigned long)(now - s_silentSinceMs));
+}
+
+static void ungate(AudioOutput* out, uint32_t now) {
+  // A button that ended a nap started this wake; otherwise it starts now
+  s_wakeStartUs = (s_buttonWakeUs >= 0) ? s_buttonWakeUs : esp_timer_get_time();
+  s_buttonWakeUs = -1;
+  ampEnable(true);
+  if (AMP_WAKE_MS) delay(AMP_WAKE_MS);
+  out->resume();
+  s_state = IDLE_ACTIVE;
+  s_gatedMs += now - s_gatedAtMs;
+  s_activityMs = now;
+}
+
+// Light sleep until a button goes low or IDLE_NAP_MS pass. ESP-NOW frames
+// that arrive meanwhile are lost; the Master's HELLO_REQ pings cover that.
+static void nap() {
+  for (uint8_t pin : kWakePins) gpio_wakeup_enable((gpio_num_t)pin, GPIO_INTR_LOW_LEVEL);
+  esp_sleep_enable_gpio_wakeup();
+  esp_sleep_enable_timer_wakeup((uint64_t)IDLE_NAP_MS * 1000);
+  Serial.flush();
+
+  const int64_t t0 = esp_timer_get_time();
+  esp_light_sleep_start();
+  const int64_t t1 = esp_timer_get_time();
+
+  for (uint8_t pin : kWakePins) gpio_wakeup_disable((gpio_num_t)pin);
+  s_sleptUs += (uint64_t)(t1 - t0);
+  s_naps++;
+  s_napEndMs = millis();
+  if (esp_sleep_get_wakeup_cause() == ESP_SLEEP_WAKEUP_GPIO) {
+    s_buttonWakes++;
+    s_buttonWakeUs = t1;
+    s_activityMs = s_napEndMs;   // stay up for the press and whatever follows
+  }
+}
+
+bool IdleGov_tick(AudioOutput* out, bool silent, bool busy) {
+  if (!IDLE_GOVERNOR) return true;
+  const uint32_t now = millis();
+
+  if (s_state == IDLE_ACTIVE) {
+    if (!silent || busy) { s_silentSinceMs = 0; return true; }
+    if (!s_silentSinceMs) s_silentSinceMs = now ? now : 1;
+    if (now - s_silentSinceMs >= IDLE_GATE_MS) gate(out, now);
+    return true;   // the pass that gates still renders; the next one doesn't
+  }
+
+  if (!silent) {
+    s_silentSinceMs = 0;
+    ungate(out, now);
+    return true;
+  }
+
+  if (IDLE_LIGHT_SLEEP && !busy && now - s_activityMs >= IDLE_SLEEP_MS &&
+      now - s_napEndMs >= IDLE_LISTEN_MS) {
+    nap();
+  } else {
+    delay(IDLE_POLL_MS);
+  }
+  return false;
+}
+
+void IdleGov_kick() {
+  s_activityMs = millis();
+}
+
+void IdleGov_frameWritten() {
+  if (s_wakeStartUs < 0) return;
+  s_wakeLastUs = (uint32_t)(esp_timer_get_time() - s_wakeStartUs);
+  s_wakeMaxUs = max(s_wakeMaxUs, s_wakeLastUs);
+  s_wakeStartUs = -1;
+  Serial.printf("[IDLE] wake -> first sample %lu us\n", (unsigned long)s_wakeLastUs);
+}
+
+void IdleGov_report(Print& out) {
+  const uint32_t now = millis();
+  const uint64_t gatedMs = s_gatedMs + (s_state == IDLE_GATED ? now - s_gatedAtMs : 0);
+  out.printf("[IDLE] %s, up %lu ms: gated %lu ms (%u times), light sleep %lu ms (%u naps, %u by button)\n",
+             s_state == IDLE_GATED ? "gated" : "active", (unsigned long)now,
+             (unsigned long)gatedMs, (unsigned)s_gates,
+             (unsigned long)(s_sleptUs / 1000), (unsigned)s_naps, (unsigned)s_buttonWakes);
+  out.printf("[IDLE] wake -> first sample: last %lu us, max %lu us (DMA ring adds %lu us)\n",
+             (unsigned long)s_wakeLastUs, (unsigned long)s_wakeMaxUs,
+             (unsigned long)((uint64_t)I2S_DMA_DESC * I2S_DMA_FRAMES * 1000000 / SAMPLE_RATE));
+}
@@ -0,0 +1,35 @@
+#pragma once
+#include <Arduino.h>
+#include "AudioOutput.h"
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Idle power management for battery installs.
+//
+// After IDLE_GATE_MS of silence (every slot IDLE, no one-shot voice) the
+// render loop stops: the I2S ports are disabled, the amplifier enable line
+// (AMP_EN_PIN, if wired) goes low and loop() polls at IDLE_POLL_MS instead of
+// spinning, so the CPU idles between polls. The first pass that isn't silent
+// re-enables everything and renders at once.
+//
+// With IDLE_LIGHT_SLEEP, IDLE_SLEEP_MS without activity (commands, buttons,
+// serial) moves on to light-sleep naps of IDLE_NAP_MS. A button wakes the
+// chip straight away; between naps the radio listens for IDLE_LISTEN_MS, and
+// any command keeps the Side awake. The Master pings with HELLO_REQ until a
+// Side answers before it starts a game or sends a job (SIDE_WAKE_TIMEOUT_MS).
+//
+// Wake-to-first-sample (from the wake trigger to the first frame handed to
+// I2S) is measured on every resume; serial 'i' prints it with the idle totals.
+// ─────────────────────────────────────────────────────────────────────────────
+
+// Once per loop() before rendering. silent: nothing would be audible;
+// busy: a job that must not be slept through (precache, firmware relay).
+// Returns false while gated: skip rendering this pass.
+bool IdleGov_tick(AudioOutput* out, bool silent, bool busy);
+
+// Activity that should postpone light sleep (commands, buttons, serial)
+void IdleGov_kick();
+
+// After each g_out->write(); closes a wake-to-first-sample measurement
+void IdleGov_frameWritten();
+
+void IdleGov_report(Print& out);
@@ -0,0 +1,75 @@
+#include "LedDriver.h"
+#include "esp32-hal-rmt.h"
+
+// 10 MHz RMT tick = 100 ns. WS2812 timings (±150 ns tolerance):
+//   0 bit: 400 ns high, 850 ns low    1 bit: 800 ns high, 450 ns low
+static constexpr uint32_t kRmtHz   = 10000000;
+static constexpr uint16_t kT0H     = 4;
+static constexpr uint16_t kT0L     = 8;
+static constexpr uint16_t kT1H     = 8;
+static constexpr uint16_t kT1L     = 4;
+static constexpr size_t   kBitsPer = 24;
+
+struct LedPixel {
+  uint8_t    pin   = 0;
+  bool       ok    = false;
+  bool       dirty = false;
+  uint8_t    grb[3] = {0,0,0};
+  rmt_data_t sym[kBitsPer];   // must stay valid until the async write completes
+};
+
+static LedPixel s_px[kLedCount];
+static uint16_t s_scale = 256;  // brightness multiplier, 256 == unity
+
+static inline uint8_t scale8(uint8_t c) { return (uint8_t)(((uint16_t)c * s_scale) >> 8); }
+
+bool LedDriver_begin(const uint8_t pins[kLedCount], uint8_t brightness) {
+  s_scale = (uint16_t)brightness + 1;
+  bool all = true;
+  for (uint8_t i = 0; i < kLedCount; i++) {
+    LedPixel& p = s_px[i];
+    p.pin = pins[i];
+    p.ok  = rmtInit(p.pin, RMT_TX_MODE, RMT_MEM_NUM_BLOCKS_1, kRmtHz);
+    if (!p.ok) {
+      Serial.printf("[LED] rmtInit FAIL pin %u\n", (unsigned)p.pin);
+      all = false;
+      continue;
+    }
+    p.grb[0] = p.grb[1] = p.grb[2] = 0;
+    p.dirty = true;   // push "off" once so the strip matches our state
+  }
+  return all;
+}
+
+void LedDriver_set(uint8_t i, uint8_t r, uint8_t g, uint8_t b) {
+  if (i >= kLedCount) return;
+  LedPixel& p = s_px[i];
+  const uint8_t G = scale8(g), R = scale8(r), B = scale8(b);
+  if (p.grb[0] == G && p.grb[1] == R && p.grb[2] == B) return;
+  p.grb[0] = G; p.grb[1] = R; p.grb[2] = B;
+  p.dirty = true;
+}
+
+static void encode(LedPixel& p) {
+  size_t k = 0;
+  for (uint8_t byte = 0; byte < 3; byte++) {
+    for (int bit = 7; bit >= 0; bit--) {
+      const bool one = (p.grb[byte] >> bit) & 1;
+      rmt_data_t& s = p.sym[k++];
+      s.level0    = 1;
+      s.duration0 = one ? kT1H : kT0H;
+      s.level1    = 0;
+      s.duration1 = one ? kT1L : kT0L;
+    }
+  }
+}
+
+void LedDriver_push() {
+  for (uint8_t i = 0; i < kLedCount; i++) {
+    LedPixel& p = s_px[i];
+    if (!p.ok || !p.dirty) continue;
+    if (!rmtTransmitCompleted(p.pin)) continue;   // previous frame still on the wire
+    encode(p);
+    if (rmtWriteAsync(p.pin, p.sym, kBitsPer)) p.dirty = false;
+  }
+}
@@ -0,0 +1,23 @@
+#pragma once
+#include <Arduino.h>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Non-blocking WS2812 driver: one pixel per button, one RMT TX channel per pin.
+//
+// Adafruit_NeoPixel::show() bit-bangs with interrupts off for every strip, four
+// times per "all LEDs" change. Here each pixel is encoded into RMT symbols and
+// sent with rmtWriteAsync(); only pixels whose colour changed since the last
+// push are sent. Call LedDriver_push() from a single context (the LedFx timer).
+// ─────────────────────────────────────────────────────────────────────────────
+
+static constexpr uint8_t kLedCount = 4;
+
+bool LedDriver_begin(const uint8_t pins[kLedCount], uint8_t brightness);
+
+// Stage a colour (not sent until LedDriver_push()). Marks the pixel dirty only
+// if the colour actually changed.
+void LedDriver_set(uint8_t i, uint8_t r, uint8_t g, uint8_t b);
+
+// Start async transfers for dirty pixels whose previous transfer has finished.
+// Pixels still busy stay dirty and go out on the next push.
+void LedDriver_push();
@@ -0,0 +1,194 @@
+#include "LedFx.h"
+#include <esp_timer.h>
+#include <math.h>
+
+#include "ConfigSide.h"
+#include "LedDriver.h"
+#include "Meter.h"
+#include "Trace.h"
+
+enum FxMode : uint8_t { FX_SOLID = 0, FX_BLINK = 1, FX_PROGRESS = 2, FX_METER = 3 };
+
+struct FxState {
+  FxMode   mode = FX_SOLID;
+  uint8_t  solid[kLedCount][3] = {};
+
+  // FX_BLINK
+  uint8_t  color     = LED_RED;
+  bool     phaseOn   = false;
+  uint8_t  remaining = 0;     // on->off transitions left
+  uint16_t on_ms     = 0;
+  uint16_t off_ms    = 0;
+  uint32_t nextMs    = 0;
+  bool     traceStart = false;
+
+  // FX_PROGRESS
+  uint8_t  pct = 0;
+};
+
+static FxState            s_fx;
+static portMUX_TYPE       s_fxMux = portMUX_INITIALIZER_UNLOCKED;
+static esp_timer_handle_t s_timer = nullptr;
+
+// Meter envelope state, only touched by fxTick()
+static float s_env[kLedCount]   = {0,0,0,0};
+static float s_envRelease       = 0.0f;   // per-tick decay factor
+
+// Level (0..32767) -> 0..1 on a dB scale from METER_FLOOR_DB to 0 dBFS
+static inline float meterNorm(uint16_t level) {
+  if (level == 0) return 0.0f;
+  float db = 20.0f * log10f((float)level / 32768.0f);
+  float x = 1.0f - db / (float)METER_FLOOR_DB;
+  return (x < 0.0f) ? 0.0f : (x > 1.0f ? 1.0f : x);
+}
+
+static void renderMeter(uint8_t frame[kLedCount][3]) {
+  static constexpr uint32_t lo = METER_COLOR_LO, hi = METER_COLOR_HI;
+  for (uint8_t i = 0; i < kLedCount; i++) {
+    uint16_t peak, rms;
+    Meter_read(i, &peak, &rms);
+    float x = meterNorm(METER_USE_PEAK ? peak : rms);
+    s_env[i] = (x > s_env[i]) ? x : s_env[i] * s_envRelease;
+    const uint16_t t = (uint16_t)(s_env[i] * 256.0f);
+    for (uint8_t c = 0; c < 3; c++) {
+      const int32_t a = (lo >> (16 - 8*c)) & 0xFF;
+      const int32_t b = (hi >> (16 - 8*c)) & 0xFF;
+      frame[i][c] = (uint8_t)(a + (((b - a) * (int32_t)t) >> 8));
+    }
+  }
+}
+
+static inline void blinkRgb(uint8_t color, uint8_t rgb[3]) {
+  rgb[0] = (color==LED_RED   || color==LED_WHITE) ? 255 : 0;
+  rgb[1] = (color==LED_GREEN || color==LED_WHITE) ? 255 : 0;
+  rgb[2] = (color==LED_WHITE) ? 255 : 0;
+}
+
+// Runs in the esp_timer task. Advances the effect under the lock, then pushes
+// outside it.
+static void fxTick(void*) {
+  uint8_t frame[kLedCount][3];
+  bool traceBlink = false;
+  uint8_t traceColor = 0;
+  uint16_t traceOn = 0;
+  const uint32_t now = millis();
+
+  portENTER_CRITICAL(&s_fxMux);
+  switch (s_fx.mode) {
+    case FX_BLINK:
+      if ((int32_t)(now - s_fx.nextMs) >= 0) {
+        if (s_fx.phaseOn) {
+          s_fx.phaseOn = false;
+          s_fx.nextMs  = now + s_fx.off_ms;
+          if (s_fx.remaining && --s_fx.remaining == 0) {
+            s_fx.mode = FX_SOLID;
+            memset(s_fx.solid, 0, sizeof(s_fx.solid));
+          }
+        } else {
+          s_fx.phaseOn = true;
+          s_fx.nextMs  = now + s_fx.on_ms;
+        }
+      }
+      if (s_fx.mode == FX_BLINK) {
+        uint8_t rgb[3] = {0,0,0};
+        if (s_fx.phaseOn) blinkRgb(s_fx.color, rgb);
+        for (uint8_t i = 0; i < kLedCount; i++) memcpy(frame[i], rgb, 3);
+      } else {
+        memcpy(frame, s_fx.solid, sizeof(frame));
+      }
+      if (s_fx.traceStart) {
+        s_fx.traceStart = false;
+        traceBlink = true;
+        traceColor = s_fx.color;
+        traceOn    = s_fx.on_ms;
+      }
+      break;
+
+    case FX_PROGRESS: {
+      const uint8_t pct  = s_fx.pct;
+      const uint8_t full = (pct >= 100) ? kLedCount : (uint8_t)(pct / 25);
+      const uint8_t part = (pct >= 100) ? 0 : (uint8_t)((pct % 25) * 255 / 25);
+      for (uint8_t i = 0; i < kLedCount; i++) {
+        const uint8_t v = (i < full) ? 255 : (i == full ? part : 0);
+        frame[i][0] = 0; frame[i][1] = v; frame[i][2] = v;   // cyan
+      }
+    } break;
+
+    case FX_METER:
+      break;   // rendered below, outside the lock
+
+    case FX_SOLID:
+    default:
+      memcpy(frame, s_fx.solid, sizeof(frame));
+      break;
+  }
+  const bool meter = (s_fx.mode == FX_METER);
+  portEXIT_CRITICAL(&s_fxMux);
+
+  if (meter) renderMeter(frame);
+  for (uint8_t i = 0; i < kLedCount; i++) LedDriver_set(i, frame[i][0], frame[i][1], frame[i][2]);
+  LedDriver_push();
+  if (traceBlink) Trace_rec(TR_BLINK_START, traceColor, traceOn);
+}
+
+void LedFx_begin() {
+  const uint8_t pins[kLedCount] = { RGB1_PIN, RGB2_PIN, RGB3_PIN, RGB4_PIN };
+  LedDriver_begin(pins, BRIGHTNESS);
+  s_envRelease = expf(-(float)LED_TICK_MS / (float)METER_RELEASE_MS);
+
+  esp_timer_create_args_t args = {};
+  args.callback = &fxTick;
+  args.dispatch_method = ESP_TIMER_TASK;
+  args.name = "ledfx";
+  if (esp_timer_create(&args, &s_timer) != ESP_OK ||
+      esp_timer_start_periodic(s_timer, (uint64_t)LED_TICK_MS * 1000ULL) != ESP_OK) {
+    Serial.println("[LED] effect timer start FAIL");
+  }
+}
+
+void LedFx_setPixel(uint8_t i, uint8_t r, uint8_t g, uint8_t b) {
+  if (i >= kLedCount) return;
+  portENTER_CRITICAL(&s_fxMux);
+  if (s_fx.mode != FX_SOLID) {
+    // Leaving an effect: start from dark, like blinkStop() used to
+    memset(s_fx.solid, 0, sizeof(s_fx.solid));
+    s_fx.mode = FX_SOLID;
+  }
+  s_fx.solid[i][0] = r; s_fx.solid[i][1] = g; s_fx.solid[i][2] = b;
+  portEXIT_CRITICAL(&s_fxMux);
+}
+
+void LedFx_setAll(uint8_t r, uint8_t g, uint8_t b) {
+  portENTER_CRITICAL(&s_fxMux);
+  s_fx.mode = FX_SOLID;
+  for (uint8_t i = 0; i < kLedCount; i++) {
+    s_fx.solid[i][0] = r; s_fx.solid[i][1] = g; s_fx.solid[i][2] = b;
+  }
+  portEXIT_CRITICAL(&s_fxMux);
+}
+
+void LedFx_blink(uint8_t color, uint16_t on_ms, uint16_t off_ms, uint8_t reps) {
+  portENTER_CRITICAL(&s_fxMux);
+  s_fx.mode       = FX_BLINK;
+  s_fx.color      = color;
+  s_fx.on_ms      = on_ms;
+  s_fx.off_ms     = off_ms;
+  s_fx.remaining  = reps;
+  s_fx.phaseOn    = true;
+  s_fx.nextMs     = millis() + on_ms;
+  s_fx.traceStart = true;
+  portEXIT_CRITICAL(&s_fxMux);
+}
+
+void LedFx_meter() {
+  portENTER_CRITICAL(&s_fxMux);
+  s_fx.mode = FX_METER;
+  portEXIT_CRITICAL(&s_fxMux);
+}
+
+void LedFx_progress(uint8_t pct) {
+  portENTER_CRITICAL(&s_fxMux);
+  s_fx.mode = FX_PROGRESS;
+  s_fx.pct  = (pct > 100) ? 100 : pct;
+  portEXIT_CRITICAL(&s_fxMux);
+}
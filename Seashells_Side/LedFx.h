@@ -0,0 +1,29 @@
+#pragma once
+#include <Arduino.h>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// LED effect engine. An esp_timer fires every LED_TICK_MS, advances the active
+// effect (blink / OTA progress / level meter) and pushes changed pixels through LedDriver.
+//
+// All public calls only update state under a short spinlock, so they are cheap
+// enough for the audio loop and GameBus_pump(); nothing here touches the wire.
+// ─────────────────────────────────────────────────────────────────────────────
+
+// Blink colours as sent by the master in BLINK_ALL
+enum LedColor : uint8_t { LED_RED = 0, LED_GREEN = 1, LED_WHITE = 2 };
+
+void LedFx_begin();
+
+// Solid colours (cancel any running blink/progress effect)
+void LedFx_setPixel(uint8_t i, uint8_t r, uint8_t g, uint8_t b);
+void LedFx_setAll(uint8_t r, uint8_t g, uint8_t b);
+
+// Blink all four pixels; the LEDs end up off after the last repetition
+void LedFx_blink(uint8_t color, uint16_t on_ms, uint16_t off_ms, uint8_t reps);
+
+// OTA progress bar (0..100%) in cyan; the pixel in progress fades in
+void LedFx_progress(uint8_t pct);
+
+// Each pixel follows its slot's level (Meter.h) through a release envelope,
+// mapped from METER_COLOR_LO to METER_COLOR_HI
+void LedFx_meter();
@@ -1,107 +1,226 @@
 #include "Manifest.h"
 #include <SD.h>
-
-// External audio helper used for precache
-extern bool loadWavIntoRam(const char* path, const char* tag, int16_t** outBuf, size_t* outSamples);
-
-// Catalog of all clips
+#include "AudioEngine.h"
+#include "ClipAnalysis.h"
+#include "ConfigSide.h"
+#include "Soundbank.h"
+#include "SdBus.h"
+#include <algorithm>
+#include <new>
+
+// Catalog of all clips. A block holds the entries and the arena their strings
+// live in; two are allocated once (PSRAM when present), the live one and a
+// spare that a reload parses into, and Manifest_applyReload() swaps them.
+// Nothing is allocated per clip or per reload.
 static const size_t MAX_CLIPS = 512;
-static ClipMeta catalog[MAX_CLIPS];
-static size_t   catalogCount = 0;
+struct CatalogBlock {
+  ClipMeta clips[MAX_CLIPS];
+  size_t   used = 0;                          // arena bytes taken
+  char     strings[MANIFEST_ARENA_BYTES];
+};
+static CatalogBlock* s_blocks[2] = { nullptr, nullptr };
+static uint8_t       s_live = 0;
+static ClipMeta*     catalog = nullptr;       // s_blocks[s_live]->clips once loaded
+static size_t        catalogCount = 0;
 
 // Simple precache cache (best-effort)
 struct CacheEntry {
   uint16_t id;
   int16_t* data;
   size_t   samples;
+  uint32_t loopStart;
+  uint32_t loopEnd;
+  uint16_t xfade;      // loop crossfade samples, stored at data[samples..]
 };
 
-static CacheEntry cache[64];
+static const size_t CACHE_MAX = 64;
+static CacheEntry cache[CACHE_MAX];
 static size_t     cacheCount = 0;
 
+// The boot precache runs in its own task and appends to cache[] while the
+// loop reads it: an entry is written before the count that publishes it, both
+// under s_cacheMux, and readers take the count under the same lock.
+static portMUX_TYPE   s_cacheMux = portMUX_INITIALIZER_UNLOCKED;
+static volatile bool  s_warming = false;
+static volatile uint16_t s_warmDone = 0, s_warmTotal = 0;
+static uint16_t       s_hint[4] = {0, 0, 0, 0};   // current scene, warmed first
+static uint8_t        s_tried[MAX_CLIPS / 8];
+
+static size_t liveCacheCount() {
+  portENTER_CRITICAL(&s_cacheMux);
+  const size_t n = cacheCount;
+  portEXIT_CRITICAL(&s_cacheMux);
+  return n;
+}
+
+// Staged by Manifest_reload, swapped in by Manifest_applyReload
+static ClipMeta*  staged = nullptr;
+static size_t     stagedCount = 0;
+static CacheEntry stagedCache[CACHE_MAX];
+static size_t     stagedCacheCount = 0;
+static int16_t*   evicted[CACHE_MAX];      // current buffers the staged cache drops
+static size_t     evictedCount = 0;
+static uint16_t   s_toLoad[CACHE_MAX];     // staged[] rows the reload task reads from SD
+static size_t     s_toLoadCount = 0;
+static volatile bool s_reloadLoading = false;
+
 // ───────────────── Manifest loading ─────────────────
 
-bool Manifest_load() {
+static CatalogBlock* allocBlock() {
+  void* p = ps_malloc(sizeof(CatalogBlock));
+  if (!p) p = malloc(sizeof(CatalogBlock));
+  return p ? new (p) CatalogBlock : nullptr;
+}
+
+// One line into buf (NUL-terminated, CR dropped); a longer line is cut at
+// cap-1 and its rest skipped. False at end of file.
+static bool readLine(File& f, char* buf, size_t cap) {
+  size_t n = 0;
+  bool any = false;
+  int c;
+  while ((c = f.read()) >= 0) {
+    any = true;
+    if (c == '\n') break;
+    if (c != '\r' && n + 1 < cap) buf[n++] = (char)c;
+  }
+  buf[n] = 0;
+  return any;
+}
+
+// Copy s[0, len), whitespace-trimmed, into the block's arena. Category
+// strings repeat from row to row, so a match with prev is shared instead.
+// nullptr when the arena is full.
+static const char* arenaStr(CatalogBlock* b, const char* s, size_t len, const char* prev) {
+  while (len && isspace((unsigned char)*s)) { s++; len--; }
+  while (len && isspace((unsigned char)s[len - 1])) len--;
+  if (!len) return "";
+  if (prev && !strncmp(prev, s, len) && !prev[len]) return prev;
+  if (b->used + len + 1 > sizeof(b->strings)) return nullptr;
+  char* out = b->strings + b->used;
+  memcpy(out, s, len);
+  out[len] = 0;
+  b->used += len + 1;
+  return out;
+}
+
+// [a, e) is a non-empty run of digits, give or take surrounding spaces
+static bool isUint(const char* a, const char* e) {
+  while (a < e && isspace((unsigned char)*a)) a++;
+  while (e > a && isspace((unsigned char)e[-1])) e--;
+  if (a == e) return false;
+  for (; a < e; a++) if (!isdigit((unsigned char)*a)) return false;
+  return true;
+}
+
+// Last ',' in [a, e), or nullptr
+static const char* lastComma(const char* a, const char* e) {
+  while (e > a) if (*--e == ',') return e;
+  return nullptr;
+}
+
+// Parse /manifest.csv into b; returns the clip count, -1 if the file is missing
+static int parseManifest(CatalogBlock* b) {
   File f = SD.open("/manifest.csv", FILE_READ);
   if (!f) {
     Serial.println("[MANIFEST] missing /manifest.csv");
-    catalogCount = 0;
-    return false;
+    return -1;
   }
 
-  catalogCount = 0;
-  String line;
+  size_t count = 0, dropped = 0;
+  char line[MANIFEST_LINE_MAX];
+  b->used = 0;
 
-  while (f.available()) {
-    line = f.readStringUntil('\n');
-    line.trim();
-    if (!line.length()) continue;
+  while (readLine(f, line, sizeof(line))) {
+    const char* s = line;
+    while (isspace((unsigned char)*s)) s++;
+    if (!*s) continue;
 
     // Skip comments
-    if (line[0] == '#') continue;
+    if (s[0] == '#') continue;
 
     // Skip header line if present
-    if (line.startsWith("id,")) continue;
+    if (!strncmp(s, "id,", 3)) continue;
 
     // Skip separator/blank rows like ',,,,,,,,' (ID must start with a digit)
-    if (!isDigit(line[0])) continue;
+    if (!isDigit(s[0])) continue;
 
     // Expected format:
-    // id,pool,path,precache,volume_db,base,sub,sub2,tags
-    int c1 = line.indexOf(',');              if (c1 < 0) continue;
-    int c2 = line.indexOf(',', c1 + 1);      if (c2 < 0) continue;
-    int c3 = line.indexOf(',', c2 + 1);      if (c3 < 0) continue;
-    int c4 = line.indexOf(',', c3 + 1);      if (c4 < 0) continue;
-    int c5 = line.indexOf(',', c4 + 1);      if (c5 < 0) continue;
-    int c6 = line.indexOf(',', c5 + 1);      if (c6 < 0) continue;
-    int c7 = line.indexOf(',', c6 + 1);      if (c7 < 0) continue;
-    int c8 = line.indexOf(',', c7 + 1);      if (c8 < 0) continue;
+    // id,pool,path,precache,volume_db,base,sub,sub2,tags[,trim_start,trim_end]
+    // fld[k] starts field k; the tags run to the end of the line, commas and all.
+    const char* fld[9];
+    int nf = 1;
+    fld[0] = s;
+    for (const char* p = s; *p && nf < 9; p++) if (*p == ',') fld[nf++] = p + 1;
+    if (nf < 9) continue;
+    const char* eol = s + strlen(s);
+    auto flen = [&](int k) { return (size_t)((k + 1 < nf ? fld[k + 1] - 1 : eol) - fld[k]); };
 
     ClipMeta m{};
+    const ClipMeta* prev = count ? &b->clips[count - 1] : nullptr;
 
     // Field 0: id
-    m.id = (uint16_t)line.substring(0, c1).toInt();
+    m.id = (uint16_t)atoi(fld[0]);
+
+    // Reserve ID=0 as "no clip" (used to clear slots)
+    if (m.id == 0 || count >= MAX_CLIPS) continue;
 
     // Field 1: pool (A/B)
-    char poolCh = line.substring(c1 + 1, c2).charAt(0);
+    char poolCh = fld[1][0];
     m.pool = (poolCh == 'B' || poolCh == 'b') ? POOL_B : POOL_A;
 
-    // Field 2: path
-    m.path = line.substring(c2 + 1, c3);
-    m.path.trim();
-
     // Field 3: precache (0/1)
-    m.precache = (line.substring(c3 + 1, c4).toInt() != 0);
+    m.precache = (atoi(fld[3]) != 0);
 
     // Field 4: volume_db
-    m.volume_db = (int8_t)line.substring(c4 + 1, c5).toInt();
-
-    // Field 5: base
-    m.base = line.substring(c5 + 1, c6);
-    m.base.trim();
-
-    // Field 6: sub
-    m.sub = line.substring(c6 + 1, c7);
-    m.sub.trim();
-
-    // Field 7: sub2
-    m.sub2 = line.substring(c7 + 1, c8);
-    m.sub2.trim();
-
-    // Field 8: tags
-    m.tags = line.substring(c8 + 1);
-    m.tags.trim();
+    m.volume_db = (int8_t)atoi(fld[4]);
+
+    // Field 8: tags, optionally followed by trim_start,trim_end in samples
+    // (tools/clip_trim.py). Trim is read only when the line's last two fields
+    // are both plain numbers; anything else belongs to the tags.
+    size_t tagsLen = (size_t)(eol - fld[8]);
+    const char* c2 = lastComma(fld[8], eol);
+    const char* c1 = c2 ? lastComma(fld[8], c2) : nullptr;
+    if (c1 && isUint(c1 + 1, c2) && isUint(c2 + 1, eol)) {
+      tagsLen     = (size_t)(c1 - fld[8]);
+      m.trimStart = (uint32_t)strtoul(c1 + 1, nullptr, 10);
+      m.trimEnd   = (uint32_t)strtoul(c2 + 1, nullptr, 10);
+    }
 
-    // Reserve ID=0 as "no clip" (used to clear slots)
-    if (m.id == 0) continue;
+    // Fields 2, 5-8: path, base, sub, sub2, tags
+    m.path = arenaStr(b, fld[2], flen(2), nullptr);
+    m.base = arenaStr(b, fld[5], flen(5), prev ? prev->base : nullptr);
+    m.sub  = arenaStr(b, fld[6], flen(6), prev ? prev->sub  : nullptr);
+    m.sub2 = arenaStr(b, fld[7], flen(7), prev ? prev->sub2 : nullptr);
+    m.tags = arenaStr(b, fld[8], tagsLen, prev ? prev->tags : nullptr);
+    if (!m.path || !m.base || !m.sub || !m.sub2 || !m.tags) { dropped++; continue; }
 
-    if (catalogCount < MAX_CLIPS) {
-      catalog[catalogCount++] = m;
-    }
+    b->clips[count++] = m;
   }
 
   f.close();
-  Serial.printf("[MANIFEST] loaded %u clips\n", (unsigned)catalogCount);
+  if (dropped) {
+    Serial.printf("[MANIFEST] string arena full (%u bytes): %u clips dropped, raise MANIFEST_ARENA_BYTES\n",
+                  (unsigned)sizeof(b->strings), (unsigned)dropped);
+  }
+  return (int)count;
+}
+
+bool Manifest_load() {
+  for (CatalogBlock*& b : s_blocks) {
+    if (!b) b = allocBlock();
+  }
+  if (!s_blocks[0] || !s_blocks[1]) {
+    Serial.println("[MANIFEST] no memory for the catalog");
+    return false;
+  }
+  CatalogBlock* b = s_blocks[s_live];
+  const int n = parseManifest(b);
+  catalog = b->clips;
+  catalogCount = (n > 0) ? (size_t)n : 0;
+  if (n >= 0) {
+    Serial.printf("[MANIFEST] loaded %u clips, %u/%u string bytes\n", (unsigned)catalogCount,
+                  (unsigned)b->used, (unsigned)sizeof(b->strings));
+  }
   return (catalogCount > 0);
 }
 
@@ -142,7 +261,7 @@ uint8_t Manifest_pickRandom(Pool pool, uint8_t need, uint16_t* out, uint8_t maxO
 }
 
 // NEW: pick by base == given base
-uint8_t Manifest_pickRandomByBase(const String& base, uint8_t need, uint16_t* out, uint8_t maxOut) {
+uint8_t Manifest_pickRandomByBase(const char* base, uint8_t need, uint16_t* out, uint8_t maxOut) {
   if (!need || maxOut == 0 || catalogCount == 0) return 0;
 
   uint8_t n = 0;
@@ -153,7 +272,7 @@ uint8_t Manifest_pickRandomByBase(const String& base, uint8_t need, uint16_t* ou
     size_t idx = random(catalogCount);
     const ClipMeta& m = catalog[idx];
 
-    if (!m.base.equalsIgnoreCase(base)) continue;
+    if (strcasecmp(m.base, base)) continue;
 
     uint16_t id = m.id;
     bool dup = false;
@@ -169,7 +288,7 @@ uint8_t Manifest_pickRandomByBase(const String& base, uint8_t need, uint16_t* ou
 }
 
 // NEW: pick by base != forbiddenBase
-uint8_t Manifest_pickRandomByBaseNot(const String& forbiddenBase, uint8_t need, uint16_t* out, uint8_t maxOut) {
+uint8_t Manifest_pickRandomByBaseNot(const char* forbiddenBase, uint8_t need, uint16_t* out, uint8_t maxOut) {
   if (!need || maxOut == 0 || catalogCount == 0) return 0;
 
   uint8_t n = 0;
@@ -180,7 +299,7 @@ uint8_t Manifest_pickRandomByBaseNot(const String& forbiddenBase, uint8_t need,
     size_t idx = random(catalogCount);
     const ClipMeta& m = catalog[idx];
 
-    if (m.base.equalsIgnoreCase(forbiddenBase)) continue;
+    if (!strcasecmp(m.base, forbiddenBase)) continue;
 
     uint16_t id = m.id;
     bool dup = false;
@@ -197,34 +316,384 @@ uint8_t Manifest_pickRandomByBaseNot(const String& forbiddenBase, uint8_t need,
 
 // ───────────────── Precache support ─────────────────
 
-void Manifest_precacheAll() {
-  cacheCount = 0;
-  for (size_t i = 0; i < catalogCount && cacheCount < (sizeof(cache)/sizeof(cache[0])); i++) {
-    const ClipMeta& m = catalog[i];
-    if (!m.precache) continue;
-    if (!m.path.length()) continue;
+struct PrecacheStats {
+  size_t   baked = 0;
+  size_t   trimmedBytes = 0;
+  uint32_t onsetSamples = 0;
+};
+
+// Load a clip into a PSRAM cache entry (trimmed, loop baked; m gets the trim and
+// loop points). bg: called from the precache task without the SD bus, which is
+// then taken chunk by chunk; otherwise the caller holds it.
+static bool precacheOne(ClipMeta& m, CacheEntry& e, PrecacheStats& st, bool bg) {
+  int16_t* buf = nullptr;
+  size_t   samples = 0;
+
+  char tag[12];
+  snprintf(tag, sizeof(tag), "ID%u", (unsigned)m.id);
+
+  const bool loaded = bg ? loadWavIntoRamBackground(m.path, tag, &buf, &samples)
+                         : loadWavIntoRam(m.path, tag, &buf, &samples);
+  if (!loaded) return false;
+  size_t capSamples = samples;   // the block holds exactly the data chunk
+  if (TRIM_ENABLE) {
+    const size_t before = samples;
+    uint32_t ts = m.trimStart, te = m.trimEnd;
+    if (ClipAnalysis_trim(&buf, &samples, &ts, &te, /*shrink=*/false)) {
+      st.trimmedBytes += (before - samples) * 2;
+      st.onsetSamples += ts;
+      Serial.printf("[TRIM] %s: onset -%.1f ms, tail -%.1f ms, saved %u bytes\n", tag,
+                    ts * 1000.0 / SAMPLE_RATE, (before - te) * 1000.0 / SAMPLE_RATE,
+                    (unsigned)((before - samples) * 2));
+    }
+    m.trimStart = ts;
+    m.trimEnd   = te;
+  }
 
-    int16_t* buf = nullptr;
-    size_t   samples = 0;
+  // One realloc sizes the block to the clip plus its loop crossfade
+  const size_t want = samples + LOOP_XFADE_SAMPLES;
+  if (int16_t* p = (int16_t*)ps_realloc(buf, want * 2)) { buf = p; capSamples = want; }
+
+  uint32_t ls = 0, le = 0;
+  uint16_t xf = 0;
+  if (capSamples >= want && ClipAnalysis_bakeLoop(buf, samples, buf + samples, &ls, &le, &xf)) st.baked++;
+  m.loopStart = ls;
+  m.loopEnd   = le;
+
+  e.id        = m.id;
+  e.data      = buf;
+  e.samples   = samples;
+  e.loopStart = ls;
+  e.loopEnd   = le;
+  e.xfade     = xf;
+  return true;
+}
 
-    String tag = "ID" + String(m.id);
+static bool wantsPrecache(const ClipMeta& m) {
+  // Soundbank clips play from mapped flash, no PSRAM needed
+  return m.precache && m.path[0] && !Soundbank_has(m.id);
+}
 
-    if (loadWavIntoRam(m.path.c_str(), tag.c_str(), &buf, &samples)) {
-      cache[cacheCount].id      = m.id;
-      cache[cacheCount].data    = buf;
-      cache[cacheCount].samples = samples;
+static bool tried(size_t i) { return s_tried[i / 8] & (1u << (i % 8)); }
+
+// Next clip to warm: the current scene's first, then manifest order
+static int nextWarmIndex() {
+  uint16_t hint[4];
+  portENTER_CRITICAL(&s_cacheMux);
+  memcpy(hint, s_hint, sizeof(hint));
+  portEXIT_CRITICAL(&s_cacheMux);
+  for (int k = 0; k < 4; k++) {
+    if (!hint[k]) continue;
+    for (size_t i = 0; i < catalogCount; i++) {
+      if (catalog[i].id == hint[k] && !tried(i) && wantsPrecache(catalog[i])) return (int)i;
+    }
+  }
+  for (size_t i = 0; i < catalogCount; i++) {
+    if (!tried(i) && wantsPrecache(catalog[i])) return (int)i;
+  }
+  return -1;
+}
+
+// Reads take the SD bus per chunk, so scene changes and streaming slots get it
+// in between (a streaming slot waits out a chunk instead of going silent)
+static void warmTask(void*) {
+  const uint32_t t0 = millis();
+  PrecacheStats st;
+  int i;
+  while (cacheCount < CACHE_MAX && (i = nextWarmIndex()) >= 0) {
+    s_tried[i / 8] |= (uint8_t)(1u << (i % 8));
+    CacheEntry e;
+    if (precacheOne(catalog[i], e, st, /*bg=*/true)) {
+      portENTER_CRITICAL(&s_cacheMux);
+      cache[cacheCount] = e;
       cacheCount++;
+      portEXIT_CRITICAL(&s_cacheMux);
+    }
+    s_warmDone = s_warmDone + 1;
+  }
+
+  Serial.printf("[MANIFEST] precached %u clips (%u with baked loops) in %lu ms\n",
+                (unsigned)cacheCount, (unsigned)st.baked, (unsigned long)(millis() - t0));
+  if (TRIM_ENABLE) {
+    Serial.printf("[TRIM] total saved %u bytes, onset removed %.1f ms (avg %.1f ms/clip)\n",
+                  (unsigned)st.trimmedBytes, st.onsetSamples * 1000.0 / SAMPLE_RATE,
+                  cacheCount ? st.onsetSamples * 1000.0 / SAMPLE_RATE / cacheCount : 0.0);
+  }
+  s_warming = false;
+  vTaskDelete(nullptr);
+}
+
+void Manifest_precacheStart() {
+  if (s_warming) return;
+  cacheCount = 0;
+  memset(s_tried, 0, sizeof(s_tried));
+  size_t total = 0;
+  for (size_t i = 0; i < catalogCount; i++) if (wantsPrecache(catalog[i])) total++;
+  s_warmTotal = (uint16_t)std::min(total, CACHE_MAX);
+  s_warmDone  = 0;
+  if (!total) return;
+
+  s_warming = true;
+  if (xTaskCreatePinnedToCore(warmTask, "precache", PRECACHE_TASK_STACK, nullptr, 1, nullptr,
+                              PRECACHE_TASK_CORE) != pdPASS) {
+    Serial.println("[MANIFEST] precache task failed to start; clips stream from SD");
+    s_warming = false;
+  }
+}
+
+bool Manifest_warming() {
+  return s_warming;
+}
+
+uint8_t Manifest_warmPercent() {
+  if (!s_warming) return 100;
+  const uint16_t total = s_warmTotal;
+  return total ? (uint8_t)std::min<uint32_t>(99, s_warmDone * 100u / total) : 0;
+}
+
+void Manifest_precacheHint(const uint16_t ids[4]) {
+  portENTER_CRITICAL(&s_cacheMux);
+  memcpy(s_hint, ids, sizeof(s_hint));
+  portEXIT_CRITICAL(&s_cacheMux);
+}
+
+static bool pathListed(const char* path, const char* const* paths, size_t n) {
+  for (size_t p = 0; p < n; p++) if (!strcmp(path, paths[p])) return true;
+  return false;
+}
+
+// Only between scenes: channels must not point into the entries replaced here
+void Manifest_refreshPaths(const char* const* paths, size_t n) {
+  if (s_warming) {
+    Serial.println("[MANIFEST] still precaching, cache refresh skipped");
+    return;
+  }
+  // Any trim was measured on the old audio, whether the clip is cached,
+  // streamed or packed: cached clips are re-analysed below, the rest stream
+  // whole until the manifest carries new trim columns
+  for (size_t i = 0; i < catalogCount; i++) {
+    if (pathListed(catalog[i].path, paths, n)) catalog[i].trimStart = catalog[i].trimEnd = 0;
+  }
+
+  PrecacheStats st;
+  size_t reloaded = 0;
+  for (size_t k = 0; k < cacheCount; ) {
+    size_t i = 0;
+    while (i < catalogCount && catalog[i].id != cache[k].id) i++;
+    bool changed = false;
+    for (size_t p = 0; i < catalogCount && p < n && !changed; p++) changed = !strcmp(catalog[i].path, paths[p]);
+    if (!changed) { k++; continue; }
+
+    free(cache[k].data);
+    if (precacheOne(catalog[i], cache[k], st, /*bg=*/false)) { reloaded++; k++; continue; }
+    cache[k] = cache[--cacheCount];                   // unreadable now: streams from SD (or fails) instead
+  }
+
+  // Soundbank copies of rewritten files are stale: mask them, and cache the
+  // precache ones from the new file instead
+  for (size_t i = 0; i < catalogCount; i++) {
+    if (!Soundbank_has(catalog[i].id) || !pathListed(catalog[i].path, paths, n)) continue;
+    Soundbank_mask(catalog[i].id);
+    if (!wantsPrecache(catalog[i]) || cacheCount >= CACHE_MAX) continue;
+    if (precacheOne(catalog[i], cache[cacheCount], st, /*bg=*/false)) { cacheCount++; reloaded++; }
+  }
+  Serial.printf("[MANIFEST] refreshed %u cached clip(s) from %u changed file(s)\n",
+                (unsigned)reloaded, (unsigned)n);
+}
+
+// ───────────────── Hot reload ─────────────────
+
+static const ClipMeta* findIn(const ClipMeta* list, size_t n, uint16_t id) {
+  for (size_t i = 0; i < n; i++) if (list[i].id == id) return &list[i];
+  return nullptr;
+}
+
+static const CacheEntry* cachedEntry(uint16_t id) {
+  const size_t n = liveCacheCount();
+  for (size_t k = 0; k < n; k++) if (cache[k].id == id) return &cache[k];
+  return nullptr;
+}
+
+// Drop a staged reload: free what it loaded, keep what it shared with the live cache
+static void discardStaged() {
+  for (size_t k = 0; k < stagedCacheCount; k++) {
+    const CacheEntry* live = cachedEntry(stagedCache[k].id);
+    if (!live || live->data != stagedCache[k].data) free(stagedCache[k].data);
+  }
+  staged = nullptr;
+  stagedCount = stagedCacheCount = evictedCount = 0;
+}
+
+// Reads a staged reload's new and changed clips chunk by chunk, like the warm
+// task, so a reload never blocks the render loop on SD. The reload is pending
+// (ready to swap) once this finishes.
+static void reloadTask(void*) {
+  const uint32_t tLoad = millis();
+  PrecacheStats st;
+  size_t loaded = 0;
+  for (size_t j = 0; j < s_toLoadCount && stagedCacheCount < CACHE_MAX; j++) {
+    if (precacheOne(staged[s_toLoad[j]], stagedCache[stagedCacheCount], st, /*bg=*/true)) {
+      stagedCacheCount++;
+      loaded++;
     }
-    yield();
   }
-  Serial.printf("[MANIFEST] precached %u clips\n", (unsigned)cacheCount);
+  Serial.printf("[MANIFEST] reload: %u of %u clip(s) loaded in %lu ms, ready to swap\n",
+                (unsigned)loaded, (unsigned)s_toLoadCount, (unsigned long)(millis() - tLoad));
+  portENTER_CRITICAL(&s_cacheMux);
+  s_reloadLoading = false;
+  portEXIT_CRITICAL(&s_cacheMux);
+  vTaskDelete(nullptr);
+}
+
+bool Manifest_reloadLoading() {
+  portENTER_CRITICAL(&s_cacheMux);
+  const bool loading = s_reloadLoading;
+  portEXIT_CRITICAL(&s_cacheMux);
+  return loading;
+}
+
+bool Manifest_reload(const char* const* changedPaths, size_t nChanged) {
+  const uint32_t t0 = millis();
+  if (s_warming) {
+    Serial.println("[MANIFEST] still precaching, reload refused; try again once warm");
+    return false;
+  }
+  if (Manifest_reloadLoading()) {
+    Serial.println("[MANIFEST] previous reload still loading, refused; try again shortly");
+    return false;
+  }
+  if (staged) discardStaged();   // a newer request supersedes one not yet applied
+
+  CatalogBlock* spare = s_blocks[s_live ^ 1];
+  if (!spare) {
+    Serial.println("[MANIFEST] reload: no staging catalog (manifest never loaded)");
+    return false;
+  }
+  staged = spare->clips;
+  SdBus_lock();
+  const int n = parseManifest(spare);
+  SdBus_unlock();
+  if (n <= 0) {
+    Serial.println("[MANIFEST] reload: no clips parsed, keeping the current catalog");
+    discardStaged();
+    return false;
+  }
+  stagedCount = (size_t)n;
+
+  // Diff by ID. Only a new path, a rewritten file, edited trim columns or a
+  // precache flip touches the cache; a volume change is metadata only
+  // (applied at the next scene).
+  size_t added = 0, changed = 0, removed = 0, kept = 0;
+  s_toLoadCount = 0;
+  for (size_t i = 0; i < stagedCount; i++) {
+    ClipMeta& m = staged[i];
+    const ClipMeta* old = catalog ? findIn(catalog, catalogCount, m.id) : nullptr;
+    const bool rewritten = pathListed(m.path, changedPaths, nChanged);
+    const bool hasTrim = m.trimStart || m.trimEnd;   // 0/0: no trim columns
+    const bool trimEdited = old && hasTrim && (old->trimStart != m.trimStart || old->trimEnd != m.trimEnd);
+    if (!old) added++;
+    else if (strcmp(old->path, m.path) || old->volume_db != m.volume_db ||
+             old->precache != m.precache || rewritten || trimEdited) changed++;
+
+    // A packed copy of other audio than the manifest now names is stale
+    if ((rewritten || (old && strcmp(old->path, m.path))) && Soundbank_has(m.id)) Soundbank_mask(m.id);
+
+    if (!wantsPrecache(m)) continue;
+    if (stagedCacheCount + s_toLoadCount >= CACHE_MAX) continue;
+
+    const CacheEntry* live = cachedEntry(m.id);
+    if (live && old && !strcmp(old->path, m.path) && !rewritten && !trimEdited) {
+      // Same audio and trim: keep the PSRAM copy and the points analysed for it
+      // (the trim too when the manifest leaves it to analysis)
+      if (!hasTrim) { m.trimStart = old->trimStart;  m.trimEnd = old->trimEnd; }
+      m.loopStart = old->loopStart;  m.loopEnd = old->loopEnd;
+      stagedCache[stagedCacheCount++] = *live;
+      kept++;
+      continue;
+    }
+    s_toLoad[s_toLoadCount++] = (uint16_t)i;
+  }
+  for (size_t i = 0; i < catalogCount; i++) {
+    if (!findIn(staged, stagedCount, catalog[i].id)) removed++;
+  }
+
+  Serial.printf("[MANIFEST] reload: %u clips, %u touched (%u new, %u changed, %u removed)\n",
+                (unsigned)stagedCount, (unsigned)(added + changed + removed),
+                (unsigned)added, (unsigned)changed, (unsigned)removed);
+  Serial.printf("[MANIFEST] reload: cache %u kept, %u to load; parse %lu ms\n",
+                (unsigned)kept, (unsigned)s_toLoadCount, (unsigned long)(millis() - t0));
+  if (!s_toLoadCount) return true;
+
+  s_reloadLoading = true;
+  if (xTaskCreatePinnedToCore(reloadTask, "reload", PRECACHE_TASK_STACK, nullptr, 1, nullptr,
+                              PRECACHE_TASK_CORE) != pdPASS) {
+    Serial.println("[MANIFEST] reload task failed to start; changed clips stream from SD");
+    s_reloadLoading = false;
+  }
+  return true;
+}
+
+bool Manifest_reloadPending() {
+  return staged != nullptr && !Manifest_reloadLoading();
+}
+
+// Between scenes only: channels and voices must not point into evicted buffers
+void Manifest_applyReload() {
+  if (!Manifest_reloadPending()) return;
+
+  // Live buffers the staged cache no longer references are freed here
+  for (size_t k = 0; k < cacheCount; k++) {
+    bool stays = false;
+    for (size_t j = 0; j < stagedCacheCount && !stays; j++) stays = (stagedCache[j].data == cache[k].data);
+    if (!stays) evicted[evictedCount++] = cache[k].data;
+  }
+  for (size_t k = 0; k < evictedCount; k++) free(evicted[k]);
+  memcpy(cache, stagedCache, stagedCacheCount * sizeof(CacheEntry));
+  cacheCount = stagedCacheCount;
+  s_live ^= 1;                 // the old block becomes the next reload's spare
+  catalog = staged;
+  catalogCount = stagedCount;
+  Serial.printf("[MANIFEST] catalog swapped: %u clips, %u cached, %u buffers freed\n",
+                (unsigned)catalogCount, (unsigned)cacheCount, (unsigned)evictedCount);
+  staged = nullptr;
+  stagedCount = stagedCacheCount = evictedCount = 0;
+}
+
+void Manifest_poolCounts(uint16_t* poolA, uint16_t* poolB) {
+  *poolA = *poolB = 0;
+  for (size_t i = 0; i < catalogCount; i++) (catalog[i].pool == POOL_A) ? (*poolA)++ : (*poolB)++;
+}
+
+size_t Manifest_residentIds(uint16_t* out, size_t maxOut) {
+  size_t n = 0;
+  const size_t cached = liveCacheCount();
+  for (size_t i = 0; i < catalogCount && n < maxOut; i++) {
+    const ClipMeta& m = catalog[i];
+    bool resident = !strcasecmp(m.base, "tones") || Soundbank_has(m.id);
+    for (size_t k = 0; !resident && k < cached; k++) resident = (cache[k].id == m.id);
+    if (resident) out[n++] = m.id;
+  }
+  std::sort(out, out + n);
+  return n;
+}
+
+size_t Manifest_cacheBytes() {
+  size_t bytes = 0;
+  const size_t n = liveCacheCount();
+  for (size_t i = 0; i < n; i++) bytes += cache[i].samples * 2;
+  return bytes;
 }
 
-bool Manifest_getCached(uint16_t id, int16_t** data, size_t* samples) {
-  for (size_t i = 0; i < cacheCount; i++) {
+bool Manifest_getCached(uint16_t id, int16_t** data, size_t* samples,
+                        uint32_t* loopStart, uint32_t* loopEnd, uint16_t* xfade) {
+  const size_t n = liveCacheCount();
+  for (size_t i = 0; i < n; i++) {
     if (cache[i].id == id) {
-      if (data)    *data    = cache[i].data;
-      if (samples) *samples = cache[i].samples;
+      if (data)      *data      = cache[i].data;
+      if (samples)   *samples   = cache[i].samples;
+      if (loopStart) *loopStart = cache[i].loopStart;
+      if (loopEnd)   *loopEnd   = cache[i].loopEnd;
+      if (xfade)     *xfade     = cache[i].xfade;
       return true;
     }
   }
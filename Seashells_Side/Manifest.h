@@ -3,22 +3,35 @@
 
 enum Pool : uint8_t { POOL_A = 0, POOL_B = 1 };
 
-// Extended metadata for each clip from manifest.csv
+// Extended metadata for each clip from manifest.csv. The strings point into
+// the catalog's arena and never change while that catalog is live; a pointer
+// to the entry (Channel::clip) is the clip's handle until the next
+// Manifest_applyReload().
 struct ClipMeta {
-  uint16_t id;         // numeric ID used in protocol
-  Pool     pool;       // A / B (legacy; still counted for Hello)
-  String   path;       // SD path, e.g. "/animals/farm/cow.wav"
-  bool     precache;   // true = load into PSRAM at boot
-  int8_t   volume_db;  // per-clip trim
+  uint16_t    id;               // numeric ID used in protocol
+  Pool        pool;             // A / B (legacy; still counted for Hello)
+  const char* path = "";        // SD path, e.g. "/animals/farm/cow.wav"
+  bool        precache;         // true = load into PSRAM at boot
+  int8_t      volume_db;        // per-clip trim
 
   // Structured category fields
-  String   base;       // e.g. "animals", "tones"
-  String   sub;        // e.g. "farm", "jungle", "simple", "sweep"
-  String   sub2;       // e.g. "cow", "dogs", "low_beep"
-  String   tags;       // optional extra tags (may be empty)
+  const char* base = "";        // e.g. "animals", "tones"
+  const char* sub  = "";        // e.g. "farm", "jungle", "simple", "sweep"
+  const char* sub2 = "";        // e.g. "cow", "dogs", "low_beep"
+  const char* tags = "";        // optional extra tags (may be empty)
+
+  // Optional trim columns (samples into the data chunk; 0/0 = whole clip).
+  // Precached clips without them are trimmed by analysis and filled in here.
+  uint32_t trimStart = 0;
+  uint32_t trimEnd   = 0;
+
+  // Loop points baked into the PSRAM copy at precache (ClipAnalysis); 0/0 = none
+  uint32_t loopStart = 0;
+  uint32_t loopEnd   = 0;
 };
 
-// Load /manifest.csv from SD into catalog[]
+// Load /manifest.csv from SD into catalog[]. The two catalog blocks (live and
+// reload staging, each with its string arena) are allocated here, once.
 bool Manifest_load();
 
 // Catalog lookup by ID (returns nullptr if not found)
@@ -28,11 +41,52 @@ const ClipMeta* Manifest_find(uint16_t id);
 uint8_t Manifest_pickRandom(Pool pool, uint8_t need, uint16_t* out, uint8_t maxOut);
 
 // NEW: category-based pickers (by base)
-uint8_t Manifest_pickRandomByBase(const String& base, uint8_t need, uint16_t* out, uint8_t maxOut);
-uint8_t Manifest_pickRandomByBaseNot(const String& forbiddenBase, uint8_t need, uint16_t* out, uint8_t maxOut);
+uint8_t Manifest_pickRandomByBase(const char* base, uint8_t need, uint16_t* out, uint8_t maxOut);
+uint8_t Manifest_pickRandomByBaseNot(const char* forbiddenBase, uint8_t need, uint16_t* out, uint8_t maxOut);
+
+// Precache all clips with precache=1 into PSRAM (best-effort) in a background
+// task, so the Side can say HELLO before its cache is warm. The current
+// scene's clips (Manifest_precacheHint) go first, then manifest order; until
+// a clip is in, it streams from SD. Trims silence and reports the bytes saved
+// and onset latency removed per clip.
+void Manifest_precacheStart();
+bool Manifest_warming();
+uint8_t Manifest_warmPercent();   // precache candidates done, 100 once warm
+void Manifest_precacheHint(const uint16_t ids[4]);
+
+// Clips per legacy pool, for HELLO
+void Manifest_poolCounts(uint16_t* poolA, uint16_t* poolB);
+
+// After files changed on SD (AssetSync): reload the cached clips whose path
+// is in paths[], or drop them from the cache if they no longer load. Soundbank
+// copies of those clips are masked (Soundbank_mask) and precache ones are
+// cached from the new file. Call between scenes only, with the SD bus held.
+void Manifest_refreshPaths(const char* const* paths, size_t n);
+
+// Hot reload: parse /manifest.csv into a staging catalog and diff it against
+// the live one by ID, path, volume, trim columns and precache flag (plus files
+// listed in changedPaths, rewritten on SD). Only new or changed precache clips
+// are read, by a background task (chunked like the warm task); unchanged ones
+// keep their PSRAM copy. Nothing live changes until Manifest_applyReload(),
+// which swaps catalog and cache between scenes once the loads are done.
+// Takes the SD bus itself; returns false (keeping the current catalog) if the
+// file is missing or empty, or the boot precache or a previous reload is
+// still loading.
+bool Manifest_reload(const char* const* changedPaths = nullptr, size_t nChanged = 0);
+bool Manifest_reloadLoading();   // the reload task is still reading clips
+bool Manifest_reloadPending();   // staged and loaded: ready to swap
+void Manifest_applyReload();
+
+// IDs this Side plays without SD (precached, soundbank, tones), ascending;
+// returns how many were written
+size_t Manifest_residentIds(uint16_t* out, size_t maxOut);
 
-// Precache all clips with precache=1 into PSRAM cache (best-effort)
-void Manifest_precacheAll();
+// PSRAM held by the precache, in bytes
+size_t Manifest_cacheBytes();
 
-// Check if the given id is precached and (if so) return pointer + sample count
-bool Manifest_getCached(uint16_t id, int16_t** data, size_t* samples);
+// Check if the given id is precached and (if so) return pointer + sample count,
+// plus its baked loop points (loopEnd == 0 when the clip has none) and the
+// length of the loop crossfade stored after the clip (TrackRAM::xfade)
+bool Manifest_getCached(uint16_t id, int16_t** data, size_t* samples,
+                        uint32_t* loopStart = nullptr, uint32_t* loopEnd = nullptr,
+                        uint16_t* xfade = nullptr);
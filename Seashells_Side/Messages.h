@@ -3,7 +3,7 @@
 
 enum MsgType : uint8_t {
   HELLO_REQ          = 0,
-  HELLO              = 1,
+  HELLO              = 1,  // type + sideId + poolA(2) + poolB(2) [+ cache report]
   SET_SCENE          = 2,  // type + 4×uint16 = 9 bytes total
   REQUEST_RANDOM_SET = 3,  // type + needA(uint8) + needB(uint8) = 3
   RANDOM_SET_REPLY   = 4,  // type + nA + nB + 4*A(2B ea) + 4*B(2B ea) = 19
@@ -16,9 +16,33 @@ enum MsgType : uint8_t {
   STOP_ALL           = 11, // type = 1
   OTA_UPDATE         = 12, // payload: url_len(uint8), url bytes...
   OTA_STATUS         = 13, // payload: side_id(uint8), code(uint8)  [0=BEGIN,1=OK,2=FAIL_WIFI,3=FAIL_HTTP,4=FAIL_UPDATE]
-  ROLE_ASSIGN        = 14  // payload: sideId(uint8)  0=A, 1=B
+  ROLE_ASSIGN        = 14, // payload: sideId(uint8)  0=A, 1=B
+  HEARTBEAT          = 15, // payload: sideId(uint8) + cache report
+  PLAY_ONESHOT       = 16, // type + slot(1) + id(2) + priority(1) = 5; slot 0xFF = all slots
+  FW_OFFER           = 17, // broadcast: type + xfer(1) + size(4) + sha256(32) = 38; also polls FW_NACK
+  FW_CHUNK           = 18, // broadcast: type + xfer(1) + index(2) + data(<= FW_CHUNK_BYTES)
+  FW_NACK            = 19, // Side->Master: type + side(1) + xfer(1) + state(1) + base(2) + nbits(2) + bitmap
+  FW_COMMIT          = 20, // broadcast: type + xfer(1) = 2; COMPLETE Sides boot the new image
+  ASSET_SYNC         = 21, // payload: url_len(uint8), url bytes... of the asset index (AssetSync)
+  MANIFEST_RELOAD    = 22  // type = 1; hot-reload /manifest.csv, live from the next SET_SCENE
 };
 
+// PLAY_ONESHOT layers the clip over whatever the slot is playing (Side voice
+// pool). Higher priority may steal a voice from lower; equal steals oldest.
+#define ONESHOT_ALL_SLOTS     0xFF
+
+// Cache report (appended to HELLO, carried by HEARTBEAT). Tells the Master
+// which clips a Side plays without touching SD (PSRAM cache, flash soundbank,
+// synthesized tones), how healthy its SD bus is and how far its boot
+// precache got (a Side says HELLO while still warming; clips not yet cached
+// stream from SD).
+//   flags(1) | budgetKB(2) | usedKB(2) | sdHealth(1, 0..100) | warmPct(1, 0..100) | nSeg(1)
+//   nSeg x { firstId(2) | nbits(1) | bitmap[(nbits+7)/8] }   bit i => firstId+i
+// Multi-byte fields are big-endian like the rest of the protocol.
+#define CACHE_FLAG_TRUNCATED  0x01   // more resident IDs than fit in one packet
+#define CACHE_FLAG_WARMING    0x02   // boot precache still running
+#define CACHE_SEG_MAX_BITS    64
+
 // OTA_STATUS codes (data[2]) and optional payload
 #define OTA_STATUS_BEGIN     0   // payload: [type, side, 0]
 #define OTA_STATUS_OK        1   // payload: [type, side, 1]
@@ -26,3 +50,17 @@ enum MsgType : uint8_t {
 #define OTA_STATUS_FAIL_HTTP 3
 #define OTA_STATUS_FAIL_UPD  4
 #define OTA_STATUS_PROGRESS  5   // payload: [type, side, 5, percent]
+
+// Firmware relay over ESP-NOW (alternative to OTA_UPDATE). The Master holds
+// the image and broadcasts it in FW_CHUNK_BYTES chunks to every Side at once;
+// chunk i sits at offset i * FW_CHUNK_BYTES. Every FW_OFFER asks each Side
+// for a FW_NACK: its state plus a bitmap of missing chunks starting at `base`
+// (bit k => chunk base+k, LSB first, at most FW_NACK_MAX_BITS). The Master
+// resends the union of the holes until every Side reports COMPLETE, i.e. the
+// whole image is in flash and its SHA-256 matches the offer.
+#define FW_CHUNK_BYTES       240
+#define FW_NACK_MAX_BITS     1920   // 240 bitmap bytes
+#define FW_ST_ERASING        0      // preparing the update partition; chunks are ignored
+#define FW_ST_RECEIVING      1
+#define FW_ST_COMPLETE       2      // verified, waiting for FW_COMMIT
+#define FW_ST_FAILED         3      // hash mismatch or flash error; the Master gives up on this Side
@@ -0,0 +1,34 @@
+#include "Meter.h"
+#include "AudioEngine.h"
+
+std::atomic<uint32_t> g_slotMeter[4];
+
+void Meter_benchmark(Print& out) {
+  static constexpr size_t kN     = 1024;   // same as the engine frame
+  static constexpr int    kIters = 256;
+  static int16_t src[kN], buf[kN];
+
+  for (size_t i = 0; i < kN; i++) src[i] = (int16_t)random(-20000, 20000);
+  const int32_t g = q15_from_db(-6);
+
+  uint32_t plain = 0, metered = 0;
+  for (int it = 0; it < kIters; it++) {
+    memcpy(buf, src, sizeof(buf));
+    uint32_t c0 = ESP.getCycleCount();
+    applyGain(buf, kN, g);
+    plain += ESP.getCycleCount() - c0;
+
+    memcpy(buf, src, sizeof(buf));
+    c0 = ESP.getCycleCount();
+    applyGainMeter(buf, kN, g, 0);
+    metered += ESP.getCycleCount() - c0;
+  }
+
+  const float frameCycles = (float)ESP.getCpuFreqMHz() * 1e6f * (float)kN / (float)SAMPLE_RATE;
+  const float perPlain = (float)plain / kIters;
+  const float perMeter = (float)metered / kIters;
+  const float extra4   = 4.0f * (perMeter - perPlain);   // four slots per frame
+  out.printf("[METER] gain %.0f cyc, gain+meter %.0f cyc per slot-frame\n", perPlain, perMeter);
+  out.printf("[METER] metering 4 slots: %.0f cyc = %.2f%% of %.0f cyc frame budget\n",
+             extra4, 100.0f * extra4 / frameCycles, frameCycles);
+}
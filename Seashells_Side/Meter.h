@@ -0,0 +1,26 @@
+#pragma once
+#include <Arduino.h>
+#include <atomic>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Per-slot level meter. applyGainMeter() (AudioEngine) measures peak and RMS
+// in the same pass that applies the clip gain, then publishes one packed word
+// per slot. The LED effect engine reads it from its own timer; no locks.
+// ─────────────────────────────────────────────────────────────────────────────
+
+// (peak << 16) | rms, both 0..32767 on the post-gain samples
+extern std::atomic<uint32_t> g_slotMeter[4];
+
+static inline void Meter_publish(uint8_t slot, uint16_t peak, uint16_t rms) {
+  g_slotMeter[slot & 3].store(((uint32_t)peak << 16) | rms, std::memory_order_relaxed);
+}
+
+static inline void Meter_read(uint8_t slot, uint16_t* peak, uint16_t* rms) {
+  const uint32_t v = g_slotMeter[slot & 3].load(std::memory_order_relaxed);
+  if (peak) *peak = (uint16_t)(v >> 16);
+  if (rms)  *rms  = (uint16_t)(v & 0xFFFF);
+}
+
+// Time applyGain() against applyGainMeter() on a synthetic frame and print the
+// metering overhead as a share of the real-time frame budget.
+void Meter_benchmark(Print& out);
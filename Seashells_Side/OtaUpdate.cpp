@@ -3,7 +3,15 @@
 #include <WiFi.h>
 #include <esp_wifi.h>
 #include <HTTPClient.h>
-#include <Update.h>
+#include <Preferences.h>
+#include <esp_ota_ops.h>
+#include <esp_partition.h>
+#include <lwip/sockets.h>
+#include <mbedtls/sha256.h>
+#include <rom/miniz.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/queue.h>
+#include <freertos/semphr.h>
 
 #include "ConfigSide.h"   // OTA_WIFI_SSID, OTA_WIFI_PASS, OTA_CONNECT_TIMEOUT_MS, OTA_HTTP_TIMEOUT_MS
 #include "OtaUpdate.h"
@@ -17,51 +25,380 @@ extern void side_stopAll();
 
 // --- Module state ---
 static volatile bool s_otaStartRequested = false;
-static String        s_otaUrl;
+static char          s_otaUrl[ASSET_URL_MAX] = "";
 
 // --- Public entry points used by the ESP-NOW handler ---
 void side_setOtaUrl(const char* p, uint8_t n) {
-  s_otaUrl = ""; s_otaUrl.reserve(n + 1);
-  for (uint8_t i = 0; i < n; i++) s_otaUrl += p[i];
-  Serial.printf("[OTA] URL set: %s\n", s_otaUrl.c_str());
+  n = (uint8_t)min((int)n, ASSET_URL_MAX - 1);
+  memcpy(s_otaUrl, p, n);
+  s_otaUrl[n] = 0;
+  Serial.printf("[OTA] URL set: %s\n", s_otaUrl);
 }
 void side_requestOtaStart() {
   s_otaStartRequested = true;
 }
 
-// --- Internal TREX-style OTA implementation ---
-static bool doOtaFromUrl(const String& url) {
-  Serial.printf("[OTA] URL: %s\n", url.c_str());
+// ─────────────────────────────────────────────────────────────────────────────
+// Pipelined copy: network reads and flash writes overlap.
+//
+// OTA_PIPE_BUFS sector-sized buffers circulate between two queues. The
+// calling (loop) task fills a free buffer straight from the socket, waiting
+// in select() instead of polling, and hands it to the writer task, which
+// writes it to the next OTA partition and feeds the same bytes to a
+// streaming SHA-256 before returning the buffer. While flash erases/writes
+// the radio keeps filling the next buffer. A zero-length block tells the
+// writer to finish.
+//
+// Gzip images (tools/ota_pack.py) are inflated by the writer with the ROM's
+// tinfl into a 32 KB window and written from there, so only compressed bytes
+// cross the air. The SHA-256 always covers the image as written to flash.
+//
+// Resume: the session (offsets, hash, inflater) outlives a connection. When
+// the link drops the Side reconnects with backoff and asks for the rest with
+// a Range request, writing on into the same partition (erased lazily, ahead
+// of the writes). Raw images also checkpoint their offset and expected hash
+// in NVS every OTA_CKPT_BYTES, so an update cut by a reboot resumes too; the
+// already-written prefix is re-hashed from flash. Nothing is marked bootable
+// until the whole image hash matches and esp_ota_set_boot_partition() has
+// verified it.
+// ─────────────────────────────────────────────────────────────────────────────
 
-  // Optional: quiet local playback/loops
-  if (side_stopAll) side_stopAll();
+static constexpr uint32_t kSector = 4096;
 
-  // Visual cue + progress bar reset
-  side_blinkAll(/*white*/2, 60, 60);
-  otaShowProgress(0);
+struct OtaBlock {
+  uint8_t* data;
+  size_t   len;
+};
 
-  // 1) Join Wi-Fi (STA), no ESPNOW deinit (matches TREX)
-  WiFi.persistent(false);
-  WiFi.disconnect(true, true);
-  WiFi.mode(WIFI_STA);
-  WiFi.setSleep(false);
-  esp_wifi_set_ps(WIFI_PS_NONE);
+enum GzState : uint8_t { GZ_FIXED, GZ_XLEN, GZ_EXTRA, GZ_NAME, GZ_COMMENT, GZ_HCRC, GZ_DATA, GZ_BAD };
 
-  Serial.printf("[OTA] STA connect → SSID='%s'\n", OTA_WIFI_SSID);
-  WiFi.begin(OTA_WIFI_SSID, OTA_WIFI_PASS);
+struct OtaPipe {
+  QueueHandle_t      freeQ = nullptr;
+  QueueHandle_t      fullQ = nullptr;
+  SemaphoreHandle_t  done  = nullptr;
+  uint8_t*           pool  = nullptr;
+  volatile bool      writeErr = false;
 
-  uint32_t t0 = millis();
-  while (WiFi.status() != WL_CONNECTED) {
-    if (millis() - t0 > OTA_CONNECT_TIMEOUT_MS) {
-      Serial.println("[OTA] WiFi connect timeout");
+  // Session, kept across reconnects
+  const esp_partition_t* part = nullptr;
+  uint32_t           urlHash = 0;
+  char               expectSha[65] = "";  // X-SHA256 of the flashed image, "" = unknown
+  int32_t            wireTotal = -1;      // body bytes on the wire, -1 = unknown
+  uint32_t           imageSize = 0;       // flashed bytes when known
+  uint32_t           got = 0;             // body bytes received (wire offset)
+  uint32_t           written = 0;         // bytes written to the partition
+  uint32_t           erasedTo = 0;
+  uint32_t           ckptNext = 0;
+  mbedtls_sha256_context sha;
+
+  // Timing, summed over connections
+  uint32_t           writeUs = 0;        // writer time in inflate + flash + SHA
+  uint32_t           netWaitMs = 0;
+  uint32_t           pipeFullMs = 0;
+
+  // gzip only
+  bool                gzip = false;
+  bool                gzDone = false;    // deflate stream ended
+  GzState             gzState = GZ_FIXED;
+  uint8_t             gzFlags = 0;
+  uint8_t             gzCount = 0;       // bytes seen of the current fixed-size field
+  uint16_t            gzExtra = 0;       // FEXTRA bytes left
+  tinfl_decompressor* inf = nullptr;
+  uint8_t*            dict = nullptr;    // TINFL_LZ_DICT_SIZE ring, also the output buffer
+  size_t              dictOfs = 0;
+};
+
+// ───────────────── NVS checkpoint ─────────────────
+
+static uint32_t urlHash(const char* url) {
+  uint32_t h = 2166136261u;                      // FNV-1a
+  for (; *url; url++) { h ^= (uint8_t)*url; h *= 16777619u; }
+  return h;
+}
+
+static void ckptSave(const OtaPipe& P, uint32_t off) {
+  Preferences p;
+  p.begin("ota", false);
+  p.putUInt("url", P.urlHash);
+  p.putString("sha", P.expectSha);
+  p.putUInt("size", P.imageSize);
+  p.putUInt("off", off);
+  p.end();
+}
+
+static void ckptClear() {
+  Preferences p;
+  p.begin("ota", false);
+  p.clear();
+  p.end();
+}
+
+// Offset a previous boot reached for this URL (0 = none); fills the image identity.
+static uint32_t ckptLoad(OtaPipe& P) {
+  Preferences p;
+  p.begin("ota", true);
+  uint32_t off = 0;
+  if (p.getUInt("url", 0) == P.urlHash) {
+    off = p.getUInt("off", 0);
+    P.imageSize = p.getUInt("size", 0);
+    p.getString("sha", P.expectSha, sizeof(P.expectSha));
+  }
+  p.end();
+  if (!P.expectSha[0] || off % kSector || off > P.part->size) return 0;
+  return off;
+}
+
+// ───────────────── Flash side (writer task) ─────────────────
+
+static bool flashOut(OtaPipe& P, const uint8_t* d, size_t n) {
+  if (P.written + n > P.part->size) {
+    Serial.printf("[OTA] image exceeds partition (%lu bytes)\n", (unsigned long)P.part->size);
+    return false;
+  }
+  while (P.erasedTo < P.written + n) {
+    uint32_t len = min((uint32_t)OTA_ERASE_BYTES, (uint32_t)P.part->size - P.erasedTo);
+    if (esp_partition_erase_range(P.part, P.erasedTo, len) != ESP_OK) {
+      Serial.printf("[OTA] erase err @%lu\n", (unsigned long)P.erasedTo);
       return false;
     }
-    delay(100);
+    P.erasedTo += len;
   }
-  Serial.printf("[OTA] WiFi OK ch=%d ip=%s\n",
-                WiFi.channel(), WiFi.localIP().toString().c_str());
+  if (esp_partition_write(P.part, P.written, d, n) != ESP_OK) {
+    Serial.printf("[OTA] write err @%lu\n", (unsigned long)P.written);
+    return false;
+  }
+  mbedtls_sha256_update(&P.sha, d, n);
+  P.written += (uint32_t)n;
+
+  // Raw images only: a gzip resume would need the inflater state too
+  if (!P.gzip && P.expectSha[0] && P.written >= P.ckptNext) {
+    ckptSave(P, P.written & ~(kSector - 1));
+    P.ckptNext = P.written + OTA_CKPT_BYTES;
+  }
+  return true;
+}
+
+// Walk the gzip member header (RFC 1952) byte by byte, so it may span blocks.
+// Returns bytes consumed; gzState is GZ_DATA once the deflate stream starts.
+static size_t gzHeader(OtaPipe& P, const uint8_t* p, size_t n) {
+  size_t i = 0;
+  while (P.gzState != GZ_DATA && P.gzState != GZ_BAD) {
+    // Absent optional fields consume no input
+    if (P.gzState == GZ_XLEN    && !(P.gzFlags & 0x04)) { P.gzState = GZ_NAME; continue; }
+    if (P.gzState == GZ_NAME    && !(P.gzFlags & 0x08)) { P.gzState = GZ_COMMENT; continue; }
+    if (P.gzState == GZ_COMMENT && !(P.gzFlags & 0x10)) { P.gzState = GZ_HCRC; P.gzCount = 0; continue; }
+    if (P.gzState == GZ_HCRC    && !(P.gzFlags & 0x02)) { P.gzState = GZ_DATA; continue; }
+    if (i == n) break;
+    const uint8_t b = p[i++];
+    switch (P.gzState) {
+      case GZ_FIXED:     // ID1 ID2 CM FLG MTIME(4) XFL OS
+        if ((P.gzCount == 0 && b != 0x1f) || (P.gzCount == 1 && b != 0x8b) ||
+            (P.gzCount == 2 && b != 8)) { P.gzState = GZ_BAD; break; }
+        if (P.gzCount == 3) P.gzFlags = b;
+        if (++P.gzCount == 10) { P.gzState = GZ_XLEN; P.gzCount = 0; }
+        break;
+      case GZ_XLEN:
+        P.gzExtra |= (uint16_t)(b << (8 * P.gzCount));
+        if (++P.gzCount == 2) P.gzState = P.gzExtra ? GZ_EXTRA : GZ_NAME;
+        break;
+      case GZ_EXTRA:   if (--P.gzExtra == 0) P.gzState = GZ_NAME; break;
+      case GZ_NAME:    if (!b) P.gzState = GZ_COMMENT; break;
+      case GZ_COMMENT: if (!b) { P.gzState = GZ_HCRC; P.gzCount = 0; } break;
+      case GZ_HCRC:    if (++P.gzCount == 2) P.gzState = GZ_DATA; break;
+      default: break;
+    }
+  }
+  return i;
+}
+
+static bool inflateBlock(OtaPipe& P, const uint8_t* in, size_t n) {
+  size_t used = (P.gzState != GZ_DATA) ? gzHeader(P, in, n) : 0;
+  if (P.gzState == GZ_BAD) { Serial.println("[OTA] not a gzip image"); return false; }
+  while (P.gzState == GZ_DATA && !P.gzDone) {
+    size_t inSz  = n - used;
+    size_t outSz = TINFL_LZ_DICT_SIZE - P.dictOfs;
+    tinfl_status st = tinfl_decompress(P.inf, in + used, &inSz, P.dict, P.dict + P.dictOfs,
+                                       &outSz, TINFL_FLAG_HAS_MORE_INPUT);
+    used += inSz;
+    if (outSz) {
+      if (!flashOut(P, P.dict + P.dictOfs, outSz)) return false;
+      P.dictOfs = (P.dictOfs + outSz) & (TINFL_LZ_DICT_SIZE - 1);
+    }
+    if (st == TINFL_STATUS_DONE) P.gzDone = true;   // the 8-byte trailer is ignored: SHA-256 covers it
+    else if (st < 0) { Serial.printf("[OTA] inflate error %d\n", (int)st); return false; }
+    else if (st == TINFL_STATUS_NEEDS_MORE_INPUT && used == n) break;   // wait for the next block
+  }
+  return true;
+}
+
+static void otaWriterTask(void* arg) {
+  OtaPipe& P = *(OtaPipe*)arg;
+  OtaBlock b;
+  for (;;) {
+    xQueueReceive(P.fullQ, &b, portMAX_DELAY);
+    if (b.len == 0) break;
+    if (!P.writeErr) {
+      uint32_t t0 = micros();
+      bool ok = P.gzip ? inflateBlock(P, b.data, b.len) : flashOut(P, b.data, b.len);
+      if (!ok) P.writeErr = true;
+      P.writeUs += micros() - t0;
+    }
+    xQueueSend(P.freeQ, &b, portMAX_DELAY);
+  }
+  xSemaphoreGive(P.done);
+  vTaskDelete(nullptr);
+}
+
+// Block until the socket has data (or `ms` passes). WiFiClient's own buffer
+// is empty whenever available() is 0, so the fd tells the whole story.
+static bool waitReadable(WiFiClient* c, uint32_t ms) {
+  int fd = c->fd();
+  if (fd < 0) return false;
+  fd_set rd;
+  FD_ZERO(&rd);
+  FD_SET(fd, &rd);
+  timeval tv = { (time_t)(ms / 1000), (suseconds_t)((ms % 1000) * 1000) };
+  return select(fd + 1, &rd, nullptr, nullptr, &tv) > 0;
+}
+
+static void hexDigest(const uint8_t d[32], char out[65]) {
+  for (int i = 0; i < 32; i++) snprintf(out + i * 2, 3, "%02x", d[i]);
+}
+
+// ───────────────── Session ─────────────────
+
+static bool sessionOpen(OtaPipe& P) {
+  mbedtls_sha256_init(&P.sha);
+  P.pool  = (uint8_t*)malloc(OTA_PIPE_BUFS * OTA_PIPE_BUF_BYTES);
+  P.freeQ = xQueueCreate(OTA_PIPE_BUFS, sizeof(OtaBlock));
+  P.fullQ = xQueueCreate(OTA_PIPE_BUFS + 1, sizeof(OtaBlock));
+  P.done  = xSemaphoreCreateBinary();
+  P.inf   = (tinfl_decompressor*)malloc(sizeof(tinfl_decompressor));
+  P.dict  = (uint8_t*)malloc(TINFL_LZ_DICT_SIZE);
+  if (!P.pool || !P.freeQ || !P.fullQ || !P.done || !P.inf || !P.dict) {
+    Serial.println("[OTA] pipeline alloc FAIL");
+    return false;
+  }
+  for (int i = 0; i < OTA_PIPE_BUFS; i++) {
+    OtaBlock b = { P.pool + i * OTA_PIPE_BUF_BYTES, 0 };
+    xQueueSend(P.freeQ, &b, 0);
+  }
+  return true;
+}
+
+static void sessionClose(OtaPipe& P) {
+  if (P.freeQ) vQueueDelete(P.freeQ);
+  if (P.fullQ) vQueueDelete(P.fullQ);
+  if (P.done)  vSemaphoreDelete(P.done);
+  free(P.pool);
+  free(P.inf);
+  free(P.dict);
+  mbedtls_sha256_free(&P.sha);
+}
+
+// Start the image over from byte 0 (new image, or the server ignored Range).
+static void sessionRestart(OtaPipe& P) {
+  P.got = P.written = P.erasedTo = 0;
+  P.ckptNext = OTA_CKPT_BYTES;
+  P.gzDone = false;
+  P.gzState = GZ_FIXED;
+  P.gzFlags = P.gzCount = 0;
+  P.gzExtra = 0;
+  P.dictOfs = 0;
+  tinfl_init(P.inf);
+  mbedtls_sha256_starts(&P.sha, 0);
+}
+
+// Pick up where a previous boot stopped: re-hash the flashed prefix.
+static bool sessionResume(OtaPipe& P, uint32_t off) {
+  sessionRestart(P);
+  for (uint32_t o = 0; o < off; o += OTA_PIPE_BUF_BYTES) {
+    uint32_t n = min((uint32_t)OTA_PIPE_BUF_BYTES, off - o);
+    if (esp_partition_read(P.part, o, P.pool, n) != ESP_OK) { sessionRestart(P); return false; }
+    mbedtls_sha256_update(&P.sha, P.pool, n);
+  }
+  P.got = P.written = P.erasedTo = off;
+  P.ckptNext = off + OTA_CKPT_BYTES;
+  Serial.printf("[OTA] resuming at %lu from checkpoint\n", (unsigned long)off);
+  return true;
+}
+
+enum RxResult : uint8_t { RX_DONE, RX_DROPPED, RX_FAILED };
+
+// Receive one HTTP body into the pipeline, continuing at P.got.
+static RxResult receiveBody(OtaPipe& P, WiFiClient* stream) {
+  // Core 0 with the WiFi stack: the loop task on core 1 keeps receiving
+  P.writeErr = false;
+  xTaskCreatePinnedToCore(otaWriterTask, "otawrite", 4096, &P, 2, nullptr, 0);
 
-  // 2) HTTP (no keep-alive), 15s+ timeout; require 200 OK
+  uint32_t lastDraw = P.got, lastActivity = millis();
+  RxResult res = RX_DONE;
+  OtaBlock cur = { nullptr, 0 };
+
+  while (P.wireTotal < 0 || P.got < (uint32_t)P.wireTotal) {
+    if (P.writeErr) { res = RX_FAILED; break; }
+
+    if (!cur.data) {
+      uint32_t t0 = millis();
+      xQueueReceive(P.freeQ, &cur, portMAX_DELAY);   // writer always returns buffers
+      cur.len = 0;
+      P.pipeFullMs += millis() - t0;
+    }
+
+    size_t avail = stream->available();
+    if (!avail) {
+      if (!stream->connected()) { res = (P.wireTotal < 0) ? RX_DONE : RX_DROPPED; break; }
+      if (WiFi.status() != WL_CONNECTED) { res = RX_DROPPED; break; }
+      if (millis() - lastActivity > OTA_STALL_MS) {
+        Serial.println("[OTA] Stream timeout (no data)");
+        res = RX_DROPPED; break;
+      }
+      uint32_t t0 = millis();
+      waitReadable(stream, 100);
+      P.netWaitMs += millis() - t0;
+      continue;
+    }
+
+    size_t room = OTA_PIPE_BUF_BYTES - cur.len;
+    int n = stream->read(cur.data + cur.len, avail < room ? avail : room);
+    if (n <= 0) continue;
+    cur.len += (size_t)n;
+    P.got += (uint32_t)n;
+    lastActivity = millis();
+
+    if (cur.len == OTA_PIPE_BUF_BYTES) {
+      xQueueSend(P.fullQ, &cur, portMAX_DELAY);
+      cur.data = nullptr;
+    }
+
+    if (P.wireTotal > 0 && (P.got - lastDraw) >= 16384) {   // update every 16 KB
+      otaShowProgress((uint8_t)((P.got * 100ULL) / (uint32_t)P.wireTotal));
+      lastDraw = P.got;
+    }
+  }
+
+  // Everything received is written, even on a drop: the next Range starts at P.got
+  if (cur.data) {
+    if (cur.len) xQueueSend(P.fullQ, &cur, portMAX_DELAY);
+    else         xQueueSend(P.freeQ, &cur, portMAX_DELAY);
+  }
+  OtaBlock stop = { nullptr, 0 };
+  xQueueSend(P.fullQ, &stop, portMAX_DELAY);
+  xSemaphoreTake(P.done, portMAX_DELAY);
+  return P.writeErr ? RX_FAILED : res;
+}
+
+// "bytes a-b/total" -> a and total (-1 when '*')
+static bool parseContentRange(const String& v, uint32_t* first, int32_t* total) {
+  int sp = v.indexOf(' '), dash = v.indexOf('-'), slash = v.indexOf('/');
+  if (sp < 0 || dash < sp || slash < dash) return false;
+  *first = (uint32_t)v.substring(sp + 1, dash).toInt();
+  *total = (v[slash + 1] == '*') ? -1 : (int32_t)v.substring(slash + 1).toInt();
+  return true;
+}
+
+// One GET at P.got. RX_DONE = body received, RX_DROPPED = try again, RX_FAILED = give up.
+static RxResult fetchFrom(OtaPipe& P, const char* url) {
   HTTPClient http;
   WiFiClient client;
   http.setReuse(false);
@@ -70,83 +407,179 @@ static bool doOtaFromUrl(const String& url) {
 
   if (!http.begin(client, url)) {
     Serial.println("[OTA] http.begin FAIL");
-    return false;
+    return RX_DROPPED;
   }
+  // Offer gzip; a server with a packed image (tools/ota_pack.py) answers with
+  // Content-Encoding: gzip. A URL ending in .gz is gzip regardless.
+  http.addHeader("Accept-Encoding", "gzip");
+  const uint32_t from = P.got;
+  if (from) {
+    char range[24];
+    snprintf(range, sizeof(range), "bytes=%lu-", (unsigned long)from);
+    http.addHeader("Range", range);
+  }
+  const char* hdrs[] = { "X-SHA256", "X-Image-Size", "Content-Encoding", "Content-Range" };
+  http.collectHeaders(hdrs, 4);
 
   int code = http.GET();
-  Serial.printf("[OTA] HTTP code %d\n", code);
-  if (code != HTTP_CODE_OK) {
+  Serial.printf("[OTA] HTTP code %d%s\n", code, from ? " (resume)" : "");
+  if (code != HTTP_CODE_OK && code != HTTP_CODE_PARTIAL_CONTENT) {
     http.end();
-    return false;
+    return (code > 0 && code < 500) ? RX_FAILED : RX_DROPPED;
   }
 
-  int total = http.getSize();            // may be -1
-  Serial.printf("[OTA] total bytes: %d\n", total);
+  const size_t ulen = strlen(url);
+  const bool   gzip = (ulen >= 3 && !strcmp(url + ulen - 3, ".gz")) || http.header("Content-Encoding").equalsIgnoreCase("gzip");
+  const String sha  = http.header("X-SHA256");
+  uint32_t start = 0;
+  int32_t  total = http.getSize();
+  if (code == HTTP_CODE_PARTIAL_CONTENT && !parseContentRange(http.header("Content-Range"), &start, &total)) {
+    Serial.println("[OTA] bad Content-Range");
+    http.end();
+    return RX_FAILED;
+  }
 
-  // 3) Begin Update with/without known length
-  if (total > 0) {
-    if (!Update.begin(total)) {
-      Serial.printf("[OTA] Update.begin fail: %s need=%d\n", Update.errorString(), total);
-      http.end(); return false;
+  // A resumed body must be the same image, at the same place
+  const bool sameImage = (gzip == P.gzip) && (!P.expectSha[0] || sha.equalsIgnoreCase(P.expectSha));
+  if (from && !(code == HTTP_CODE_PARTIAL_CONTENT && start == from && sameImage)) {
+    Serial.println("[OTA] server can't resume this image, starting over");
+    ckptClear();
+    if (code != HTTP_CODE_OK) { http.end(); sessionRestart(P); return RX_DROPPED; }
+    sessionRestart(P);
+  }
+  if (!P.got) {
+    P.gzip = gzip;
+    snprintf(P.expectSha, sizeof(P.expectSha), "%s", sha.c_str());
+    P.imageSize = (uint32_t)http.header("X-Image-Size").toInt();
+    if (!gzip && !P.imageSize && total > 0) P.imageSize = (uint32_t)total;
+    Serial.printf("[OTA] total bytes: %d%s", (int)total, gzip ? " gzip" : "");
+    if (P.imageSize) Serial.printf(", image %lu", (unsigned long)P.imageSize);
+    Serial.println();
+    if (P.imageSize > P.part->size) {
+      Serial.printf("[OTA] image larger than the %lu-byte app slot (partitions.csv)\n",
+                    (unsigned long)P.part->size);
+      http.end();
+      return RX_FAILED;
     }
-  } else {
-    if (!Update.begin()) {
-      Serial.printf("[OTA] Update.begin(no len) fail: %s\n", Update.errorString());
-      http.end(); return false;
+  }
+  P.wireTotal = total;
+
+  RxResult r = receiveBody(P, http.getStreamPtr());
+  http.end();
+  return r;
+}
+
+// --- Internal TREX-style OTA implementation ---
+
+static bool joinWifi() {
+  WiFi.begin(OTA_WIFI_SSID, OTA_WIFI_PASS);
+  uint32_t t0 = millis();
+  while (WiFi.status() != WL_CONNECTED) {
+    if (millis() - t0 > OTA_CONNECT_TIMEOUT_MS) {
+      Serial.println("[OTA] WiFi connect timeout");
+      return false;
     }
+    delay(100);
   }
+  Serial.printf("[OTA] WiFi OK ch=%d ip=%s\n",
+                WiFi.channel(), WiFi.localIP().toString().c_str());
+  return true;
+}
 
-  // 4) Chunked copy + 15s inactivity watchdog + LED progress
-  WiFiClient* stream = http.getStreamPtr();
-  const size_t BUF = 2048;
-  uint8_t buf[BUF];
-  uint32_t got = 0, lastDraw = 0, lastActivity = millis();
+static bool doOtaFromUrl(const char* url) {
+  Serial.printf("[OTA] URL: %s\n", url);
 
-  while ( (total < 0) || (got < (uint32_t)total) ) {
-    size_t avail = stream->available();
-    if (avail) {
-      size_t toRead = (avail > BUF) ? BUF : avail;
-      int n = stream->readBytes((char*)buf, toRead);
-      if (n <= 0) { delay(1); continue; }
-
-      size_t w = Update.write(buf, (size_t)n);
-      if (w != (size_t)n) {
-        Serial.printf("[OTA] write err: %s @%lu/%d\n",
-                      Update.errorString(), (unsigned long)got, total);
-        Update.end(); http.end(); return false;
-      }
+  // Optional: quiet local playback/loops
+  if (side_stopAll) side_stopAll();
 
-      got += w; lastActivity = millis();
+  // Visual cue + progress bar reset
+  side_blinkAll(/*white*/2, 60, 60);
+  otaShowProgress(0);
 
-      if (total > 0 && (got - lastDraw) >= 16384) {   // update every 16 KB
-        uint8_t pct = (uint8_t)((got * 100UL) / (uint32_t)total);
-        otaShowProgress(pct);
-        lastDraw = got;
-      }
-    } else {
-      delay(1);
+  // 1) Join Wi-Fi (STA), no ESPNOW deinit (matches TREX)
+  if (!Ota_joinWifi()) return false;
 
-      if (total > 0 && got >= (uint32_t)total) break;
-      if (total < 0 && !stream->connected() && stream->available()==0) break;
+  // 2) Session on the next OTA slot, resuming a checkpoint for this URL
+  OtaPipe P;
+  P.part = esp_ota_get_next_update_partition(nullptr);
+  if (!P.part) { Serial.println("[OTA] no OTA partition"); return false; }
+  if (!sessionOpen(P)) { sessionClose(P); return false; }
+  P.urlHash = urlHash(url);
+  uint32_t off = ckptLoad(P);
+  if (!off || !sessionResume(P, off)) {
+    P.expectSha[0] = 0;
+    P.imageSize = 0;
+    sessionRestart(P);
+  }
 
-      if (millis() - lastActivity > 15000) {
-        Serial.println("[OTA] Stream timeout (no data)");
-        Update.end(); http.end(); return false;
-      }
+  // 3) Pipelined copy; reconnect with backoff and Range on drops
+  const uint32_t tStart = millis();
+  uint32_t backoff = OTA_BACKOFF_MS, connects = 0;
+  uint8_t  failures = 0;
+  RxResult r = RX_DROPPED;
+  for (;;) {
+    const uint32_t before = P.got;
+    bool linked = (WiFi.status() == WL_CONNECTED);
+    if (!linked) { WiFi.disconnect(); linked = joinWifi(); }
+    if (linked) {
+      connects++;
+      r = fetchFrom(P, url);
+      if (r != RX_DROPPED) break;
     }
+    if (P.got > before) { failures = 0; backoff = OTA_BACKOFF_MS; }   // progress: quick retry
+    if (++failures > OTA_RETRY_MAX) { Serial.println("[OTA] giving up"); r = RX_FAILED; break; }
+    Serial.printf("[OTA] dropped at %lu/%ld, retry %u in %lu ms\n", (unsigned long)P.got,
+                  (long)P.wireTotal, (unsigned)failures, (unsigned long)backoff);
+    delay(backoff);
+    backoff = min(backoff * 2, (uint32_t)OTA_BACKOFF_MAX_MS);
   }
 
-  // 5) Verify & finish (like TREX)
-  bool ok = Update.end(true);
-  http.end();
+  uint8_t digest[32];
+  char hex[65];
+  mbedtls_sha256_finish(&P.sha, digest);
+  hexDigest(digest, hex);
 
-  if (!ok || !Update.isFinished()) {
-    Serial.printf("[OTA] verify error: %s (wrote %lu/%d)\n",
-                  Update.errorString(), (unsigned long)got, total);
-    return false;
+  const uint32_t ms = millis() - tStart;
+  Serial.printf("[OTA] %lu bytes received, %lu flashed%s in %lu ms over %lu connection(s) "
+                "(%.1f KB/s on air): net wait %lu ms, %sflash+sha %lu ms, pipe full %lu ms\n",
+                (unsigned long)P.got, (unsigned long)P.written, P.gzip ? " (gzip)" : "",
+                (unsigned long)ms, (unsigned long)connects,
+                ms ? (float)P.got / 1.024f / (float)ms : 0.0f,
+                (unsigned long)P.netWaitMs, P.gzip ? "inflate+" : "",
+                (unsigned long)(P.writeUs / 1000), (unsigned long)P.pipeFullMs);
+  if (P.gzip && P.written) {
+    Serial.printf("[OTA] gzip saved %lu bytes on air (%.0f%% of raw)\n",
+                  (unsigned long)(P.written - P.got), 100.0f * (float)P.got / (float)P.written);
+  }
+  Serial.printf("[OTA] sha256 %s\n", hex);
+
+  // 4) Verify the whole image before it can boot
+  bool ok = (r == RX_DONE);
+  if (ok && P.gzip && !P.gzDone) {
+    Serial.println("[OTA] gzip stream truncated");
+    ok = false;
+  }
+  if (ok && P.imageSize && P.written != P.imageSize) {
+    Serial.printf("[OTA] image size %lu, expected %lu\n", (unsigned long)P.written, (unsigned long)P.imageSize);
+    ok = false;
+  }
+  if (ok && P.expectSha[0] && strcasecmp(P.expectSha, hex) != 0) {
+    Serial.printf("[OTA] sha256 mismatch, server says %s\n", P.expectSha);
+    ok = false;
+  }
+  if (ok) {
+    esp_err_t e = esp_ota_set_boot_partition(P.part);   // validates the image
+    if (e != ESP_OK) {
+      Serial.printf("[OTA] verify error: %s (size %lu)\n", esp_err_to_name(e), (unsigned long)P.written);
+      ok = false;
+    }
   }
+  // A bad image is not worth resuming; a link that gave up is
+  if (ok || r != RX_DROPPED) ckptClear();
+  sessionClose(P);
+  if (!ok) return false;
 
-  // 6) Success → show 100%, blink green, reboot
+  // 5) Success → show 100%, blink green, reboot
   otaShowProgress(100);
   side_blinkAll(/*green*/1, 140, 120);
   delay(200);
@@ -154,15 +587,26 @@ static bool doOtaFromUrl(const String& url) {
   return true; // not reached
 }
 
+bool Ota_joinWifi() {
+  WiFi.persistent(false);
+  WiFi.disconnect(true, true);
+  WiFi.mode(WIFI_STA);
+  WiFi.setSleep(false);
+  esp_wifi_set_ps(WIFI_PS_NONE);
+
+  Serial.printf("[OTA] STA connect → SSID='%s'\n", OTA_WIFI_SSID);
+  return joinWifi();
+}
+
 // --- Public wrapper (kept for compatibility) ---
-bool side_doOTA(const String& url) { return doOtaFromUrl(url); }
+bool side_doOTA(const char* url) { return doOtaFromUrl(url); }
 
 // --- Pump from loop() ---
 void Ota_loopTick() {
   if (!s_otaStartRequested) return;
   s_otaStartRequested = false;
 
-  if (!s_otaUrl.length()) {
+  if (!s_otaUrl[0]) {
     Serial.println("[OTA] No URL set");
     return;
   }
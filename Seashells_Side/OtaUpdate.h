@@ -5,8 +5,12 @@
 void side_setOtaUrl(const char* p, uint8_t n);
 void side_requestOtaStart();
 
+// Leave ESP-NOW's channel for the OTA hotspot (also used by AssetSync).
+// The caller restores GameBus afterwards unless it reboots.
+bool Ota_joinWifi();
+
 // If you ever want to kick an OTA directly:
-bool side_doOTA(const String& url);
+bool side_doOTA(const char* url);
 
 // Call this once near the top of loop(); it will run an OTA
 // if side_requestOtaStart() was called.
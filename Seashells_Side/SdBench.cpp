@@ -0,0 +1,144 @@
+#include "SdBench.h"
+#include "SdBus.h"
+#include "ConfigSide.h"
+#include <SD.h>
+#include <algorithm>
+
+static const char*     kBenchPath   = "/sdbench.bin";
+static constexpr size_t kBenchBytes = 2u * 1024u * 1024u;
+static constexpr size_t kMaxChunk   = 32u * 1024u;
+static constexpr size_t kMaxLat     = 512;        // latency samples kept per run
+static constexpr uint32_t kRunUs    = 150000;     // time box per run
+static constexpr size_t kRunBytes   = 512u * 1024u;
+
+static constexpr size_t kChunks[] = { 512, 1024, 2048, 4096, 8192, 16384, 32768 };
+static constexpr size_t kStreamChunk = 2048;      // one 1024-sample mono frame
+static constexpr float  kMargin      = 2.0f;      // required headroom over real-time
+
+struct BenchResult {
+  float    kbps  = 0.0f;
+  uint32_t p50   = 0, p99 = 0, maxUs = 0;
+  bool     ok    = false;
+};
+
+static uint8_t*  s_buf = nullptr;
+static uint32_t  s_lat[kMaxLat];
+
+static bool ensureBenchFile(Print& out) {
+  File f = SD.open(kBenchPath, FILE_READ);
+  if (f && f.size() >= kBenchBytes) { f.close(); return true; }
+  if (f) f.close();
+
+  out.printf("[BENCH] writing %s (%u KB)\n", kBenchPath, (unsigned)(kBenchBytes / 1024));
+  f = SD.open(kBenchPath, FILE_WRITE);
+  if (!f) return false;
+  for (size_t i = 0; i < kMaxChunk; ++i) s_buf[i] = (uint8_t)(i * 31u + 7u);
+  for (size_t off = 0; off < kBenchBytes; off += kMaxChunk) {
+    if (f.write(s_buf, kMaxChunk) != kMaxChunk) { f.close(); return false; }
+  }
+  f.close();
+  return true;
+}
+
+static void runOne(File* fs, uint8_t nFiles, size_t chunk, bool rnd, BenchResult& r) {
+  uint32_t pos[4];
+  for (uint8_t i = 0; i < nFiles; ++i) pos[i] = (uint32_t)(kBenchBytes / nFiles * i) & ~(uint32_t)(chunk - 1);
+
+  size_t nLat = 0, bytes = 0;
+  uint32_t maxUs = 0;
+  const uint32_t t0 = micros();
+  r.ok = true;
+  while (bytes < kRunBytes && micros() - t0 < kRunUs) {
+    for (uint8_t i = 0; i < nFiles; ++i) {
+      if (rnd) pos[i] = (uint32_t)random(kBenchBytes / chunk) * chunk;
+      else if (pos[i] + chunk > kBenchBytes) pos[i] = 0;
+
+      const uint32_t r0 = micros();
+      fs[i].seek(pos[i]);
+      size_t n = fs[i].read(s_buf, chunk);
+      const uint32_t dt = micros() - r0;
+      if (n != chunk) { r.ok = false; break; }
+
+      pos[i] += chunk;
+      bytes  += n;
+      if (dt > maxUs) maxUs = dt;
+      if (nLat < kMaxLat) s_lat[nLat++] = dt;
+    }
+    if (!r.ok) break;
+  }
+  const uint32_t el = micros() - t0;
+
+  r.kbps  = el ? bytes * 1000000.0f / el / 1024.0f : 0.0f;
+  r.maxUs = maxUs;
+  if (nLat) {
+    std::sort(s_lat, s_lat + nLat);
+    r.p50 = s_lat[nLat / 2];
+    r.p99 = s_lat[(nLat * 99) / 100];
+  }
+}
+
+void SdBench_run(Print& out) {
+  s_buf = (uint8_t*)ps_malloc(kMaxChunk);
+  if (!s_buf) { out.println("[BENCH] no PSRAM for buffer"); return; }
+
+  const float needKbps = 4.0f * SAMPLE_RATE * 2 / 1024.0f;
+  const float frameUs  = 1024.0f * 1000000.0f / SAMPLE_RATE;
+
+  SdBus_lock();
+  if (!ensureBenchFile(out)) {
+    out.println("[BENCH] cannot create bench file");
+    SdBus_unlock();
+    free(s_buf); s_buf = nullptr;
+    return;
+  }
+
+  out.printf("[BENCH] 4 streams need %.0f KB/s; pass = %.0fx that and max read < 1/4 frame (%.0f us)\n",
+             needKbps, kMargin, frameUs / 4);
+  out.println("#BENCH mhz mode files chunk kbps p50_us p99_us max_us");
+
+  bool     anyPass = false;
+  uint32_t bestHz  = 0;
+  for (uint8_t s = 0; s < SdBus_stepCount(); ++s) {
+    const uint32_t hz = SdBus_stepHz(s);
+    if (!SdBus_setClock(s)) { out.printf("[BENCH] %lu MHz: mount FAIL\n", (unsigned long)(hz / 1000000)); continue; }
+
+    File fs[4];
+    bool opened = true;
+    for (uint8_t i = 0; i < 4; ++i) { fs[i] = SD.open(kBenchPath, FILE_READ); if (!fs[i]) opened = false; }
+    if (!opened) {
+      out.printf("[BENCH] %lu MHz: open FAIL\n", (unsigned long)(hz / 1000000));
+      for (File& f : fs) if (f) f.close();
+      continue;
+    }
+
+    BenchResult stream;
+    for (uint8_t mode = 0; mode < 2; ++mode) {
+      for (uint8_t nf = 1; nf <= 4; ++nf) {
+        for (size_t chunk : kChunks) {
+          BenchResult r;
+          runOne(fs, nf, chunk, mode == 1, r);
+          out.printf("B %2lu %s %u %5u %7.0f %6lu %6lu %6lu%s\n", (unsigned long)(hz / 1000000),
+                     mode ? "rnd" : "seq", (unsigned)nf, (unsigned)chunk, r.kbps,
+                     (unsigned long)r.p50, (unsigned long)r.p99, (unsigned long)r.maxUs,
+                     r.ok ? "" : " READ-FAIL");
+          if (mode == 0 && nf == 4 && chunk == kStreamChunk) stream = r;
+        }
+        yield();
+      }
+    }
+    for (File& f : fs) f.close();
+
+    const bool pass = stream.ok && stream.kbps >= needKbps * kMargin && stream.maxUs < frameUs / 4;
+    out.printf("[BENCH] %2lu MHz streaming (4 x %u B): %.0f KB/s, max %lu us -> %s\n",
+               (unsigned long)(hz / 1000000), (unsigned)kStreamChunk, stream.kbps,
+               (unsigned long)stream.maxUs, pass ? "PASS" : "FAIL");
+    if (pass) { anyPass = true; bestHz = hz; }
+  }
+
+  SdBus_restoreClock();
+  SdBus_unlock();
+  free(s_buf); s_buf = nullptr;
+
+  if (anyPass) out.printf("[BENCH] verdict: PASS (up to %lu MHz)\n", (unsigned long)(bestHz / 1000000));
+  else         out.println("[BENCH] verdict: FAIL at every clock");
+}
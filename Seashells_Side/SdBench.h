@@ -0,0 +1,14 @@
+#pragma once
+#include <Arduino.h>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// SD card qualification benchmark (serial 'b').
+//
+// For every clock step: sequential and random reads, chunk sizes 512 B..32 KB,
+// 1..4 handles read round-robin the way the channels stream. Prints KB/s and
+// p50/p99/max per-read latency, then a PASS/FAIL verdict per clock for the
+// streaming case (4 handles, one frame per read) against the bandwidth four
+// channels need at SAMPLE_RATE. Audio stops while it runs (~1-2 min).
+// ─────────────────────────────────────────────────────────────────────────────
+
+void SdBench_run(Print& out);
@@ -0,0 +1,322 @@
+#include "SdBus.h"
+#include "AudioEngine.h"
+#include <Preferences.h>
+#include "freertos/FreeRTOS.h"
+#include "freertos/semphr.h"
+#include "freertos/task.h"
+
+static SemaphoreHandle_t s_mutex = nullptr;
+static TaskHandle_t      s_worker = nullptr;
+static volatile bool     s_forceRemount = false;
+static volatile uint32_t s_lastFaultMs = 0;
+static volatile bool     s_chunkHeld = false;   // a background loader has the bus for one chunk
+
+// Worker notification bits
+static constexpr uint32_t kNotifyRecover  = 1u << 0;
+static constexpr uint32_t kNotifySelfTest = 1u << 1;
+
+// Serial 's' self-test, run by the worker
+static char   s_testPath[ASSET_PATH_MAX] = "";
+static Print* s_testOut = nullptr;
+static volatile bool s_testRunning = false;
+
+static constexpr uint32_t kBackoffMinMs = 50;
+static constexpr uint32_t kBackoffMaxMs = 2000;
+
+// ───────────────── Clock governor state ─────────────────
+
+static constexpr uint8_t kStepMHz[] = { 4, 8, 12, 16, 20, 26, 32, 40 };
+static constexpr uint8_t kNumSteps  = sizeof(kStepMHz);
+static constexpr uint8_t kBootStep  = 2;   // setup() mounts at 12 MHz
+
+struct StepStats {
+  uint32_t reads = 0, errors = 0, retries = 0;
+  uint32_t latEwmaUs = 0;                    // per read, 1/16 EWMA
+};
+static StepStats s_stats[kNumSteps];
+static uint8_t   s_step    = kBootStep;
+static uint8_t   s_ceiling = kNumSteps - 1;  // lowered when a step misbehaves
+static uint32_t  s_winReads = 0, s_winErrors = 0, s_winRetries = 0;
+static char      s_prefKey[12] = "";
+
+static inline uint32_t stepHz(uint8_t s) { return (uint32_t)kStepMHz[s] * 1000000u; }
+
+static inline bool isSdChannel(const Channel& C) {
+  return !C.useRAM && !C.isTone && C.path()[0];
+}
+
+// Caller holds the bus. Mount at the current step, falling back one step at
+// a time (and lowering the ceiling) if the card will not come up.
+static bool remountLocked() {
+  for (;;) {
+    if (remountSD(stepHz(s_step))) return true;
+    if (s_step == 0) return false;
+    s_ceiling = --s_step;
+  }
+}
+
+static void persistStep() {
+  if (!s_prefKey[0]) return;
+  Preferences p;
+  p.begin("sdgov", false);
+  p.putUChar(s_prefKey, s_step);
+  p.end();
+}
+
+// Caller holds the bus. Remount and reopen every SD channel at its cursor.
+static bool remountAndReopenLocked() {
+  if (!remountLocked()) return false;
+  bool ok = true;
+  for (int i = 0; i < 4; ++i) {
+    if (!isSdChannel(ch[i])) continue;
+    if (!reopenAtCursor(ch[i], i)) { ch[i].sd.fault = true; ok = false; }
+  }
+  return ok;
+}
+
+// Caller holds the bus. Returns true when no SD channel is left faulted.
+static bool recoverLocked() {
+  bool pending = false;
+  for (int i = 0; i < 4; ++i) {
+    if (ch[i].sd.fault && isSdChannel(ch[i])) pending = true;
+    else ch[i].sd.fault = false;
+  }
+  if (!pending) return true;
+
+  // Cheap first: a bad handle often just needs reopening
+  bool ok = !s_forceRemount;
+  if (ok) {
+    for (int i = 0; i < 4; ++i) {
+      if (ch[i].sd.fault && !reopenAtCursor(ch[i], i)) { ok = false; break; }
+    }
+    if (ok) return true;
+  }
+
+  // Remount invalidates every open handle, so reopen all SD channels. Read
+  // errors at this clock: take the remount as the chance to step down now.
+  s_forceRemount = false;
+  if (SD_GOV_ENABLE && s_winErrors && s_step > 0) {
+    s_ceiling = --s_step;
+    s_winReads = s_winErrors = s_winRetries = 0;
+    Serial.printf("[SDGOV] -> %u MHz (read errors)\n", (unsigned)kStepMHz[s_step]);
+    persistStep();
+  }
+  return remountAndReopenLocked();
+}
+
+// Caller holds the bus. Judge the current window and move one step if needed.
+// Clock changes need a remount, so they wait until no SD channel is streaming.
+static void governLocked() {
+  int8_t dir = 0;
+  if (s_winErrors || (uint64_t)s_winRetries * 100 > (uint64_t)s_winReads * SD_GOV_RETRY_PCT) {
+    if (s_step > 0) dir = -1;
+  } else if (s_winReads >= SD_GOV_WINDOW_READS && s_step < s_ceiling &&
+             kStepMHz[s_step + 1] <= SD_GOV_MAX_MHZ) {
+    dir = +1;
+  }
+  if (!dir) {
+    if (s_winReads >= SD_GOV_WINDOW_READS) s_winReads = s_winErrors = s_winRetries = 0;
+    return;
+  }
+
+  for (int i = 0; i < 4; ++i) {
+    if (isSdChannel(ch[i]) && ch[i].state != IDLE) return;   // keep the verdict for later
+  }
+
+  const uint8_t from = s_step;
+  if (dir < 0) s_ceiling = s_step - 1;   // don't climb back into trouble
+  s_step = (uint8_t)(s_step + dir);
+  remountAndReopenLocked();
+  s_winReads = s_winErrors = s_winRetries = 0;
+  if (s_step != from) {
+    Serial.printf("[SDGOV] %u -> %u MHz (%s)\n", (unsigned)kStepMHz[from], (unsigned)kStepMHz[s_step],
+                  dir > 0 ? "clean window" : "errors/retries");
+    persistStep();
+  }
+}
+
+static void selfTest();
+
+static void workerTask(void*) {
+  for (;;) {
+    uint32_t bits = 0;
+    xTaskNotifyWait(0, UINT32_MAX, &bits, pdMS_TO_TICKS(SD_GOV_PERIOD_MS));
+
+    if (bits & kNotifyRecover) {
+      uint32_t t0 = millis();
+      s_lastFaultMs = t0 ? t0 : 1;
+      uint32_t backoff = kBackoffMinMs;
+      uint16_t attempts = 0;
+      for (;;) {
+        vTaskDelay(pdMS_TO_TICKS(backoff));   // let a glitching card settle
+        attempts++;
+        xSemaphoreTake(s_mutex, portMAX_DELAY);
+        bool ok = recoverLocked();
+        xSemaphoreGive(s_mutex);
+        if (ok) break;
+        backoff = min(backoff * 2, kBackoffMaxMs);
+      }
+      Serial.printf("[SD] recovered in %lu ms (%u attempt%s)\n",
+                    (unsigned long)(millis() - t0), (unsigned)attempts, attempts == 1 ? "" : "s");
+    }
+    if (bits & kNotifySelfTest) { selfTest(); s_testRunning = false; }
+
+    if (SD_GOV_ENABLE) {
+      xSemaphoreTake(s_mutex, portMAX_DELAY);
+      governLocked();
+      xSemaphoreGive(s_mutex);
+    }
+  }
+}
+
+void SdBus_begin() {
+  s_mutex = xSemaphoreCreateMutex();
+
+  if (SD_GOV_ENABLE) {
+    // One remembered step per card, keyed by its size and type
+    uint64_t sz = SD.cardSize();
+    uint32_t h = (uint32_t)sz ^ (uint32_t)(sz >> 32) ^ ((uint32_t)SD.cardType() * 0x9E3779B9u);
+    snprintf(s_prefKey, sizeof(s_prefKey), "c%08lx", (unsigned long)h);
+
+    Preferences p;
+    p.begin("sdgov", true);
+    uint8_t saved = p.getUChar(s_prefKey, kBootStep);
+    p.end();
+    if (saved < kNumSteps && saved != s_step && kStepMHz[saved] <= SD_GOV_MAX_MHZ) {
+      s_step = saved;
+      if (!remountLocked()) { s_step = kBootStep; remountSD(stepHz(s_step)); }
+    }
+    Serial.printf("[SDGOV] card %s at %u MHz\n", s_prefKey, (unsigned)kStepMHz[s_step]);
+  }
+
+  xTaskCreatePinnedToCore(workerTask, "sdrecover", 4096, nullptr, 1, &s_worker, 0);
+}
+
+// A background chunk is released within a few ms and the DMA ring covers
+// that; recovery or scene setup holding the bus still means silence.
+bool SdBus_tryLock() {
+  if (xSemaphoreTake(s_mutex, 0) == pdTRUE) return true;
+  return s_chunkHeld && xSemaphoreTake(s_mutex, pdMS_TO_TICKS(SD_BG_WAIT_MS)) == pdTRUE;
+}
+void SdBus_lock()    { xSemaphoreTake(s_mutex, portMAX_DELAY); }
+void SdBus_unlock()  { xSemaphoreGive(s_mutex); }
+
+void SdBus_lockChunk() {
+  SdBus_lock();
+  s_chunkHeld = true;
+}
+
+void SdBus_unlockChunk() {
+  s_chunkHeld = false;
+  SdBus_unlock();
+  vTaskDelay(1);   // the loop task may be waiting; don't take the bus straight back
+}
+
+void SdBus_noteRead(uint32_t us, bool retried) {
+  StepStats& s = s_stats[s_step];
+  s.reads++;
+  s.latEwmaUs = s.latEwmaUs ? s.latEwmaUs + (int32_t)(us - s.latEwmaUs) / 16 : us;
+  s_winReads++;
+  if (retried) { s.retries++; s_winRetries++; }
+}
+
+void SdBus_noteError() {
+  s_stats[s_step].errors++;
+  s_winErrors++;
+}
+
+void SdBus_requestRecovery() {
+  if (s_worker) xTaskNotify(s_worker, kNotifyRecover, eSetBits);
+}
+
+uint8_t SdBus_injectFault() {
+  SdBus_lock();
+  uint8_t n = 0;
+  for (int i = 0; i < 4; ++i) {
+    if (isSdChannel(ch[i])) { ch[i].sd.fault = true; n++; }
+  }
+  s_forceRemount = true;
+  SdBus_unlock();
+  Serial.printf("[SD] injected fault on %u channel%s\n", (unsigned)n, n == 1 ? "" : "s");
+  SdBus_requestRecovery();
+  return n;
+}
+
+uint8_t  SdBus_stepCount()          { return kNumSteps; }
+uint32_t SdBus_stepHz(uint8_t step) { return stepHz(step < kNumSteps ? step : kNumSteps - 1); }
+bool     SdBus_setClock(uint8_t step) { return remountSD(SdBus_stepHz(step)); }
+void     SdBus_restoreClock()       { remountAndReopenLocked(); }
+
+// Recent faults weigh most, then running below the boot clock, then retries
+uint8_t SdBus_health() {
+  int h = 100;
+  const uint32_t lf = s_lastFaultMs;
+  if (lf && millis() - lf < 60000u) h -= 50;
+  if (s_step < kBootStep) h -= 15 * (kBootStep - s_step);
+  const StepStats& s = s_stats[s_step];
+  if (s.reads) h -= (int)min<uint32_t>(30, s.retries * 1000u / s.reads);   // 3 pts per 0.1% retried
+  return (uint8_t)constrain(h, 0, 100);
+}
+
+// ───────────────── Status & self-test ─────────────────
+
+// Worker task. Streams the file once in frame-sized reads for about a second,
+// taking the bus per read like a background loader, so slots keep streaming
+// in between. The rate counts time inside reads only (the card, not the
+// yields between them).
+static void selfTest() {
+  Print& out = *s_testOut;
+  static uint8_t buf[2048];
+  SdBus_lockChunk();
+  File f = SD.open(s_testPath, FILE_READ);
+  SdBus_unlockChunk();
+  if (!f) {
+    out.printf("[SDGOV] self-test: cannot open %s\n", s_testPath);
+    return;
+  }
+  uint32_t bytes = 0, worstUs = 0, readUs = 0;
+  const uint32_t t0 = millis();
+  while (millis() - t0 < 1000u) {
+    SdBus_lockChunk();
+    const uint32_t r0 = micros();
+    size_t n = f.read(buf, sizeof(buf));
+    const uint32_t dt = micros() - r0;
+    const bool rewound = n || f.seek(0);
+    SdBus_unlockChunk();
+    if (!rewound) break;
+    if (n == 0) continue;
+    bytes += n;
+    readUs += dt;
+    if (dt > worstUs) worstUs = dt;
+  }
+  SdBus_lockChunk();
+  f.close();
+  SdBus_unlockChunk();
+  const float kbps = readUs ? bytes * 1000000.0f / readUs / 1024.0f : 0.0f;
+  const float need = 4.0f * SAMPLE_RATE * 2 / 1024.0f;
+  out.printf("[SDGOV] self-test %s: %.0f KB/s (4 streams need %.0f KB/s), worst read %lu us\n",
+             s_testPath, kbps, need, (unsigned long)worstUs);
+}
+
+void SdBus_report(Print& out, const char* path) {
+  SdBus_lock();
+  out.printf("[SDGOV] now %u MHz, ceiling %u MHz, window %lu reads / %lu retries / %lu errors\n",
+             (unsigned)kStepMHz[s_step], (unsigned)kStepMHz[s_ceiling],
+             (unsigned long)s_winReads, (unsigned long)s_winRetries, (unsigned long)s_winErrors);
+  for (uint8_t i = 0; i < kNumSteps; ++i) {
+    const StepStats& s = s_stats[i];
+    if (!s.reads && !s.errors) continue;
+    out.printf("  %2u MHz: reads=%lu retries=%lu errors=%lu lat=%lu us\n", (unsigned)kStepMHz[i],
+               (unsigned long)s.reads, (unsigned long)s.retries, (unsigned long)s.errors,
+               (unsigned long)s.latEwmaUs);
+  }
+
+  SdBus_unlock();
+
+  // The throughput test runs on the worker, so this loop keeps rendering
+  if (s_testRunning || !s_worker) return;
+  s_testRunning = true;
+  snprintf(s_testPath, sizeof(s_testPath), "%s", path);
+  s_testOut = &out;
+  xTaskNotify(s_worker, kNotifySelfTest, eSetBits);
+}
@@ -0,0 +1,50 @@
+#pragma once
+#include <Arduino.h>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// SD bus ownership and background fault recovery.
+//
+// The audio path never waits on the card: it only try-locks the bus and plays
+// silence for SD channels when recovery holds it. A background load's chunk
+// is the one hold it waits out, for at most SD_BG_WAIT_MS. A failed read marks the
+// channel's TrackSD::fault and wakes the worker task, which reopens the file
+// (remounting the card if needed) with exponential backoff. Faulted channels
+// keep their cursor, so streaming resumes where it stopped; RAM and tone
+// channels never touch the bus and keep rendering throughout.
+//
+// The worker also governs the SPI clock: reads are timed per clock step, the
+// clock steps up after a clean window and down as soon as errors or retries
+// rise, and the chosen step is remembered per card in NVS ("sdgov").
+// ─────────────────────────────────────────────────────────────────────────────
+
+void SdBus_begin();              // after SD.begin(); starts the recovery worker
+
+bool SdBus_tryLock();            // audio path: only waits out a background chunk (SD_BG_WAIT_MS)
+void SdBus_lock();               // scene setup / cache loads: waits for recovery
+void SdBus_unlock();
+
+// Background loaders (precache task): hold the bus for one SD_BG_CHUNK_BYTES
+// read at a time. Unlocking yields, so a waiting scene setup gets the bus next.
+void SdBus_lockChunk();
+void SdBus_unlockChunk();
+
+void SdBus_noteRead(uint32_t us, bool retried);   // audio path, bus held
+void SdBus_noteError();                            // audio path, bus held
+
+void SdBus_requestRecovery();    // a channel's TrackSD::fault was just set
+uint8_t SdBus_injectFault();     // serial 'f': fault every SD channel and force a remount; channels hit
+
+// 0..100 summary of SD bus health for the Master (100 = clean, full speed)
+uint8_t SdBus_health();
+
+// Serial 's': governor state and per-step stats now; a 1 s read-throughput
+// test on path follows from the worker task, which takes the bus per read
+// so streaming slots keep playing
+void SdBus_report(Print& out, const char* path);
+
+// Clock steps for SdBench. The caller holds the bus (SdBus_lock) throughout;
+// SdBus_restoreClock returns to the governor's step and reopens SD channels.
+uint8_t  SdBus_stepCount();
+uint32_t SdBus_stepHz(uint8_t step);
+bool     SdBus_setClock(uint8_t step);
+void     SdBus_restoreClock();
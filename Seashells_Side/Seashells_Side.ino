@@ -3,17 +3,30 @@
   - Keeps the known-good audio/LED pipeline
   - Adds: Manifest CSV loader, ESP-NOW GameBus, GameMode gating, Loop-all for "announce"
   - Now with synthetic tones for base=tones (no WAV needed)
+
+  Serial:
+    't' => dump the binary event trace ('T' clears it); merge with tools/trace_merge.py
+    'm' => benchmark per-slot LED metering cost vs. the frame budget
+    'v' => verify cached tone periods bit-for-bit against real-time synthesis
+    'f' => inject an SD fault on every streaming slot (exercises background recovery);
+           with the slots playing, prints PASS/FAIL for render-loop stalls once recovered
+    's' => SD clock governor status plus a quick read-throughput self-test
+    'b' => full SD qualification benchmark at every clock (audio stops while it runs)
+    'w' => record the output to /sd/render.wav instead of the speakers ('w' again stops)
+    'p' => benchmark one-shot voice mixing cost per extra voice vs. the frame budget
+    'y' => sync SD assets from the last index URL (ASSET_INDEX_URL until the Master sends one)
+    'r' => hot-reload /manifest.csv; only changed precached clips are re-read
+    'i' => idle governor: time gated/asleep and wake-to-first-sample latency
+    'h' => heap: free / low-water per heap and allocations since the last scene
 */
 
 #include <Arduino.h>
 #include <SPI.h>
 #include <SD.h>
-#include <Adafruit_NeoPixel.h>
 #include <math.h>
 #include <esp_wifi.h>
 #include <HTTPClient.h>
 #include <Update.h>
-#include "driver/i2s.h"
 
 #include "ConfigSide.h"
 #include "Messages.h"
@@ -21,19 +34,25 @@
 #include "GameBusSide.h"
 #include "Role.h"
 #include "AudioEngine.h"
+#include "AudioOutput.h"
+#include "VoicePool.h"
 #include "OtaUpdate.h"
+#include "FwRelay.h"
+#include "AssetSync.h"
+#include "Trace.h"
+#include "LedFx.h"
+#include "Meter.h"
+#include "ClipSource.h"
+#include "ToneCache.h"
+#include "SdBus.h"
+#include "SdBench.h"
+#include "Soundbank.h"
+#include "IdleGovernor.h"
+#include "HeapStats.h"
 
 // Master trim for this side (in dB). Use 0 for unity, negatives to reduce.
 #define MASTER_GAIN_DB -20
 
-// ======= RGB setup =======
-#define NUM_LEDS_PER  1
-Adafruit_NeoPixel rgb1(NUM_LEDS_PER, RGB1_PIN, NEO_GRB + NEO_KHZ800);
-Adafruit_NeoPixel rgb2(NUM_LEDS_PER, RGB2_PIN, NEO_GRB + NEO_KHZ800);
-Adafruit_NeoPixel rgb3(NUM_LEDS_PER, RGB3_PIN, NEO_GRB + NEO_KHZ800);
-Adafruit_NeoPixel rgb4(NUM_LEDS_PER, RGB4_PIN, NEO_GRB + NEO_KHZ800);
-Adafruit_NeoPixel* const RGBT[4] = { &rgb1, &rgb2, &rgb3, &rgb4 };
-
 // Buttons
 const uint8_t BTN_PINS[4] = { BTN1_PIN, BTN2_PIN, BTN3_PIN, BTN4_PIN };
 bool     lastRaw[4]      = { false,false,false,false };
@@ -52,90 +71,22 @@ int16_t tmpMono[4][FRAME_SAMPLES]; // per-channel mono working buffers
 uint8_t outLR0[OUT_BYTES];         // I2S0 interleaved L/R frame
 uint8_t outLR1[OUT_BYTES];         // I2S1 interleaved L/R frame
 
+// Output backend; the render loop runs when it has room for a whole frame
+static AudioOutput* g_out = nullptr;
+
 // Game mode gating
 static bool gameMode = false;      // when true, we don't auto-play on press; we only send BTN_EVENT
 static uint16_t curSlotIds[4] = {0,0,0,0}; // current clip ID per slot
 
-// ---- Blink controller (non-blocking) ----
-struct BlinkCtrl {
-  bool     active   = false;
-  bool     phaseOn  = false;
-  uint8_t  color    = 0;     // 0=red, 1=green, 2=white
-  uint8_t  remaining= 0;     // on->off transitions left
-  uint16_t on_ms    = 0;
-  uint16_t off_ms   = 0;
-  uint32_t nextMs   = 0;
-} blink;
-
-static inline void ledsAllColor(uint8_t r,uint8_t g,uint8_t b){
-  for (int i=0;i<4;i++) RGBT[i]->setPixelColor(0, RGBT[i]->Color(r,g,b));
-  for (int i=0;i<4;i++) RGBT[i]->show();
-}
-
-static inline void ledsAllOff(){
-  for (int i=0;i<4;i++) RGBT[i]->setPixelColor(0, 0);
-  for (int i=0;i<4;i++) RGBT[i]->show();
-}
-
-static void blinkStart(uint8_t color, uint16_t on_ms, uint16_t off_ms, uint8_t reps=3){
-  blink.active = true;
-  blink.phaseOn = true;
-  blink.color = color;
-  blink.on_ms = on_ms;
-  blink.off_ms= off_ms;
-  blink.remaining = reps;
-
-  uint8_t r=(color==0||color==2)?255:0;
-  uint8_t g=(color==1||color==2)?255:0;
-  uint8_t b=(color==2)?255:0;
-  ledsAllColor(r,g,b);
-  blink.nextMs = millis() + blink.on_ms;
-}
-
-static void blinkStop(){
-  blink.active = false;
-  blink.phaseOn = false;
-  blink.remaining = 0;
-  ledsAllOff();
-}
-
-static void blinkUpdate(){
-  if (!blink.active) return;
-  if (millis() < blink.nextMs) return;
-
-  if (blink.phaseOn) {
-    ledsAllOff();
-    blink.phaseOn = false;
-    blink.nextMs = millis() + blink.off_ms;
-    if (blink.remaining) {
-      if (--blink.remaining == 0) {
-        blink.active = false;
-      }
-    }
-  } else {
-    uint8_t r=(blink.color==0||blink.color==2)?255:0;
-    uint8_t g=(blink.color==1||blink.color==2)?255:0;
-    uint8_t b=(blink.color==2)?255:0;
-    ledsAllColor(r,g,b);
-    blink.phaseOn = true;
-    blink.nextMs = millis() + blink.on_ms;
-  }
-}
+// Slots waiting for their first non-silent sample since PLAY/START_LOOP (trace only)
+static bool firstAudioArmed[4] = {false,false,false,false};
 
 // Show OTA progress across 4 pixels in CYAN (0..100%)
-void otaShowProgress(uint8_t pct) {
-  for (int i=0;i<4;i++) { RGBT[i]->setPixelColor(0, 0); }
-  uint8_t lit = (pct >= 100) ? 4 : (pct / 25);
-  for (uint8_t i=0; i<lit; i++) {
-    RGBT[i]->setPixelColor(0, RGBT[i]->Color(0, 255, 255)); // CYAN
-  }
-  for (int i=0;i<4;i++) RGBT[i]->show();
-}
+void otaShowProgress(uint8_t pct) { LedFx_progress(pct); }
 
 // ======= Helpers: LEDs =======
-static inline void ledOff(uint8_t i){ RGBT[i]->setPixelColor(0, 0); RGBT[i]->show(); }
-static inline void ledWhite(uint8_t i){ RGBT[i]->setPixelColor(0, RGBT[i]->Color(255,255,255)); RGBT[i]->show(); }
-static inline void ledColorAll(uint8_t r,uint8_t g,uint8_t b){ for(int i=0;i<4;i++){ RGBT[i]->setPixelColor(0, RGBT[i]->Color(r,g,b)); } for(int i=0;i<4;i++) RGBT[i]->show(); }
+static inline void ledOff(uint8_t i){ LedFx_setPixel(i, 0, 0, 0); }
+static inline void ledWhite(uint8_t i){ LedFx_setPixel(i, 255, 255, 255); }
 
 // Configure a tone channel based on ClipMeta base/sub/sub2
 static void configureToneChannel(Channel& C, const ClipMeta* cm, int slotIdx) {
@@ -147,38 +98,35 @@ static void configureToneChannel(Channel& C, const ClipMeta* cm, int slotIdx) {
   C.toneSweepPos = 0.0f;
   C.toneSweepRate = 0.0f;
   C.tonePatternSamples = 0;
-  C.path = "";
+  C.clip = nullptr;
   C.useRAM = false;
   if (C.sd.f) C.sd.f.close();
 
   // Default mapping for base=tones
-  String sub  = cm->sub;
-  String sub2 = cm->sub2;
-
-  sub.toLowerCase();
-  sub2.toLowerCase();
+  const char* sub  = cm->sub;
+  const char* sub2 = cm->sub2;
 
-  if (sub == "simple") {
+  if (!strcasecmp(sub, "simple")) {
     C.toneMode = TONE_SIMPLE;
-    if (sub2 == "low_beep") {
+    if (!strcasecmp(sub2, "low_beep")) {
       C.toneFreq1 = 600.0f;
-    } else if (sub2 == "mid_beep") {
+    } else if (!strcasecmp(sub2, "mid_beep")) {
       C.toneFreq1 = 1000.0f;
-    } else if (sub2 == "high_beep") {
+    } else if (!strcasecmp(sub2, "high_beep")) {
       C.toneFreq1 = 1600.0f;
     } else {
       C.toneFreq1 = 1000.0f;
     }
-  } else if (sub == "sweep") {
-    if (sub2 == "up_short") {
+  } else if (!strcasecmp(sub, "sweep")) {
+    if (!strcasecmp(sub2, "up_short")) {
       C.toneMode = TONE_SWEEP_UP;
       C.toneFreq1 = 400.0f;
       C.toneFreq2 = 1400.0f;
-    } else if (sub2 == "down_short") {
+    } else if (!strcasecmp(sub2, "down_short")) {
       C.toneMode = TONE_SWEEP_DOWN;
       C.toneFreq1 = 1400.0f;
       C.toneFreq2 = 400.0f;
-    } else if (sub2 == "siren_slow") {
+    } else if (!strcasecmp(sub2, "siren_slow")) {
       C.toneMode = TONE_SIREN;
       C.toneFreq1 = 500.0f;
       C.toneFreq2 = 1200.0f;
@@ -187,13 +135,13 @@ static void configureToneChannel(Channel& C, const ClipMeta* cm, int slotIdx) {
       C.toneFreq1 = 500.0f;
       C.toneFreq2 = 1500.0f;
     }
-  } else if (sub == "noise") {
+  } else if (!strcasecmp(sub, "noise")) {
     C.toneMode = TONE_NOISE;
-  } else if (sub == "rhythm") {
-    if (sub2 == "double_click") {
+  } else if (!strcasecmp(sub, "rhythm")) {
+    if (!strcasecmp(sub2, "double_click")) {
       C.toneMode = TONE_DOUBLE_CLICK;
       C.toneFreq1 = 1200.0f;
-    } else if (sub2 == "triple_beep") {
+    } else if (!strcasecmp(sub2, "triple_beep")) {
       C.toneMode = TONE_TRIPLE_BEEP;
       C.toneFreq1 = 1000.0f;
     } else {
@@ -206,41 +154,81 @@ static void configureToneChannel(Channel& C, const ClipMeta* cm, int slotIdx) {
     C.toneFreq1 = 1000.0f;
   }
 
-  Serial.printf("[SCENE] slot %d: id=%u TONE base=%s sub=%s sub2=%s f1=%.1f f2=%.1f mode=%d\n",
+  if (TONE_CACHE_ENABLE) {
+    int16_t* buf = nullptr;
+    size_t   samples = 0;
+    if (ToneCache_get(cm->id, C, &buf, &samples)) {
+      C.useRAM       = true;
+      C.ram.data     = buf;
+      C.ram.samples  = samples;
+      C.ram.seamless  = true;   // exactly one period: wraps without a seam
+      C.ram.loopStart = 0;
+      C.ram.loopEnd   = samples;
+      C.ram.xfade     = 0;
+    }
+  }
+
+  if (SCENE_LOG_VERBOSE) Serial.printf("[SCENE] slot %d: id=%u TONE base=%s sub=%s sub2=%s f1=%.1f f2=%.1f mode=%d\n",
                 slotIdx,
                 (unsigned)cm->id,
-                cm->base.c_str(),
-                cm->sub.c_str(),
-                cm->sub2.c_str(),
+                cm->base,
+                cm->sub,
+                cm->sub2,
                 C.toneFreq1,
                 C.toneFreq2,
                 (int)C.toneMode);
 }
 
+static int countInScene(const uint16_t ids[4], uint16_t id) {
+  int n = 0;
+  for (int i = 0; i < 4; ++i) if (ids[i] == id) n++;
+  return n;
+}
+
 void side_setScene(uint16_t ids[4]) {
+  Manifest_precacheHint(ids);   // still warming: this scene's clips are read next
+  HeapStats_mark();   // serial 'h': the commit below is reported on its own line
+
+  // Opens and PSRAM loads below use the card; wait out any recovery in progress
+  SdBus_lock();
+
+  // A staged manifest reload goes live here, before any slot looks up its clip.
+  // Under the bus lock: the SdBus worker reopens streams by their clip handle,
+  // and every handle is reassigned below. Only one-shots could still hold a buffer.
+  if (Manifest_reloadPending()) {
+    VoicePool_stopAll();
+    Manifest_applyReload();
+  }
+
+  // Shared sources of the previous scene are released only after the new one
+  // has acquired its own, so an ID that stays in the scene is not re-read.
+  uint16_t prevShared[4];
+  for (int i = 0; i < 4; ++i) { prevShared[i] = ch[i].sharedId; ch[i].sharedId = 0; }
+
   for (int i = 0; i < 4; ++i) {
     curSlotIds[i] = ids[i];
 
     // Reset base state
     ch[i].idx   = 0;
     ch[i].state = IDLE;
+    ch[i].sd.fault = false;   // a fresh open below replaces any faulted stream
 
     // No assignment → silence this slot cleanly
     if (ids[i] == 0) {
       if (ch[i].sd.f) ch[i].sd.f.close();
-      ch[i].path   = "";
+      ch[i].clip   = nullptr;
       ch[i].useRAM = false;
       ch[i].isTone = false;
       ch[i].toneMode = TONE_NONE;
       ch[i].gainQ15 = masterGainQ15;  // just master trim
-      Serial.printf("[SCENE] slot %d: id=0 (cleared)\n", i);
+      if (SCENE_LOG_VERBOSE) Serial.printf("[SCENE] slot %d: id=0 (cleared)\n", i);
       continue;
     }
 
     const ClipMeta* cm = Manifest_find(ids[i]);
     if (!cm) {
       if (ch[i].sd.f) ch[i].sd.f.close();
-      ch[i].path   = "";
+      ch[i].clip   = nullptr;
       ch[i].useRAM = false;
       ch[i].isTone = false;
       ch[i].toneMode = TONE_NONE;
@@ -254,7 +242,7 @@ void side_setScene(uint16_t ids[4]) {
     ch[i].gainQ15 = q15_mul(masterGainQ15, clipQ);
 
     // If this is a synthetic tone, configure tone channel and skip SD
-    if (cm->base.equalsIgnoreCase("tones")) {
+    if (!strcasecmp(cm->base, "tones")) {
       configureToneChannel(ch[i], cm, i);
       continue;
     }
@@ -267,30 +255,78 @@ void side_setScene(uint16_t ids[4]) {
     ch[i].toneSweepRate = 0.0f;
     ch[i].tonePatternSamples = 0;
 
-    ch[i].path = cm->path;
+    ch[i].clip = cm;
 
-    // Prefer PSRAM cache, else SD
+    // Prefer flash soundbank / PSRAM cache, then a shared PSRAM copy, else SD
     int16_t* buf = nullptr;
+    const int16_t* bank = nullptr;
     size_t   samples = 0;
-    if (Manifest_getCached(ids[i], &buf, &samples) && buf && samples > 0) {
+    uint32_t loopStart = 0, loopEnd = 0;
+    uint16_t xfade = 0;
+    if (Soundbank_get(ids[i], &bank, &samples, &loopStart, &loopEnd, &xfade) && samples > 0) {
+      if (ch[i].sd.f) ch[i].sd.f.close();
+      ch[i].useRAM        = true;
+      ch[i].ram.data      = bank;
+      ch[i].ram.samples   = samples;
+      ch[i].ram.seamless  = (loopEnd != 0);
+      ch[i].ram.loopStart = loopStart;
+      ch[i].ram.loopEnd   = loopEnd;
+      ch[i].ram.xfade     = xfade;
+      if (SCENE_LOG_VERBOSE) Serial.printf("[SCENE] slot %d: id=%u FLASH (%s)\n", i, (unsigned)ids[i], ch[i].path());
+    } else if (Manifest_getCached(ids[i], &buf, &samples, &loopStart, &loopEnd, &xfade) && buf && samples > 0) {
       if (ch[i].sd.f) ch[i].sd.f.close();
-      ch[i].useRAM       = true;
-      ch[i].ram.data     = buf;
-      ch[i].ram.samples  = samples;
-      Serial.printf("[SCENE] slot %d: id=%u RAM OK (%s)\n", i, (unsigned)ids[i], ch[i].path.c_str());
+      ch[i].useRAM        = true;
+      ch[i].ram.data      = buf;
+      ch[i].ram.samples   = samples;
+      ch[i].ram.seamless  = (loopEnd != 0);
+      ch[i].ram.loopStart = loopStart;
+      ch[i].ram.loopEnd   = loopEnd;
+      ch[i].ram.xfade     = xfade;
+      if (SCENE_LOG_VERBOSE) Serial.printf("[SCENE] slot %d: id=%u RAM OK (%s)\n", i, (unsigned)ids[i], ch[i].path());
     } else {
+      // Same clip in several slots: one PSRAM copy, independent cursors. It is
+      // filled in the background; until then the slot streams and
+      // adoptSharedClips() moves it over.
+      if (countInScene(ids, ids[i]) > 1 && ClipSource_acquire(ids[i], cm->path, cm->trimStart, cm->trimEnd)) {
+        ch[i].sharedId = ids[i];
+      }
+      const int16_t* shared = nullptr;
+      uint32_t sharedTrim = 0;
+      if (ch[i].sharedId &&
+          ClipSource_ready(ids[i], &shared, &samples, &loopStart, &loopEnd, &xfade, &sharedTrim)) {
+        if (ch[i].sd.f) ch[i].sd.f.close();
+        ch[i].useRAM        = true;
+        ch[i].ram.data      = shared;
+        ch[i].ram.samples   = samples;
+        ch[i].ram.seamless  = (loopEnd != 0);
+        ch[i].ram.loopStart = loopStart;
+        ch[i].ram.loopEnd   = loopEnd;
+        ch[i].ram.xfade     = xfade;
+        if (SCENE_LOG_VERBOSE) Serial.printf("[SCENE] slot %d: id=%u SHARED (%s)\n", i, (unsigned)ids[i], ch[i].path());
+        continue;
+      }
       ch[i].useRAM = false;
+      ch[i].sd.trimStart = TRIM_ENABLE ? cm->trimStart : 0;
+      ch[i].sd.trimEnd   = TRIM_ENABLE ? cm->trimEnd   : 0;
       if (!openForSD(ch[i], i)) {
-        ch[i].path = "";
+        ch[i].clip = nullptr;
         if (ch[i].sd.f) ch[i].sd.f.close();
         Serial.printf("[SCENE] slot %d: id=%u SD OPEN FAIL\n", i, (unsigned)ids[i]);
       } else {
         ch[i].sd.cur = 0;
         if (ch[i].sd.f) ch[i].sd.f.seek(ch[i].sd.dataStart);
-        Serial.printf("[SCENE] slot %d: id=%u SD OK (%s)\n", i, (unsigned)ids[i], ch[i].path.c_str());
+        if (SCENE_LOG_VERBOSE) Serial.printf("[SCENE] slot %d: id=%u SD OK (%s)\n", i, (unsigned)ids[i], ch[i].path());
       }
     }
   }
+
+  for (int i = 0; i < 4; ++i) ClipSource_release(prevShared[i]);
+  SdBus_unlock();
+
+  uint8_t mask = 0;
+  for (int i = 0; i < 4; ++i) if (ids[i]) mask |= (uint8_t)(1u << i);
+  Trace_rec(TR_SCENE_COMMIT, mask, ids[0]);
+  HeapStats_commitDone();   // anything allocated from here on is gameplay
 }
 
 void side_playSlot(uint8_t slot) {
@@ -298,6 +334,7 @@ void side_playSlot(uint8_t slot) {
   Channel& C = ch[slot];
   C.state = PLAYING;
   C.idx   = 0;
+  firstAudioArmed[slot] = true;
 
   if (C.isTone && C.toneMode != TONE_NONE) {
     // Reset tone phase/pattern for a clean one-shot
@@ -307,19 +344,18 @@ void side_playSlot(uint8_t slot) {
     C.tonePatternSamples = 0;
   } else {
     if (!C.useRAM) {
-      C.sd.cur = 0;
-      if (C.sd.f) C.sd.f.seek(C.sd.dataStart);
+      C.sd.cur = 0;   // every read seeks to dataStart + cur
     }
   }
 }
 
 void side_ledAllWhite() {
-  blinkStop();
-  ledsAllColor(255, 255, 255);
+  if (LED_METER_ENABLE) LedFx_meter();   // white that pulses with each slot's clip
+  else                  LedFx_setAll(255, 255, 255);
 }
 
 void side_blinkAll(uint8_t color, uint16_t on_ms, uint16_t off_ms) {
-  blinkStart(color, on_ms, off_ms, /*reps*/3);
+  LedFx_blink(color, on_ms, off_ms, /*reps*/3);
 }
 
 void side_setGameMode(bool en){ gameMode=en; }
@@ -328,14 +364,14 @@ void side_startLoopAll(){
   for (int i=0;i<4;i++){
     ch[i].state = LOOPING;
     ch[i].idx = 0;
+    firstAudioArmed[i] = true;
     if (ch[i].isTone && ch[i].toneMode != TONE_NONE) {
       ch[i].tonePhase = 0.0f;
       ch[i].toneSweepPos = 0.0f;
       ch[i].toneSweepRate = 0.0f;
       ch[i].tonePatternSamples = 0;
     } else if (!ch[i].useRAM) {
-      ch[i].sd.cur = 0;
-      if (ch[i].sd.f) ch[i].sd.f.seek(ch[i].sd.dataStart);
+      ch[i].sd.cur = 0;   // every read seeks to dataStart + cur
     }
   }
 }
@@ -344,6 +380,113 @@ void side_stopAll(){
   for (int i=0;i<4;i++){
     ch[i].state = IDLE;
   }
+  VoicePool_stopAll();
+}
+
+// A shared copy that finished filling takes over from its slots' SD streams at
+// the same point in the clip. A slot past the copy's loop window (or inside
+// its crossfade) waits for the next pass. Every loop(), between frames.
+static void adoptSharedClips() {
+  for (int i = 0; i < 4; ++i) {
+    Channel& C = ch[i];
+    if (!C.sharedId || C.useRAM) continue;
+    const int16_t* data = nullptr;
+    size_t samples = 0;
+    uint32_t ls = 0, le = 0, ts = 0;
+    uint16_t xf = 0;
+    if (!ClipSource_ready(C.sharedId, &data, &samples, &ls, &le, &xf, &ts)) continue;
+
+    // Stream cursor in copy samples: the copy may have been trimmed by analysis
+    int32_t at = 0;
+    if (C.state != IDLE) {
+      at = (int32_t)(C.sd.cur / 2 + C.sd.trimStart) - (int32_t)ts;
+      const size_t end = (C.state == LOOPING && le > ls) ? le - xf : samples;
+      if (at < 0) at = 0;   // in the silence the copy trimmed away
+      if ((size_t)at >= end) continue;
+    }
+
+    // The SdBus worker may be reopening this stream
+    if (!SdBus_tryLock()) continue;
+    if (C.sd.f) C.sd.f.close();
+    C.sd.fault = false;
+    C.ram.data      = data;
+    C.ram.samples   = samples;
+    C.ram.seamless  = (le != 0);
+    C.ram.loopStart = ls;
+    C.ram.loopEnd   = le;
+    C.ram.xfade     = xf;
+    C.idx           = (size_t)at;
+    C.useRAM        = true;
+    SdBus_unlock();
+    if (SCENE_LOG_VERBOSE) Serial.printf("[SCENE] slot %d: id=%u SHARED @%ld (%s)\n", i, (unsigned)C.sharedId, (long)at, C.path());
+  }
+}
+
+// A staged reload whose clips are loaded goes live as soon as no slot has a
+// clip assigned; otherwise side_setScene swaps it in. Every loop(). Under the
+// bus lock, as in side_setScene: the SdBus worker must not be reopening a
+// stream by a clip handle the swap retires.
+static void applyReloadIfIdle() {
+  if (!Manifest_reloadPending()) return;
+  for (int i = 0; i < 4; ++i) if (curSlotIds[i]) return;
+  SdBus_lock();
+  VoicePool_stopAll();
+  Manifest_applyReload();
+  SdBus_unlock();
+}
+
+// Serial 'r' / MANIFEST_RELOAD: stage the new manifest; changed clips load in
+// the background and it goes live at the next scene, or once loaded when no
+// slot has a clip assigned.
+void side_reloadManifest() {
+  if (!Manifest_reload()) return;
+  Serial.println("[MANIFEST] reload staged, swapping at the next scene (or when idle)");
+}
+
+// RAM source for a one-shot voice: never streams or loads, so a clip that is
+// not already in flash, the PSRAM cache or a shared copy held by a slot is
+// refused. Runs on the render loop (GameBus_pump), which must not wait on SD.
+static bool oneshotSource(const ClipMeta* cm, int slotIdx, VoiceSource& src) {
+  if (!strcasecmp(cm->base, "tones")) {
+    Channel t;
+    configureToneChannel(t, cm, slotIdx);
+    if (!t.useRAM) return false;
+    src.data     = t.ram.data;
+    src.samples  = t.ram.samples;
+    src.duration = (size_t)ONESHOT_TONE_MS * SAMPLE_RATE / 1000;
+    return true;
+  }
+  int16_t* buf = nullptr;
+  uint32_t ls = 0, le = 0;
+  uint16_t xf = 0;
+  if (Soundbank_get(cm->id, &src.data, &src.samples, &ls, &le, &xf) ||
+      Manifest_getCached(cm->id, &buf, &src.samples)) {
+    if (buf) src.data = buf;
+  } else if (ClipSource_addRef(cm->id, &src.data, &src.samples)) {
+    src.sharedId = cm->id;
+  } else {
+    return false;
+  }
+  src.duration = src.samples;
+  return src.data && src.samples;
+}
+
+void side_playOneshot(uint8_t slot, uint16_t id, uint8_t prio) {
+  const ClipMeta* cm = Manifest_find(id);
+  if (!cm) { Serial.printf("[VOICE] id=%u NOT FOUND\n", (unsigned)id); return; }
+  const int32_t g = q15_mul(masterGainQ15, q15_from_db(cm->volume_db));
+  for (uint8_t i = 0; i < 4; ++i) {
+    if (slot != ONESHOT_ALL_SLOTS && i != (slot & 3)) continue;
+    VoiceSource src;
+    if (!oneshotSource(cm, i, src)) {
+      Serial.printf("[VOICE] id=%u not RAM-resident, one-shot skipped\n", (unsigned)id);
+      return;
+    }
+    if (!VoicePool_trigger(i, src, g, prio)) {
+      if (src.sharedId) ClipSource_release(src.sharedId);
+      if (SCENE_LOG_VERBOSE) Serial.printf("[VOICE] slot %u busy with higher priority, id=%u dropped\n", i, (unsigned)id);
+    }
+  }
 }
 
 void printSideMacs() {
@@ -373,17 +516,16 @@ void setup() {
   Role::begin();
 
   uint8_t sid = Role::get();
+  Trace_begin(sid==0xFF ? '?' : (sid==0 ? 'A' : 'B'));
   Serial.printf("\n[Seashells Side %s]\n",
                 sid==0xFF ? "UNASSIGNED" : (sid==0 ? "A" : "B"));
 
   masterGainQ15 = q15_from_db(MASTER_GAIN_DB);
 
   for (int i=0;i<4;++i) pinMode(BTN_PINS[i], INPUT);
+  if (AMP_EN_PIN >= 0) { pinMode(AMP_EN_PIN, OUTPUT); digitalWrite(AMP_EN_PIN, HIGH); }
 
-  RGBT[0]->begin(); RGBT[0]->setBrightness(BRIGHTNESS); ledOff(0);
-  RGBT[1]->begin(); RGBT[1]->setBrightness(BRIGHTNESS); ledOff(1);
-  RGBT[2]->begin(); RGBT[2]->setBrightness(BRIGHTNESS); ledOff(2);
-  RGBT[3]->begin(); RGBT[3]->setBrightness(BRIGHTNESS); ledOff(3);
+  LedFx_begin();   // RMT pixels + effect timer; all LEDs start off
 
   SPI.begin(SD_SCK, SD_MISO, SD_MOSI);
   pinMode(SD_CS, OUTPUT); digitalWrite(SD_CS, HIGH);
@@ -391,13 +533,14 @@ void setup() {
     Serial.println("SD mount failed (check wiring/FAT32)"); while(1) delay(1000);
   }
   Serial.println("SD OK");
-  listRootOnce();
+  SdBus_begin();
 
+  // Catalog, audio and radio first; the PSRAM precache fills in behind HELLO
   if (!Manifest_load()) Serial.println("[WARN] No manifest loaded");
-  Manifest_precacheAll();
+  Soundbank_begin();        // before precache: bank clips need no PSRAM copy
 
   for (int i=0;i<4;i++){
-    ch[i].path="";
+    ch[i].clip=nullptr;
     ch[i].state=IDLE;
     ch[i].useRAM=false;
     ch[i].idx=0;
@@ -405,35 +548,161 @@ void setup() {
     ch[i].toneMode=TONE_NONE;
   }
 
-  i2s_init_common(I2S_NUM_0, I2S0_DOUT, I2S0_BCLK, I2S0_LRCK);
-  i2s_init_common(I2S_NUM_1, I2S1_DOUT, I2S1_BCLK, I2S1_LRCK);
+  g_out = AudioOutput_i2s();
+  if (!g_out->begin(SAMPLE_RATE)) {
+    Serial.println("[SIDE] audio output FAIL, rendering to null sink");
+    g_out = AudioOutput_null(true);
+    g_out->begin(SAMPLE_RATE);
+  }
 
   GameBus_init();
 
   printSideMacs();
   Serial.printf("[SIDE] role=%s\n", Role::get()==0xFF?"UNASSIGNED":(Role::get()==0?"A":"B"));
 
+  Manifest_precacheStart();
   uint16_t a=0,b=0;
-  for (uint16_t id=0; id<65535; id++){
-    const ClipMeta* cm = Manifest_find(id);
-    if (!cm) continue;
-    (cm->pool==POOL_A)?a++:b++;
-  }
+  Manifest_poolCounts(&a, &b);
   GameBus_sendHello(a,b);
+  Serial.printf("[BOOT] HELLO %lu ms after reset (%s)\n", (unsigned long)millis(),
+                Manifest_warming() ? "cache warming" : "no precache");
+
+  SdBus_lock();             // shares the card with the precache task now
+  listRootOnce();
+  SdBus_unlock();
 }
 
 // ======= Main loop =======
+
+// Swap the speakers for a real-time WAV capture on the SD card and back.
+static void toggleCapture() {
+  static AudioOutput* speakers = nullptr;
+  g_out->end();
+  if (!speakers) {
+    speakers = g_out;
+    g_out = AudioOutput_wav("/sd/render.wav", true);
+    if (g_out->begin(SAMPLE_RATE)) return;
+    g_out = speakers;
+  } else {
+    g_out = speakers;
+  }
+  speakers = nullptr;
+  g_out->begin(SAMPLE_RATE);
+  Serial.printf("[SIDE] audio output: %s (underruns=%lu)\n", g_out->name(), (unsigned long)g_out->underruns());
+}
+// Serial 'f' check: from the injected fault until every streaming slot has
+// recovered, the longest gap between loop() passes and the I2S underruns.
+// Recovery runs on the SdBus worker, so no pass should come near a frame
+// period; a pass that does means the render loop waited on the card. Run it
+// with the slots playing: an idle loop is slowed on purpose (IdleGovernor).
+static struct {
+  bool     on = false;
+  uint32_t t0Ms = 0, lastUs = 0, worstUs = 0, passes = 0, underruns = 0;
+} s_faultProbe;
+
+static void faultProbeStart() {
+  s_faultProbe.on = true;
+  s_faultProbe.t0Ms = millis();
+  s_faultProbe.lastUs = micros();
+  s_faultProbe.worstUs = 0;
+  s_faultProbe.passes = 0;
+  s_faultProbe.underruns = g_out->underruns();
+}
+
+// Top of every loop()
+static void faultProbeTick() {
+  if (!s_faultProbe.on) return;
+  const uint32_t nowUs = micros();
+  const uint32_t gap = nowUs - s_faultProbe.lastUs;
+  s_faultProbe.lastUs = nowUs;
+  if (gap > s_faultProbe.worstUs) s_faultProbe.worstUs = gap;
+  s_faultProbe.passes++;
+
+  bool faulted = false;
+  for (int i = 0; i < 4; ++i) faulted |= (!ch[i].useRAM && !ch[i].isTone && ch[i].sd.fault);
+  const uint32_t el = millis() - s_faultProbe.t0Ms;
+  if (faulted && el < 10000u) return;
+
+  s_faultProbe.on = false;
+  const uint32_t frameUs = (uint32_t)(FRAME_SAMPLES * 1000000ULL / SAMPLE_RATE);
+  const uint32_t under = g_out->underruns() - s_faultProbe.underruns;
+  const bool pass = !faulted && s_faultProbe.worstUs < frameUs && under == 0;
+  Serial.printf("[SD] fault check: %s after %lu ms, %lu passes, worst pass %lu us (frame %lu us), "
+                "underruns +%lu -> %s\n",
+                faulted ? "NOT recovered" : "recovered", (unsigned long)el,
+                (unsigned long)s_faultProbe.passes, (unsigned long)s_faultProbe.worstUs,
+                (unsigned long)frameUs, (unsigned long)under, pass ? "PASS" : "FAIL");
+}
+
+static void pollSerialCommands() {
+  if (!Serial.available()) return;
+  char c = Serial.read();
+  IdleGov_kick();
+  if (c=='t') { Trace_dump(Serial); }
+  else if (c=='T') { Trace_clear(); Serial.println("[SIDE] trace cleared"); }
+  else if (c=='m') { Meter_benchmark(Serial); }
+  else if (c=='v') { ToneCache_verify(Serial); }
+  else if (c=='f') { if (SdBus_injectFault()) faultProbeStart(); }
+  else if (c=='s') {
+    const char* path = "/manifest.csv";
+    for (int i=0;i<4;++i) if (!ch[i].useRAM && !ch[i].isTone && ch[i].path()[0]) { path = ch[i].path(); break; }
+    SdBus_report(Serial, path);
+  }
+  else if (c=='b') { SdBench_run(Serial); }
+  else if (c=='w') { toggleCapture(); }
+  else if (c=='p') { VoicePool_benchmark(Serial); }
+  else if (c=='y') { side_requestAssetSync(); }
+  else if (c=='r') { side_reloadManifest(); }
+  else if (c=='i') { IdleGov_report(Serial); }
+  else if (c=='h') { HeapStats_report(Serial); }
+}
+
+// Record when each freshly started slot first renders a non-silent sample.
+static void traceFirstAudio() {
+  for (int i=0;i<4;++i) {
+    if (!firstAudioArmed[i]) continue;
+    if (ch[i].state == IDLE) { firstAudioArmed[i] = false; continue; }
+    const int16_t* p = tmpMono[i];
+    for (size_t n=0;n<FRAME_SAMPLES;++n) {
+      if (p[n] != 0) {
+        Trace_rec(TR_FIRST_AUDIO, (uint8_t)i, (uint16_t)n);
+        firstAudioArmed[i] = false;
+        break;
+      }
+    }
+  }
+}
+
 void loop() {
+  faultProbeTick();
+  pollSerialCommands();
   Ota_loopTick();
+  AssetSync_loopTick();
+  applyReloadIfIdle();
+  adoptSharedClips();
   GameBus_pump();  // process queued ESP-NOW commands in the main loop (avoids LED glitches)
+  FwRelay_tick();  // firmware relayed over ESP-NOW: erase/write/verify a step at a time
 
   uint32_t now = millis();
+  static uint32_t lastBeatMs = 0;
+  static bool warm = false;
+  const bool warming = Manifest_warming();
+  if (!warm && !warming) {
+    // Tell the Master straight away rather than at the next beat
+    warm = true;
+    Serial.printf("[BOOT] cache warm %lu ms after reset\n", (unsigned long)now);
+    lastBeatMs = now;
+    GameBus_sendHeartbeat();
+  }
+  if (now - lastBeatMs >= (warming ? HEARTBEAT_WARM_MS : HEARTBEAT_MS)) { lastBeatMs = now; GameBus_sendHeartbeat(); }
   for (int i=0;i<4;++i) {
     bool raw = (digitalRead(BTN_PINS[i]) == LOW);
     if (raw != lastRaw[i]) { lastRaw[i] = raw; lastChangeMs[i] = now; }
     if ((now - lastChangeMs[i]) > DEBOUNCE_MS) {
       if (pressed[i] != raw) {
         pressed[i] = raw;
+        Trace_rec(TR_BTN_EDGE, (uint8_t)i, pressed[i] ? 1 : 0);
+        IdleGov_kick();
         if (pressed[i]) {
           if (!gameMode) {
             ledWhite(i);
@@ -450,8 +719,22 @@ void loop() {
     }
   }
 
+  // Sustained silence stops the outputs and slows this loop (IdleGovernor)
+  bool silent = true;
+  for (int i=0;i<4;++i) silent &= (ch[i].state == IDLE && !VoicePool_active((uint8_t)i));
+  if (!IdleGov_tick(g_out, silent, Manifest_warming() || Manifest_reloadLoading() || FwRelay_busy())) return;
+
+  // Render only when the backend can take a whole frame; the short wait also
+  // keeps buttons and GameBus polled while the DMA ring is full.
+  if (!g_out->waitWritable(FRAME_SAMPLES, 2)) return;
+
   for (int i=0;i<4;++i) fillChannelFrame(i, tmpMono[i]);
-  for (int i=0;i<4;++i) applyGain(tmpMono[i], FRAME_SAMPLES, ch[i].gainQ15);
+  for (int i=0;i<4;++i) {
+    // One-shots ride on top of the loop after its gain; the meter (LEDs) follows the loop
+    applyGainMeter(tmpMono[i], FRAME_SAMPLES, ch[i].gainQ15, (uint8_t)i);
+    VoicePool_mix((uint8_t)i, tmpMono[i], FRAME_SAMPLES);
+  }
+  traceFirstAudio();
 
   {
     int16_t* o = (int16_t*)outLR0;
@@ -466,9 +749,6 @@ void loop() {
     for (size_t n=0;n<FRAME_SAMPLES;++n) { *o++ = L[n]; *o++ = R[n]; }
   }
 
-  size_t w0=0, w1=0;
-  i2s_write(I2S_NUM_0, outLR0, OUT_BYTES, &w0, portMAX_DELAY);
-  i2s_write(I2S_NUM_1, outLR1, OUT_BYTES, &w1, portMAX_DELAY);
-
-  blinkUpdate();
+  g_out->write((const int16_t*)outLR0, (const int16_t*)outLR1, FRAME_SAMPLES);
+  IdleGov_frameWritten();
 }
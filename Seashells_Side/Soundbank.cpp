@@ -0,0 +1,203 @@
+#include "Soundbank.h"
+
+#if defined(ARDUINO)
+#include "ConfigSide.h"
+#include "esp_partition.h"
+#include <Preferences.h>
+#define BANK_LOG(...) Serial.printf(__VA_ARGS__)
+#else
+// Host build (desktop checks of a packed image): the bank is a file mapped
+// with mmap(2), named by $SEASHELLS_SOUNDBANK (default soundbank.bin). The
+// mask lives in memory only.
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifndef SAMPLE_RATE
+#define SAMPLE_RATE 44100   // ConfigSide.h; pass -DSAMPLE_RATE for a 48 kHz bank
+#endif
+#define BANK_LOG(...) printf(__VA_ARGS__)
+#endif
+
+static constexpr uint32_t kMagic   = 0x4B425353;   // "SSBK"
+static constexpr uint16_t kVersion = 2;
+
+struct __attribute__((packed)) BankHeader {
+  uint32_t magic;
+  uint16_t version;
+  uint16_t count;
+  uint32_t sampleRate;
+  uint32_t totalBytes;
+};
+
+struct __attribute__((packed)) BankEntry {
+  uint16_t id;
+  uint16_t xfade;      // loop crossfade samples stored after the clip's PCM
+  uint32_t offset;
+  uint32_t samples;
+  uint32_t loopStart;
+  uint32_t loopEnd;
+};
+
+static const uint8_t*   s_base  = nullptr;
+static const BankEntry* s_index = nullptr;
+static uint16_t         s_count = 0;
+
+// Clips whose SD file changed after the bank was packed (Soundbank_mask). Kept
+// in NVS with a stamp of the bank's index, so flashing a new bank clears them.
+static constexpr uint8_t kMaskMax = 32;
+static uint16_t s_masked[kMaskMax];
+static uint8_t  s_maskedCount = 0;
+static uint32_t s_stamp = 0;
+
+static bool validate(const BankHeader& h, size_t avail) {
+  if (h.magic != kMagic) return false;
+  if (h.version != kVersion) {
+    BANK_LOG("[BANK] version %u, firmware reads %u: repack with tools/pack_soundbank.py\n",
+                  (unsigned)h.version, (unsigned)kVersion);
+    return false;
+  }
+  if (h.sampleRate != SAMPLE_RATE) {
+    BANK_LOG("[BANK] sampleRate %lu != engine %u, ignoring bank\n",
+                  (unsigned long)h.sampleRate, (unsigned)SAMPLE_RATE);
+    return false;
+  }
+  const size_t idxEnd = sizeof(BankHeader) + (size_t)h.count * sizeof(BankEntry);
+  return h.totalBytes >= idxEnd && h.totalBytes <= avail;
+}
+
+#if defined(ARDUINO)
+
+static const esp_partition_t* s_part = nullptr;
+static esp_partition_mmap_handle_t s_map;
+
+// Map `bytes` of the bank (or just the header when bytes == 0)
+static const uint8_t* mapBank(size_t bytes, size_t* avail) {
+  if (!s_part) {
+    s_part = esp_partition_find_first(ESP_PARTITION_TYPE_DATA, (esp_partition_subtype_t)0x40, "soundbank");
+    if (!s_part) return nullptr;
+  }
+  *avail = s_part->size;
+  if (!bytes) {
+    static BankHeader h;
+    return esp_partition_read(s_part, 0, &h, sizeof(h)) == ESP_OK ? (const uint8_t*)&h : nullptr;
+  }
+  const void* p = nullptr;
+  if (esp_partition_mmap(s_part, 0, bytes, ESP_PARTITION_MMAP_DATA, &p, &s_map) != ESP_OK) return nullptr;
+  return (const uint8_t*)p;
+}
+
+static uint8_t loadMask(uint32_t stamp) {
+  Preferences p;
+  p.begin("bankmask", true);
+  const uint8_t n = (p.getUInt("stamp", 0) == stamp) ? (uint8_t)(p.getBytes("ids", s_masked, sizeof(s_masked)) / 2) : 0;
+  p.end();
+  return n;
+}
+
+static void saveMask() {
+  Preferences p;
+  p.begin("bankmask", false);
+  p.putUInt("stamp", s_stamp);
+  p.putBytes("ids", s_masked, s_maskedCount * 2);
+  p.end();
+}
+
+#else
+
+static const uint8_t* mapBank(size_t bytes, size_t* avail) {
+  const char* path = getenv("SEASHELLS_SOUNDBANK");
+  if (!path) path = "soundbank.bin";
+  const int fd = open(path, O_RDONLY);
+  if (fd < 0) return nullptr;
+  struct stat st;
+  if (fstat(fd, &st) != 0) { close(fd); return nullptr; }
+  *avail = (size_t)st.st_size;
+  if (!bytes) bytes = sizeof(BankHeader);
+  void* p = (bytes <= *avail) ? mmap(nullptr, bytes, PROT_READ, MAP_PRIVATE, fd, 0) : MAP_FAILED;
+  close(fd);
+  return (p == MAP_FAILED) ? nullptr : (const uint8_t*)p;
+}
+
+static uint8_t loadMask(uint32_t) { return 0; }
+static void saveMask() {}
+
+#endif
+
+bool Soundbank_begin() {
+  size_t avail = 0;
+  const uint8_t* hp = mapBank(0, &avail);
+  if (!hp) { BANK_LOG("[BANK] no soundbank partition\n"); return false; }
+  BankHeader h;
+  memcpy(&h, hp, sizeof(h));
+  if (!validate(h, avail)) { BANK_LOG("[BANK] partition holds no valid soundbank\n"); return false; }
+
+  // Map only what the bank uses: data mmap address space is shared with PSRAM
+  s_base = mapBank(h.totalBytes, &avail);
+  if (!s_base) { BANK_LOG("[BANK] mmap FAIL\n"); return false; }
+  s_index = (const BankEntry*)(s_base + sizeof(BankHeader));
+  s_count = h.count;
+
+  for (uint16_t i = 0; i < s_count; ++i) {
+    const BankEntry& e = s_index[i];
+    if ((e.offset & 3) || e.offset + ((uint64_t)e.samples + e.xfade) * 2 > h.totalBytes) {
+      BANK_LOG("[BANK] entry %u (id=%u) out of range, bank disabled\n", (unsigned)i, (unsigned)e.id);
+      s_count = 0;
+      return false;
+    }
+  }
+
+  // FNV-1a over header and index identifies this bank
+  s_stamp = 2166136261u;
+  for (size_t i = 0; i < sizeof(BankHeader) + (size_t)s_count * sizeof(BankEntry); ++i) {
+    s_stamp = (s_stamp ^ s_base[i]) * 16777619u;
+  }
+  s_maskedCount = loadMask(s_stamp);
+
+  BANK_LOG("[BANK] mapped %u clips (%lu KB)\n", (unsigned)s_count, (unsigned long)(h.totalBytes / 1024));
+  if (s_maskedCount) {
+    BANK_LOG("[BANK] %u clip(s) masked: changed on SD since packing, repack to restore\n",
+                  (unsigned)s_maskedCount);
+  }
+  return true;
+}
+
+static bool masked(uint16_t id) {
+  for (uint8_t i = 0; i < s_maskedCount; ++i) if (s_masked[i] == id) return true;
+  return false;
+}
+
+static const BankEntry* findEntry(uint16_t id) {
+  if (masked(id)) return nullptr;
+  for (uint16_t i = 0; i < s_count; ++i) if (s_index[i].id == id) return &s_index[i];
+  return nullptr;
+}
+
+bool Soundbank_has(uint16_t id) { return findEntry(id) != nullptr; }
+
+void Soundbank_mask(uint16_t id) {
+  if (!findEntry(id)) return;
+  if (s_maskedCount >= kMaskMax) {
+    BANK_LOG("[BANK] id=%u changed on SD but the mask is full; it plays the packed copy until a repack\n",
+                  (unsigned)id);
+    return;
+  }
+  s_masked[s_maskedCount++] = id;
+  saveMask();
+  BANK_LOG("[BANK] id=%u changed on SD: packed copy masked until a repack\n", (unsigned)id);
+}
+
+bool Soundbank_get(uint16_t id, const int16_t** data, size_t* samples,
+                   uint32_t* loopStart, uint32_t* loopEnd, uint16_t* xfade) {
+  const BankEntry* e = findEntry(id);
+  if (!e) return false;
+  *data      = (const int16_t*)(s_base + e->offset);
+  *samples   = e->samples;
+  *loopStart = e->loopStart;
+  *loopEnd   = e->loopEnd;
+  *xfade     = e->xfade;
+  return true;
+}
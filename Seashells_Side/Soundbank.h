@@ -0,0 +1,37 @@
+#pragma once
+#if defined(ARDUINO)
+#include <Arduino.h>
+#else
+#include <stddef.h>
+#include <stdint.h>
+#endif
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Read-only soundbank packed by tools/pack_soundbank.py into the "soundbank"
+// flash partition (partitions.csv) and memory-mapped at boot. Channels play
+// straight from the mapped PCM: no copy, no PSRAM, no SD traffic. Trims and
+// loop points are baked in by the packer.
+//
+// Layout (little-endian, version 2):
+//   header  "SSBK" | u16 version | u16 count | u32 sampleRate | u32 totalBytes
+//   index   count x { u16 id | u16 xfade | u32 offset | u32 samples |
+//                     u32 loopStart | u32 loopEnd }      (offset from bank start)
+//   PCM     16-bit mono, each clip 4-byte aligned and followed by its xfade
+//           loop-crossfade samples (TrackRAM::xfade), so one-shots play the
+//           clip exactly as recorded
+//
+// Off the device (no ARDUINO) the same code maps an image file instead, so a
+// packed bank can be checked on a desktop: see Soundbank.cpp.
+// ─────────────────────────────────────────────────────────────────────────────
+
+bool Soundbank_begin();
+bool Soundbank_has(uint16_t id);
+
+// A clip whose SD file changed after packing (AssetSync, manifest reload) is
+// masked: has/get report it absent, so it plays from PSRAM or SD like any
+// other clip. The mask survives reboots until a different bank is flashed.
+void Soundbank_mask(uint16_t id);
+
+// loopEnd == 0 when the clip has no baked loop points
+bool Soundbank_get(uint16_t id, const int16_t** data, size_t* samples,
+                   uint32_t* loopStart, uint32_t* loopEnd, uint16_t* xfade);
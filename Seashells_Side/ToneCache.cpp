@@ -0,0 +1,114 @@
+#include "ToneCache.h"
+#include <math.h>
+
+struct ToneEntry {
+  uint16_t id      = 0;
+  ToneMode mode    = TONE_NONE;
+  float    f1      = 0.0f;
+  float    f2      = 0.0f;
+  int16_t* data    = nullptr;
+  size_t   samples = 0;
+};
+
+static ToneEntry s_tones[16];
+static size_t    s_toneCount = 0;
+
+static uint32_t gcd32(uint32_t a, uint32_t b) {
+  while (b) { uint32_t t = a % b; a = b; b = t; }
+  return a;
+}
+
+// One loop period in samples for the given patch. Must match the constants in
+// synthNextSample().
+static size_t tonePeriodSamples(const Channel& C) {
+  const uint32_t sr = SAMPLE_RATE;
+  switch (C.toneMode) {
+    case TONE_SIMPLE: {
+      uint32_t f = (uint32_t)lroundf(C.toneFreq1);
+      if (f == 0 || (float)f != C.toneFreq1) return TONE_CACHE_MAX_SAMPLES;
+      return sr / gcd32(sr, f);
+    }
+    case TONE_SWEEP_UP:
+    case TONE_SWEEP_DOWN:
+      return (size_t)lroundf((float)sr * 0.4f);
+    case TONE_SIREN:
+      return (size_t)lroundf((float)sr * 1.2f);
+    case TONE_DOUBLE_CLICK:
+    case TONE_TRIPLE_BEEP: {
+      const uint32_t beep = (uint32_t)((float)sr * 0.04f);
+      const uint32_t gap  = (uint32_t)((float)sr * 0.04f);
+      return (C.toneMode == TONE_DOUBLE_CLICK) ? (2*beep + 5*gap) : (3*beep + 5*gap);
+    }
+    case TONE_NOISE:
+    default:
+      return sr;
+  }
+}
+
+// Fresh copy of the patch with all oscillator state reset, as side_playSlot does
+static Channel freshTone(const ToneEntry& e) {
+  Channel t;
+  t.isTone = true;
+  t.toneMode = e.mode;
+  t.toneFreq1 = e.f1;
+  t.toneFreq2 = e.f2;
+  return t;
+}
+
+bool ToneCache_get(uint16_t id, const Channel& C, int16_t** data, size_t* samples) {
+  for (size_t i = 0; i < s_toneCount; i++) {
+    ToneEntry& e = s_tones[i];
+    if (e.id == id && e.mode == C.toneMode && e.f1 == C.toneFreq1 && e.f2 == C.toneFreq2) {
+      *data = e.data; *samples = e.samples;
+      return true;
+    }
+  }
+  if (s_toneCount >= sizeof(s_tones)/sizeof(s_tones[0])) return false;
+
+  size_t n = tonePeriodSamples(C);
+  if (n == 0 || n > TONE_CACHE_MAX_SAMPLES) n = TONE_CACHE_MAX_SAMPLES;
+
+  int16_t* buf = (int16_t*)ps_malloc(n * 2);
+  if (!buf) {
+    Serial.printf("[TONE] id=%u cache alloc FAIL (%u bytes)\n", (unsigned)id, (unsigned)(n * 2));
+    return false;
+  }
+
+  ToneEntry& e = s_tones[s_toneCount];
+  e.id = id; e.mode = C.toneMode; e.f1 = C.toneFreq1; e.f2 = C.toneFreq2;
+  Channel t = freshTone(e);
+  for (size_t k = 0; k < n; k++) buf[k] = toneToPcm(synthNextSample(t));
+  e.data = buf; e.samples = n;
+  s_toneCount++;
+
+  Serial.printf("[TONE] id=%u mode=%d rendered %u samples (%.3f s) into PSRAM\n",
+                (unsigned)id, (int)e.mode, (unsigned)n, (double)n / SAMPLE_RATE);
+  *data = buf; *samples = n;
+  return true;
+}
+
+void ToneCache_verify(Print& out) {
+  if (!s_toneCount) { out.println("[TONE] cache empty"); return; }
+  for (size_t i = 0; i < s_toneCount; i++) {
+    const ToneEntry& e = s_tones[i];
+    if (e.mode == TONE_NONE || e.mode == TONE_NOISE) {
+      out.printf("[TONE] id=%u mode=%d: random, not comparable\n", (unsigned)e.id, (int)e.mode);
+      continue;
+    }
+    Channel t = freshTone(e);
+    size_t mismatch = 0;
+    for (size_t k = 0; k < e.samples; k++) {
+      if (toneToPcm(synthNextSample(t)) != e.data[k]) mismatch++;
+    }
+    // Second period: real time keeps accumulating, the cache restarts
+    int32_t maxDiff = 0;
+    for (size_t k = 0; k < e.samples; k++) {
+      int32_t d = (int32_t)toneToPcm(synthNextSample(t)) - (int32_t)e.data[k];
+      if (d < 0) d = -d;
+      if (d > maxDiff) maxDiff = d;
+    }
+    out.printf("[TONE] id=%u mode=%d period=%u: %s (%u mismatches), 2nd period max drift %ld LSB\n",
+               (unsigned)e.id, (int)e.mode, (unsigned)e.samples,
+               mismatch ? "MISMATCH" : "bit-exact", (unsigned)mismatch, (long)maxDiff);
+  }
+}
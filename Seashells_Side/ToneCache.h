@@ -0,0 +1,23 @@
+#pragma once
+#include <Arduino.h>
+#include "AudioEngine.h"
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Render-once cache for synthetic tones (base=tones).
+//
+// Every tone patch is periodic: a sine repeats after SR/gcd(SR, f) samples,
+// sweeps and the siren after one sweep/LFO period, rhythms after one pattern.
+// At scene set we synthesize exactly one loop period into PSRAM with the same
+// synthNextSample() the real-time path uses, and the channel then plays it
+// through the RAM path, so tones cost nothing per frame during gameplay.
+// Noise has no period; one second of it is rendered and looped.
+// ─────────────────────────────────────────────────────────────────────────────
+
+// C must already be configured as a tone channel (mode + frequencies).
+// Returns the cached period, rendering it on first use of this clip ID.
+bool ToneCache_get(uint16_t id, const Channel& C, int16_t** data, size_t* samples);
+
+// Re-synthesize every cached patch in real time and compare bit-for-bit
+// against the cache. Also reports how far real-time synthesis drifts from the
+// cached loop over a second period (float phase accumulation).
+void ToneCache_verify(Print& out);
@@ -0,0 +1,126 @@
+#include "VoicePool.h"
+#include "AudioEngine.h"
+#include "ClipSource.h"
+#include "ConfigSide.h"
+
+struct Voice {
+  VoiceSource src;
+  size_t   pos = 0;        // index into src.data
+  size_t   left = 0;       // samples still to play; 0 = free
+  int32_t  gainQ15 = 0;
+  uint8_t  prio = 0;
+  uint32_t seq = 0;        // trigger order, for oldest-first stealing
+};
+
+static Voice    s_voice[4][VOICES_PER_SLOT];
+static uint32_t s_seq = 0;
+
+static void freeVoice(Voice& v) {
+  if (v.left && v.src.sharedId) ClipSource_release(v.src.sharedId);
+  v.left = 0;
+  v.src = VoiceSource();
+}
+
+bool VoicePool_trigger(uint8_t slot, const VoiceSource& src, int32_t gainQ15, uint8_t prio) {
+  if (!src.data || !src.samples || !src.duration) return false;
+  Voice* pool = s_voice[slot & 3];
+
+  Voice* pick = nullptr;
+  for (int i = 0; i < VOICES_PER_SLOT && !pick; i++) if (!pool[i].left) pick = &pool[i];
+  if (!pick) {
+    for (int i = 0; i < VOICES_PER_SLOT; i++) {
+      Voice& v = pool[i];
+      if (v.prio > prio) continue;
+      if (!pick || v.prio < pick->prio || (v.prio == pick->prio && v.seq < pick->seq)) pick = &v;
+    }
+    if (!pick) return false;
+    freeVoice(*pick);
+  }
+
+  pick->src = src;
+  pick->pos = 0;
+  pick->left = src.duration;
+  pick->gainQ15 = gainQ15;
+  pick->prio = prio;
+  pick->seq = ++s_seq;
+  return true;
+}
+
+bool VoicePool_active(uint8_t slot) {
+  const Voice* pool = s_voice[slot & 3];
+  for (int i = 0; i < VOICES_PER_SLOT; i++) if (pool[i].left) return true;
+  return false;
+}
+
+// bus[n] += data * gain (Q15), saturating; wraps short sources until `left` runs out.
+static void mixVoice(Voice& v, int16_t* bus, size_t n) {
+  const int16_t* d = v.src.data;
+  const int32_t  g = v.gainQ15;
+  size_t out = 0;
+  while (out < n && v.left) {
+    size_t run = min(n - out, min(v.left, v.src.samples - v.pos));
+    const int16_t* s = d + v.pos;
+    int16_t* b = bus + out;
+    for (size_t i = 0; i < run; i++) {
+      int32_t acc = b[i] + (int32_t)(((int64_t)s[i] * g) >> 15);
+      if (acc >  32767) acc =  32767;
+      if (acc < -32768) acc = -32768;
+      b[i] = (int16_t)acc;
+    }
+    out += run;
+    v.left -= run;
+    v.pos += run;
+    if (v.pos >= v.src.samples) v.pos = 0;
+  }
+}
+
+void VoicePool_mix(uint8_t slot, int16_t* bus, size_t n) {
+  Voice* pool = s_voice[slot & 3];
+  for (int i = 0; i < VOICES_PER_SLOT; i++) {
+    Voice& v = pool[i];
+    if (!v.left) continue;
+    mixVoice(v, bus, n);
+    if (!v.left) {
+      if (v.src.sharedId) ClipSource_release(v.src.sharedId);
+      v.src = VoiceSource();
+    }
+  }
+}
+
+void VoicePool_stopAll() {
+  for (auto& pool : s_voice)
+    for (Voice& v : pool) freeVoice(v);
+}
+
+void VoicePool_benchmark(Print& out) {
+  static constexpr size_t kN     = 1024;   // same as the engine frame
+  static constexpr int    kIters = 128;
+  static int16_t src[kN], bus[kN];
+  for (size_t i = 0; i < kN; i++) src[i] = (int16_t)random(-20000, 20000);
+  const int32_t g = q15_from_db(-6);
+
+  const float frameCycles = (float)ESP.getCpuFreqMHz() * 1e6f * (float)kN / (float)SAMPLE_RATE;
+  float base = 0.0f, perVoice = 0.0f;
+  for (int voices = 0; voices <= VOICES_PER_SLOT; voices++) {
+    uint32_t total = 0;
+    for (int it = 0; it < kIters; it++) {
+      Voice v[VOICES_PER_SLOT];
+      for (int k = 0; k < voices; k++) {
+        v[k].src.data = src; v[k].src.samples = kN; v[k].left = kN; v[k].gainQ15 = g;
+      }
+      memcpy(bus, src, sizeof(bus));
+      uint32_t c0 = ESP.getCycleCount();
+      for (int k = 0; k < voices; k++) mixVoice(v[k], bus, kN);
+      total += ESP.getCycleCount() - c0;
+    }
+    float per = (float)total / kIters;
+    if (voices == 0) base = per;
+    if (voices == 1) perVoice = per - base;
+    out.printf("[VOICE] %d voice(s): %.0f cyc per slot-frame (%.2f%% of frame budget for 4 slots)\n",
+               voices, per, 400.0f * per / frameCycles);
+  }
+  if (perVoice > 0.0f) {
+    out.printf("[VOICE] %.0f cyc per extra voice; %.0f voices across 4 slots fill a %.0f cyc frame\n",
+               perVoice, frameCycles / perVoice, frameCycles);
+  }
+}
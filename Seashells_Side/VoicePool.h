@@ -0,0 +1,33 @@
+#pragma once
+#include <Arduino.h>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// One-shot voices layered on top of each slot's Channel, so a sting or a
+// countdown tick can play without stopping the slot's loop.
+//
+// Every slot owns VOICES_PER_SLOT voices. A trigger takes a free voice, else
+// steals the lowest-priority one (oldest first among equals) as long as it is
+// not more important than the new sound; otherwise the trigger is dropped.
+// Voices play from RAM only (soundbank, PSRAM cache, shared ClipSource copy or
+// a cached tone period), so mixing never touches the SD card.
+//
+// VoicePool_mix() adds the slot's voices into its bus after the loop's gain,
+// in Q15 fixed point with saturation. Runs on the render loop only.
+// ─────────────────────────────────────────────────────────────────────────────
+
+struct VoiceSource {
+  const int16_t* data = nullptr;
+  size_t   samples  = 0;     // length of data
+  size_t   duration = 0;     // samples to play; > samples loops data (tone periods)
+  uint16_t sharedId = 0;     // != 0: holds a ClipSource reference, released on end
+};
+
+// False if every voice on the slot outranks `prio`; the caller still owns src.
+bool VoicePool_trigger(uint8_t slot, const VoiceSource& src, int32_t gainQ15, uint8_t prio);
+bool VoicePool_active(uint8_t slot);
+void VoicePool_mix(uint8_t slot, int16_t* bus, size_t n);
+void VoicePool_stopAll();
+
+// Time the mix on a synthetic frame with 0..VOICES_PER_SLOT voices and print
+// the cost per extra voice against the real-time frame budget.
+void VoicePool_benchmark(Print& out);
@@ -0,0 +1,95 @@
+#!/usr/bin/env python3
+"""
+Write the asset index the Sides sync their SD cards against (AssetSync.cpp).
+
+Point it at the folder that mirrors the SD card root (the one holding
+manifest.csv) and serve that folder over HTTP, e.g. with tools/ota_server.py:
+
+    python3 tools/asset_manifest.py /srv/seashells/assets
+    python3 tools/ota_server.py /srv/seashells --port 8000
+    # ASSET_INDEX_URL = http://<host>:8000/assets/assets.idx
+
+One line per file, "<sha256> <size> </path/on/sd>", sorted by path. Hidden
+files, *.tmp and the index itself are skipped. Paths are checked against the
+Side's ASSET_PATH_MAX. With --diff OLD the changed/new/removed files and the
+bytes a Side would download are printed, to check a change before publishing.
+"""
+
+import argparse
+import hashlib
+import os
+import sys
+
+INDEX_NAME = "assets.idx"
+ASSET_PATH_MAX = 96   # ConfigSide.h, including the terminating NUL
+
+
+def sha256_of(path):
+    h = hashlib.sha256()
+    with open(path, "rb") as f:
+        for block in iter(lambda: f.read(1 << 16), b""):
+            h.update(block)
+    return h.hexdigest()
+
+
+def scan(root):
+    entries = {}
+    for dirpath, dirnames, filenames in os.walk(root):
+        dirnames[:] = sorted(d for d in dirnames if not d.startswith("."))
+        for name in filenames:
+            if name.startswith(".") or name.endswith(".tmp") or name == INDEX_NAME:
+                continue
+            full = os.path.join(dirpath, name)
+            sd_path = "/" + os.path.relpath(full, root).replace(os.sep, "/")
+            entries[sd_path] = (sha256_of(full), os.path.getsize(full))
+    return entries
+
+
+def read_index(path):
+    entries = {}
+    with open(path) as f:
+        for line in f:
+            parts = line.rstrip("\r\n").split(" ", 2)
+            if len(parts) == 3 and not line.startswith("#"):
+                entries[parts[2]] = (parts[0], int(parts[1]))
+    return entries
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__,
+                                 formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("root", help="folder mirroring the SD card root")
+    ap.add_argument("-o", "--output", help=f"index file (default: <root>/{INDEX_NAME})")
+    ap.add_argument("--diff", metavar="OLD", help="compare with a previous index and report")
+    args = ap.parse_args()
+
+    entries = scan(args.root)
+    bad = [p for p in entries if len(p.encode()) >= ASSET_PATH_MAX]
+    for p in bad:
+        print(f"path too long for the Side (ASSET_PATH_MAX {ASSET_PATH_MAX}): {p}", file=sys.stderr)
+    if bad:
+        sys.exit(1)
+
+    if args.diff:
+        old = read_index(args.diff)
+        changed = [p for p in entries if p in old and old[p] != entries[p]]
+        new = [p for p in entries if p not in old]
+        gone = [p for p in old if p not in entries]
+        for tag, paths in (("changed", changed), ("new", new), ("removed", gone)):
+            for p in sorted(paths):
+                print(f"{tag:8} {p}")
+        fetch = sum(entries[p][1] for p in changed + new)
+        print(f"{len(changed)} changed, {len(new)} new, {len(gone)} removed: "
+              f"{fetch} bytes to download per Side")
+
+    out = args.output or os.path.join(args.root, INDEX_NAME)
+    with open(out, "w") as f:
+        for p in sorted(entries):
+            sha, size = entries[p]
+            f.write(f"{sha} {size} {p}\n")
+    total = sum(size for _, size in entries.values())
+    print(f"{out}: {len(entries)} files, {total} bytes")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,124 @@
+#!/usr/bin/env python3
+"""
+Find leading/trailing silence in the Seashells clips and record it in the
+manifest, so Sides can skip it on SD streams as well as in the PSRAM cache.
+
+Point it at a copy of the SD card root (the folder holding manifest.csv):
+
+    python3 tools/clip_trim.py /media/sdcard            # report only
+    python3 tools/clip_trim.py /media/sdcard -o manifest_trimmed.csv
+
+Every clip row gets trim_start,trim_end (samples into the WAV data chunk)
+appended after the tags column. Tags may contain commas; like the Side's
+parser, a row's last two fields are read as trim only when both are plain
+numbers. Detection matches ClipAnalysis_trim on the
+Side (TRIM_THRESHOLD_DB / TRIM_PAD_MS in ConfigSide.h), so a Side that
+precaches the clip ends up with the same offsets either way. Rows that
+already carry trim columns are re-measured.
+"""
+
+import argparse
+import array
+import os
+import sys
+import wave
+
+N_FIELDS = 9   # id,pool,path,precache,volume_db,base,sub,sub2,tags
+
+
+def split_row(line):
+    """Split a clip row as parseManifest (Manifest.cpp) does.
+
+    Returns (fields, trim): the N_FIELDS columns, tags last with any commas
+    in them, and (trim_start, trim_end) when the line ends in two plain
+    numbers after the tags, else None. None for a row with too few fields.
+    """
+    fields = line.split(",", N_FIELDS - 1)
+    if len(fields) < N_FIELDS:
+        return None
+    tail = fields[-1].rsplit(",", 2)
+    if len(tail) == 3 and all(t.strip().isascii() and t.strip().isdigit() for t in tail[1:]):
+        fields[-1] = tail[0]
+        return fields, (int(tail[1]), int(tail[2]))
+    return fields, None
+
+
+def find_trim(pcm, rate, threshold_db, pad_ms):
+    """Return (start, end) sample offsets, mirroring ClipAnalysis.cpp."""
+    thr = int(32767.0 * 10 ** (threshold_db / 20.0))
+    pad = rate * pad_ms // 1000
+    n = len(pcm)
+    on = 0
+    while on < n and abs(pcm[on]) <= thr:
+        on += 1
+    if on == n:
+        return 0, n
+    off = n
+    while off > on and abs(pcm[off - 1]) <= thr:
+        off -= 1
+    return max(on - pad, 0), min(off + pad, n)
+
+
+def read_pcm(path):
+    with wave.open(path, "rb") as w:
+        if w.getsampwidth() != 2 or w.getnchannels() != 1:
+            raise ValueError("need 16-bit mono PCM")
+        rate = w.getframerate()
+        pcm = array.array("h", w.readframes(w.getnframes()))
+    if sys.byteorder == "big":
+        pcm.byteswap()
+    return pcm, rate
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__,
+                                 formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("root", help="SD card root containing manifest.csv")
+    ap.add_argument("-o", "--out", help="write the manifest with trim columns here")
+    ap.add_argument("--threshold-db", type=float, default=-50.0)
+    ap.add_argument("--pad-ms", type=int, default=4)
+    args = ap.parse_args()
+
+    out_lines = []
+    total_saved = total_onset_ms = 0.0
+    clips = 0
+    with open(os.path.join(args.root, "manifest.csv"), "r") as f:
+        for line in f:
+            line = line.rstrip("\r\n")
+            row = split_row(line) if line[:1].isdigit() else None
+            if row is None:
+                out_lines.append(line)
+                continue
+            fields = row[0]   # any old trim columns are re-measured
+            wav = os.path.join(args.root, fields[2].strip().lstrip("/"))
+            try:
+                pcm, rate = read_pcm(wav)
+            except (OSError, ValueError, wave.Error) as e:
+                print(f"  {fields[0]:>5}  {fields[2]}: skipped ({e})")
+                out_lines.append(line)
+                continue
+
+            start, end = find_trim(pcm, rate, args.threshold_db, args.pad_ms)
+            saved = (len(pcm) - (end - start)) * 2
+            onset_ms = start * 1000.0 / rate
+            tail_ms = (len(pcm) - end) * 1000.0 / rate
+            print(f"  {fields[0]:>5}  onset -{onset_ms:6.1f} ms  tail -{tail_ms:6.1f} ms  "
+                  f"saved {saved:8d} B  {fields[2]}")
+            clips += 1
+            total_saved += saved
+            total_onset_ms += onset_ms
+            if (start, end) == (0, len(pcm)):
+                end = 0   # whole clip
+            out_lines.append(",".join(fields + [str(start), str(end)]))
+
+    if clips:
+        print(f"{clips} clips: saved {total_saved / 1024:.1f} KB, onset removed "
+              f"{total_onset_ms:.1f} ms (avg {total_onset_ms / clips:.1f} ms/clip)")
+    if args.out:
+        with open(args.out, "w") as f:
+            f.write("\n".join(out_lines) + "\n")
+        print(f"wrote {args.out}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,149 @@
+#!/usr/bin/env python3
+"""
+Host simulation of the ESP-NOW firmware relay (MasterFwRelay.cpp -> FwRelay.cpp).
+
+Models the same wire protocol (Messages.h, FW_*) with a lossy broadcast
+medium: FW_OFFER polls, paced FW_CHUNK passes, FW_NACK bitmaps limited to
+FW_NACK_MAX_BITS from each Side's first hole, the Master resending the union
+of holes, drops after FW_MAX_ROUNDS, and the final SHA-256 check on every Side.
+Each Side can have its own loss rate; loss applies to chunks and control
+packets alike.
+
+    python3 tools/fw_relay_sim.py --size 1500000 --loss 0.05 --loss 0.20
+    python3 tools/fw_relay_sim.py --image Seashells_Side/build/.../Seashells_Side.ino.bin --loss 0.1 --seed 7
+
+Prints rounds, chunks sent per image chunk and the simulated air time; exits
+non-zero if any Side ends with an image that does not hash to the original.
+Keep the constants in step with Messages.h / ConfigMaster.h.
+"""
+
+import argparse
+import hashlib
+import random
+import sys
+
+FW_CHUNK_BYTES = 240
+FW_NACK_MAX_BITS = 1920
+FW_CHUNK_GAP_US = 2000
+FW_POLL_MS = 250
+FW_SIDE_TIMEOUT_MS = 5000
+FW_POLL_TRIES = FW_SIDE_TIMEOUT_MS // FW_POLL_MS   # unanswered polls before a Side is dropped
+FW_MAX_ROUNDS = 40
+
+
+class Side:
+    def __init__(self, name, loss, rng, chunks):
+        self.name, self.loss, self.rng = name, loss, rng
+        self.got = {}                   # index -> bytes
+        self.chunks = chunks
+        self.first_missing = 0
+        self.active = True
+
+    def hears(self):
+        return self.rng.random() >= self.loss
+
+    def on_chunk(self, i, data):
+        if self.hears():
+            self.got.setdefault(i, data)
+
+    def nack(self):
+        """(complete, base, missing indices in the window) or None if the reply was lost."""
+        if not self.hears():
+            return None
+        while self.first_missing < self.chunks and self.first_missing in self.got:
+            self.first_missing += 1
+        base = self.first_missing
+        window = range(base, min(self.chunks, base + FW_NACK_MAX_BITS))
+        missing = [i for i in window if i not in self.got]
+        return len(self.got) == self.chunks, base, missing
+
+    def image(self):
+        return b"".join(self.got[i] for i in range(self.chunks))
+
+
+def relay(image, losses, seed):
+    rng = random.Random(seed)
+    chunks = (len(image) + FW_CHUNK_BYTES - 1) // FW_CHUNK_BYTES
+    sides = [Side(chr(ord("A") + k), loss, random.Random(rng.random()), chunks)
+             for k, loss in enumerate(losses)]
+    air_us = sent = rounds = 0
+    need = set(range(chunks))           # first pass: everything
+
+    while True:
+        rounds += 1
+        for i in sorted(need):
+            data = image[i * FW_CHUNK_BYTES:(i + 1) * FW_CHUNK_BYTES]
+            for s in sides:
+                if s.active:
+                    s.on_chunk(i, data)
+            sent += 1
+            air_us += FW_CHUNK_GAP_US
+        need = set()
+
+        # Poll until every active Side answers (or stays silent too long)
+        pending = [s for s in sides if s.active]
+        holes = {}
+        for attempt in range(FW_POLL_TRIES):
+            if not pending:
+                break
+            air_us += FW_POLL_MS * 1000 if attempt else 5000   # answers take a few ms, retries a full poll
+            for s in list(pending):
+                reply = s.nack()        # the offer and the NACK share one loss draw
+                if reply is None:
+                    continue
+                done, _base, missing = reply
+                holes[s.name] = 0 if done else len(missing)
+                need.update(missing)
+                pending.remove(s)
+        for s in pending:
+            print(f"  dropping Side {s.name}: no answer")
+            s.active = False
+
+        active = [s for s in sides if s.active]
+        if not active or all(len(s.got) == chunks for s in active):
+            break
+        if rounds >= FW_MAX_ROUNDS:
+            for s in active:
+                if len(s.got) < chunks:
+                    print(f"  dropping Side {s.name}: too many rounds")
+                    s.active = False
+            break
+        print("  round %d: %s" % (rounds, ", ".join(f"{k} {v} holes" for k, v in sorted(holes.items()))))
+
+    return sides, chunks, sent, rounds, air_us
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__,
+                                 formatter_class=argparse.RawDescriptionHelpFormatter)
+    src = ap.add_mutually_exclusive_group()
+    src.add_argument("--image", help="firmware image to relay")
+    src.add_argument("--size", type=int, default=1_200_000, help="random image of this many bytes")
+    ap.add_argument("--loss", type=float, action="append",
+                    help="packet loss rate per Side, repeat once per Side (default 0.05 0.05)")
+    ap.add_argument("--seed", type=int, default=1)
+    args = ap.parse_args()
+
+    if args.image:
+        with open(args.image, "rb") as f:
+            image = f.read()
+    else:
+        image = random.Random(args.seed).randbytes(args.size)
+    losses = args.loss or [0.05, 0.05]
+    digest = hashlib.sha256(image).hexdigest()
+
+    print(f"image {len(image)} bytes, sha256 {digest[:16]}..., loss {losses}")
+    sides, chunks, sent, rounds, air_us = relay(image, losses, args.seed)
+    print(f"{chunks} chunks: {sent} sent ({sent / chunks:.2f}x), {rounds} round(s), "
+          f"~{air_us / 1e6:.1f} s on air ({len(image) / 1024 / (air_us / 1e6):.1f} KB/s to all Sides)")
+
+    ok = True
+    for s in sides:
+        good = s.active and len(s.got) == chunks and hashlib.sha256(s.image()).hexdigest() == digest
+        print(f"  Side {s.name}: {'verified' if good else 'FAILED'} ({len(s.got)}/{chunks} chunks)")
+        ok &= good
+    sys.exit(0 if ok else 1)
+
+
+if __name__ == "__main__":
+    main()
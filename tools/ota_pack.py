@@ -0,0 +1,57 @@
+#!/usr/bin/env python3
+"""
+Pack a Side firmware image for compressed OTA.
+
+Writes <image>.gz (gzip -9, fixed header so rebuilds are byte-identical) and
+<image>.json with the size and SHA-256 of both. The Side inflates the gzip
+stream straight into flash and checks the SHA-256 of the *raw* image, which
+tools/ota_server.py sends as X-SHA256 (plus X-Image-Size) from the manifest.
+
+    python3 tools/ota_pack.py Seashells_Side/build/esp32.esp32.um_feathers3/Seashells_Side.ino.bin
+
+Then either point OTA_URL_SIDE_BIN at the .gz, or keep the .bin URL: the Side
+sends Accept-Encoding: gzip and ota_server.py answers with the .gz when it
+exists next to the image.
+"""
+
+import argparse
+import gzip
+import hashlib
+import json
+import os
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__,
+                                 formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("image", help="raw firmware .bin")
+    ap.add_argument("--level", type=int, default=9, help="gzip level (1-9)")
+    args = ap.parse_args()
+
+    with open(args.image, "rb") as f:
+        raw = f.read()
+    packed = gzip.compress(raw, compresslevel=args.level, mtime=0)
+
+    gz_path = args.image + ".gz"
+    with open(gz_path, "wb") as f:
+        f.write(packed)
+
+    manifest = {
+        "image": os.path.basename(args.image),
+        "size": len(raw),
+        "sha256": hashlib.sha256(raw).hexdigest(),
+        "gz": os.path.basename(gz_path),
+        "gz_size": len(packed),
+        "gz_sha256": hashlib.sha256(packed).hexdigest(),
+    }
+    with open(args.image + ".json", "w") as f:
+        json.dump(manifest, f, indent=2)
+        f.write("\n")
+
+    print(f"{manifest['image']}: {len(raw)} bytes -> {manifest['gz']}: {len(packed)} bytes "
+          f"({100 * len(packed) / len(raw):.0f}%)")
+    print(f"sha256 {manifest['sha256']}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,178 @@
+#!/usr/bin/env python3
+"""
+Local HTTP stand-in for the OTA server, with timing per Side.
+
+Serves firmware images from a directory like `python3 -m http.server`, plus:
+  - an X-SHA256 header with the image digest, which the Side checks against
+    its streaming hash (OtaUpdate.cpp)
+  - gzip images from tools/ota_pack.py: a request for foo.bin that offers
+    Accept-Encoding: gzip gets foo.bin.gz (Content-Encoding: gzip) when it
+    exists; X-SHA256 and X-Image-Size then describe the raw image
+  - --throttle to cap the send rate (KB/s), mimicking a slow hotspot
+  - Range requests (206 + Content-Range), on the .gz too, so a Side can resume
+  - --drop-after to cut the connection after N bytes, to exercise failures
+  - --drop-random P to cut a transfer at a random offset with probability P,
+    for soaking the Side's reconnect/resume path
+  - one log line per transfer: client, bytes, seconds, KB/s
+
+    python3 tools/ota_server.py Seashells_Side/build/esp32.esp32.um_feathers3
+    python3 tools/ota_server.py . --port 8000 --throttle 200
+    python3 tools/ota_server.py . --drop-random 0.7 --seed 1
+
+Point OTA_URL_SIDE_BIN (ConfigMaster.h) at http://<this host>:<port>/<file>.
+"""
+
+import argparse
+import hashlib
+import http.server
+import json
+import os
+import random
+import re
+import socketserver
+import time
+
+ARGS = None
+RNG = random.Random()
+_digests = {}
+
+
+def sha256_of(path):
+    st = os.stat(path)
+    key = (path, st.st_mtime_ns, st.st_size)
+    if key not in _digests:
+        h = hashlib.sha256()
+        with open(path, "rb") as f:
+            for block in iter(lambda: f.read(1 << 16), b""):
+                h.update(block)
+        _digests[key] = h.hexdigest()
+    return _digests[key]
+
+
+def image_headers(path):
+    """X-SHA256 / X-Image-Size of the flashed image behind `path` (.bin or .bin.gz)."""
+    raw = path[:-3] if path.endswith(".gz") else path
+    try:
+        with open(raw + ".json") as f:
+            m = json.load(f)
+        return m["sha256"], m["size"]
+    except (OSError, ValueError, KeyError):
+        pass
+    if os.path.isfile(raw):
+        return sha256_of(raw), os.path.getsize(raw)
+    return None, None
+
+
+class Handler(http.server.SimpleHTTPRequestHandler):
+    protocol_version = "HTTP/1.0"   # the Side disables keep-alive anyway
+
+    def __init__(self, *a, **kw):
+        super().__init__(*a, directory=ARGS.root, **kw)
+
+    def do_GET(self):
+        path = self.translate_path(self.path)
+        if not os.path.isfile(path):
+            return super().do_GET()
+        digest, image_size = image_headers(path)
+        encoding = None
+        if (not path.endswith(".gz") and os.path.isfile(path + ".gz") and not ARGS.no_gzip
+                and "gzip" in self.headers.get("Accept-Encoding", "")):
+            path, encoding = path + ".gz", "gzip"
+        size = os.path.getsize(path)
+        start = 0
+        m = re.fullmatch(r"bytes=(\d+)-(\d*)", self.headers.get("Range", "").strip())
+        if m:
+            start = int(m.group(1))
+            end = min(int(m.group(2)), size - 1) if m.group(2) else size - 1
+            if start >= size or end < start:
+                self.send_response(416)
+                self.send_header("Content-Range", f"bytes */{size}")
+                self.end_headers()
+                return
+            self.send_response(206)
+            self.send_header("Content-Range", f"bytes {start}-{end}/{size}")
+            length = end - start + 1
+        else:
+            self.send_response(200)
+            length = size
+        self.send_header("Content-Type", "application/octet-stream")
+        self.send_header("Accept-Ranges", "bytes")
+        self.send_header("Content-Length", str(length))
+        if encoding:
+            self.send_header("Content-Encoding", encoding)
+        if digest:
+            self.send_header("X-SHA256", digest)
+            self.send_header("X-Image-Size", str(image_size))
+        self.end_headers()
+        self.send_body(path, start, length)
+
+    def send_body(self, path, start, length):
+        t0 = time.monotonic()
+        sent, dropped = 0, False
+        chunk = ARGS.chunk
+        drop_at = ARGS.drop_after
+        if ARGS.drop_random and length > 1 and RNG.random() < ARGS.drop_random:
+            drop_at = RNG.randrange(1, length)
+        with open(path, "rb") as f:
+            f.seek(start)
+            while sent < length:
+                n = min(chunk, length - sent)
+                if drop_at and sent + n > drop_at:
+                    n = max(0, drop_at - sent)
+                    dropped = True
+                data = f.read(n)
+                try:
+                    self.wfile.write(data)
+                except (BrokenPipeError, ConnectionResetError):
+                    dropped = True
+                    break
+                sent += len(data)
+                if dropped:
+                    break
+                if ARGS.throttle:
+                    ahead = sent / (ARGS.throttle * 1024) - (time.monotonic() - t0)
+                    if ahead > 0:
+                        time.sleep(ahead)
+        dt = time.monotonic() - t0
+        rate = sent / 1024 / dt if dt else 0
+        print(f"[ota] {self.client_address[0]} {os.path.basename(path)} bytes {start}+{sent}/{length} "
+              f"in {dt:.2f} s ({rate:.1f} KB/s){'  DROPPED' if dropped else ''}", flush=True)
+        if dropped:
+            self.close_connection = True
+
+    def log_message(self, fmt, *args):
+        print(f"[http] {self.client_address[0]} {fmt % args}", flush=True)
+
+
+class Server(socketserver.ThreadingMixIn, http.server.HTTPServer):
+    daemon_threads = True
+    allow_reuse_address = True
+
+
+def main():
+    global ARGS
+    ap = argparse.ArgumentParser(description=__doc__,
+                                 formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("root", nargs="?", default=".", help="directory to serve")
+    ap.add_argument("--port", type=int, default=8000)
+    ap.add_argument("--throttle", type=float, default=0, help="max send rate in KB/s (0 = off)")
+    ap.add_argument("--drop-after", type=int, default=0, help="close the connection after N bytes")
+    ap.add_argument("--drop-random", type=float, default=0, metavar="P",
+                    help="cut each transfer at a random offset with probability P")
+    ap.add_argument("--seed", type=int, help="seed for --drop-random (repeatable runs)")
+    ap.add_argument("--chunk", type=int, default=1460, help="bytes per socket write")
+    ap.add_argument("--no-gzip", action="store_true", help="ignore .gz variants (raw baseline)")
+    ARGS = ap.parse_args()
+    if ARGS.seed is not None:
+        RNG.seed(ARGS.seed)
+
+    with Server(("", ARGS.port), Handler) as srv:
+        print(f"serving {os.path.abspath(ARGS.root)} on :{ARGS.port}", flush=True)
+        try:
+            srv.serve_forever()
+        except KeyboardInterrupt:
+            pass
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,184 @@
+#!/usr/bin/env python3
+"""
+Pack Seashells clips into a flash soundbank image (Soundbank.h on the Side).
+
+Point it at a copy of the SD card root (the folder holding manifest.csv):
+
+    python3 tools/pack_soundbank.py /media/sdcard -o soundbank.bin
+    python3 tools/pack_soundbank.py /media/sdcard --ids 1001,1002,1003
+
+Without --ids, clips marked precache=1 go in first, then the rest in manifest
+order, until the partition budget is used. Each clip is trimmed and gets
+loop points with a baked crossfade exactly as the Side does for PSRAM clips
+(ClipAnalysis), since the mapped flash is read-only on the device. The
+crossfade is stored after the clip, which stays as recorded for one-shots;
+the image is read back and checked against the trimmed sources before exit.
+
+Flash it into the "soundbank" partition (see partitions.csv):
+
+    parttool.py --port /dev/ttyACM0 write_partition --partition-name soundbank \\
+        --input soundbank.bin
+"""
+
+import argparse
+import array
+import math
+import os
+import struct
+import sys
+import wave
+
+from clip_trim import find_trim, read_pcm, split_row
+
+MAGIC = b"SSBK"
+VERSION = 2
+HEADER = struct.Struct("<4sHHII")
+ENTRY = struct.Struct("<HHIIII")
+PARTITION_BYTES = 0x9E0000   # soundbank partition in partitions.csv
+
+LOOP_XFADE_SAMPLES = 256     # keep in sync with ConfigSide.h
+LOOP_SEARCH_SAMPLES = 2048
+
+
+def bake_loop(pcm):
+    """Mirror of ClipAnalysis_bakeLoop; returns (loop_start, loop_end, tail) or
+    (0, 0, []). pcm is not modified: tail replaces its [loop_end - len(tail),
+    loop_end) in loop playback only."""
+    n = len(pcm)
+    k = min(LOOP_XFADE_SAMPLES, n // 4)
+    if k < 32:
+        return 0, 0, []
+    search = min(LOOP_SEARCH_SAMPLES, n // 4)
+
+    def slope(i):
+        return pcm[i + 2] - pcm[i - 2]
+
+    def rising(i):
+        return pcm[i - 1] < 0 <= pcm[i]
+
+    ls = k
+    for i in range(k, k + search):
+        if i + 2 >= n:
+            break
+        if rising(i):
+            ls = i
+            break
+
+    ref = slope(ls)
+    le, best = n, None
+    for i in range(n - 3, n - search, -1):
+        if not rising(i):
+            continue
+        if i < ls + 2 * k:
+            break
+        cost = abs(slope(i) - ref) + abs(pcm[i] - pcm[ls])
+        if best is None or cost < best:
+            best, le = cost, i
+    if le < ls + 2 * k:
+        return 0, 0, []
+
+    tail = []
+    for j in range(k):
+        t = (j + 0.5) / k
+        v = pcm[le - k + j] * math.cos(t * math.pi / 2) + pcm[ls - k + j] * math.sin(t * math.pi / 2)
+        tail.append(max(-32768, min(32767, round(v))))
+    return ls, le, tail
+
+
+def verify(path, clips):
+    """Read the image back: every clip's PCM must be its trimmed source, untouched."""
+    with open(path, "rb") as f:
+        img = f.read()
+    _, _, count, _, _ = HEADER.unpack_from(img, 0)
+    assert count == len(clips), "index count"
+    for i, (cid, pcm, _, _, tail) in enumerate(clips):
+        eid, xfade, offset, samples, _, _ = ENTRY.unpack_from(img, HEADER.size + i * ENTRY.size)
+        assert (eid, xfade, samples) == (cid, len(tail), len(pcm)), f"id {cid}: index"
+        got = array.array("h", img[offset:offset + samples * 2])
+        if sys.byteorder == "big":
+            got.byteswap()
+        assert got == pcm, f"id {cid}: one-shot PCM differs from the source"
+
+
+def load_manifest(root):
+    rows = []
+    with open(os.path.join(root, "manifest.csv"), "r") as f:
+        for line in f:
+            line = line.strip()
+            if not line or line.startswith("#") or not line[0].isdigit():
+                continue
+            row = split_row(line)
+            if row is None or row[0][5].strip().lower() == "tones":
+                continue
+            fields, trim = row[0], row[1] or (0, 0)
+            rows.append((int(fields[0]), fields[2].strip(), fields[3].strip() == "1", trim))
+    return rows
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__,
+                                 formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("root", help="SD card root containing manifest.csv")
+    ap.add_argument("-o", "--out", default="soundbank.bin")
+    ap.add_argument("--ids", help="comma-separated clip IDs to pack, in order")
+    ap.add_argument("--budget", type=int, default=PARTITION_BYTES, help="image size limit (bytes)")
+    ap.add_argument("--rate", type=int, default=44100, help="engine SAMPLE_RATE")
+    ap.add_argument("--threshold-db", type=float, default=-50.0)
+    ap.add_argument("--pad-ms", type=int, default=4)
+    args = ap.parse_args()
+
+    rows = load_manifest(args.root)
+    if args.ids:
+        by_id = {r[0]: r for r in rows}
+        order = [by_id[int(x)] for x in args.ids.split(",") if int(x) in by_id]
+    else:
+        order = [r for r in rows if r[2]] + [r for r in rows if not r[2]]
+
+    clips, used = [], 0
+    for cid, path, _, (ts, te) in order:
+        try:
+            pcm, rate = read_pcm(os.path.join(args.root, path.lstrip("/")))
+        except (OSError, ValueError, wave.Error) as e:
+            print(f"  {cid:>5}  {path}: skipped ({e})")
+            continue
+        if rate != args.rate:
+            print(f"  {cid:>5}  {path}: skipped ({rate} Hz != {args.rate} Hz)")
+            continue
+        if (ts, te) == (0, 0):
+            ts, te = find_trim(pcm, rate, args.threshold_db, args.pad_ms)
+        pcm = pcm[ts:te or len(pcm)]
+        ls, le, tail = bake_loop(pcm)
+
+        size = ((len(pcm) + len(tail)) * 2 + 3) & ~3
+        if HEADER.size + ENTRY.size * (len(clips) + 1) + used + size > args.budget:
+            print(f"  {cid:>5}  {path}: does not fit, stays on SD")
+            continue
+        clips.append((cid, pcm, ls, le, tail))
+        used += size
+
+    index_bytes = HEADER.size + ENTRY.size * len(clips)
+    offset = (index_bytes + 3) & ~3
+    entries, blobs = [], []
+    for cid, pcm, ls, le, tail in clips:
+        data = pcm + array.array("h", tail)
+        if sys.byteorder == "big":
+            data.byteswap()
+        blob = data.tobytes()
+        blob += b"\0" * (-len(blob) % 4)
+        entries.append(ENTRY.pack(cid, len(tail), offset, len(pcm), ls, le))
+        blobs.append(blob)
+        print(f"  {cid:>5}  {len(pcm) / args.rate:6.2f} s  @0x{offset:06x}  loop {ls}..{le}")
+        offset += len(blob)
+
+    with open(args.out, "wb") as f:
+        f.write(HEADER.pack(MAGIC, VERSION, len(clips), args.rate, offset))
+        f.write(b"".join(entries))
+        f.write(b"\0" * (((index_bytes + 3) & ~3) - index_bytes))
+        f.write(b"".join(blobs))
+    verify(args.out, clips)
+    print(f"wrote {args.out}: {len(clips)} clips, {offset / 1024:.0f} KB "
+          f"of {args.budget / 1024:.0f} KB")
+
+
+if __name__ == "__main__":
+    main()
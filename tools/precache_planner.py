@@ -0,0 +1,296 @@
+#!/usr/bin/env python3
+"""
+Plan the manifest.csv precache column from how often the Master's level rules
+actually pick each clip, instead of by hand.
+
+Point it at a copy of the SD card root (the folder holding manifest.csv):
+
+    python3 tools/precache_planner.py /media/sdcard --budget-kb 6144
+    python3 tools/precache_planner.py /media/sdcard -o manifest_planned.csv
+
+How it works:
+  1. Monte-Carlo the three level builders from Seashells_Master.ino over the
+     manifest buckets (same caps, fallbacks and unique-first fill), weighted
+     by how many rounds a game spends in each level (--level-weights).
+  2. Each clip's value is the expected number of times per round a Side has
+     to load it: once per Side whose 4 slots contain it (repeats within a
+     Side share one copy).
+  3. Pick the set with the highest total value whose PCM bytes fit the
+     budget and the Side's 64-entry cache, via a 0/1 knapsack over KB with a
+     per-item price tuned until the entry cap holds.
+
+Tones (base=tones) are synthesized on the Side and never planned. Sizes honor
+the trim_start/trim_end columns when present (tools/clip_trim.py).
+"""
+
+import argparse
+import os
+import random
+import wave
+from collections import defaultdict
+
+from clip_trim import N_FIELDS
+
+CACHE_ENTRIES = 64      # CacheEntry cache[64] in Seashells_Side/Manifest.cpp
+
+
+class Clip:
+    def __init__(self, fields):
+        self.id = int(fields[0])
+        self.path = fields[2].strip()
+        self.precache = fields[3].strip() == "1"
+        self.base, self.sub, self.sub2 = (f.strip() for f in fields[5:8])
+        self.trim = (int(fields[9]), int(fields[10])) if len(fields) >= 11 else (0, 0)
+        self.bytes = 0
+
+
+# ---------- Master level builders (mirror Seashells_Master.ino) ----------
+
+class Master:
+    def __init__(self, clips, rng):
+        self.clips = clips
+        self.rng = rng
+
+    def _unique(self, key, match=lambda c: True, cap=16):
+        out, seen = [], set()
+        for c in self.clips:
+            if not match(c):
+                continue
+            k = key(c).lower()
+            if k in seen:
+                continue
+            if len(out) >= cap:
+                break
+            seen.add(k)
+            out.append(key(c))
+        return out
+
+    def _ids(self, match, cap=32):
+        return [c.id for c in self.clips if match(c)][:cap]
+
+    def _shuffle(self, arr):
+        for i in range(len(arr) - 1):
+            j = i + self.rng.randrange(len(arr) - i)
+            arr[i], arr[j] = arr[j], arr[i]
+
+    def _fill7(self, unique):
+        if not unique:
+            return [0] * 7
+        self._shuffle(unique)
+        return [unique[i] if i < len(unique) else unique[self.rng.randrange(len(unique))]
+                for i in range(7)]
+
+    def _any(self):
+        return self.clips[self.rng.randrange(len(self.clips))].id
+
+    def _pick_odd(self, ids):
+        if not ids:
+            return self._any()
+        self._shuffle(ids)
+        return ids[0]
+
+    def _place(self, same, odd):
+        side_odd, odd_slot = self.rng.randrange(2), self.rng.randrange(4)
+        it = iter(same)
+        a = [odd if (side_odd == 0 and i == odd_slot) else next(it) for i in range(4)]
+        b = [odd if (side_odd == 1 and i == odd_slot) else next(it) for i in range(4)]
+        return a, b
+
+    def bases(self):
+        return self._unique(lambda c: c.base, cap=8)
+
+    def level2(self):
+        bases = self.bases()
+        im = self.rng.randrange(len(bases))
+        io = self.rng.randrange(len(bases) - 1) if len(bases) > 1 else im
+        if len(bases) > 1 and io >= im:
+            io += 1
+        main, odd = bases[im].lower(), bases[io].lower()
+        uniq = self._ids(lambda c: c.base.lower() == main)
+        same = self._fill7(uniq) if uniq else [self._any() for _ in range(7)]
+        return self._place(same, self._pick_odd(self._ids(lambda c: c.base.lower() == odd)))
+
+    def level1(self):
+        bases = self.bases()
+        if len(bases) < 2:
+            return self.level2()
+        im = self.rng.randrange(len(bases))
+        main = bases[im].lower()
+        fams = self._unique(lambda c: c.sub2, lambda c: c.base.lower() == main)
+        if not fams:
+            return self.level2()
+        fam = fams[self.rng.randrange(len(fams))].lower()
+        io = self.rng.randrange(len(bases) - 1)
+        if io >= im:
+            io += 1
+        odd = bases[io].lower()
+        uniq = self._ids(lambda c: c.base.lower() == main and c.sub2.lower() == fam)
+        if not uniq:
+            return self.level2()
+        same = self._fill7(uniq)
+        return self._place(same, self._pick_odd(self._ids(lambda c: c.base.lower() == odd)))
+
+    def level3(self):
+        bases = self.bases()
+        if not bases:
+            return self.level2()
+        main, subs = None, []
+        for _ in range(len(bases) * 2):
+            cand = bases[self.rng.randrange(len(bases))].lower()
+            s = self._unique(lambda c: c.sub, lambda c: c.base.lower() == cand)
+            if len(s) >= 2:
+                main, subs = cand, s
+                break
+        if main is None:
+            return self.level2()
+        i_same = self.rng.randrange(len(subs))
+        i_odd = self.rng.randrange(len(subs) - 1)
+        if i_odd >= i_same:
+            i_odd += 1
+        s_same, s_odd = subs[i_same].lower(), subs[i_odd].lower()
+        uniq = self._ids(lambda c: c.base.lower() == main and c.sub.lower() == s_same)
+        if not uniq:
+            return self.level2()
+        same = self._fill7(uniq)
+        odd_ids = self._ids(lambda c: c.base.lower() == main and c.sub.lower() == s_odd)
+        if odd_ids:
+            odd = self._pick_odd(odd_ids)
+        else:
+            by_base = self._ids(lambda c: c.base.lower() == main)
+            odd = by_base[self.rng.randrange(len(by_base))] if by_base else self._any()
+        return self._place(same, odd)
+
+
+# ---------- Planning ----------
+
+def simulate(clips, rounds, weights, seed):
+    """Return (per-clip loads per round, list of per-round side scenes)."""
+    master = Master(clips, random.Random(seed))
+    levels = [master.level1, master.level2, master.level3]
+    pick = random.Random(seed + 1)
+    loads = defaultdict(float)
+    scenes = []
+    for _ in range(rounds):
+        a, b = pick.choices(levels, weights)[0]()
+        scenes.append((a, b))
+        for side in (a, b):
+            for cid in set(side):
+                loads[cid] += 1.0 / rounds
+    return loads, scenes
+
+
+def sd_reads(scenes, cached, files):
+    """Expected SD-backed clip loads per round, per Side (unique per scene)."""
+    total = 0
+    for a, b in scenes:
+        for side in (a, b):
+            total += sum(1 for cid in set(side) if cid in files and cid not in cached)
+    return total / (2 * len(scenes))
+
+
+def knapsack(items, budget_kb, price):
+    """items: [(id, kb, value)]; maximize sum(value - price) within budget_kb."""
+    best = [0.0] * (budget_kb + 1)
+    take = []
+    for _, kb, value in items:
+        v = value - price
+        row = bytearray(budget_kb + 1)
+        if v > 0:
+            for w in range(budget_kb, kb - 1, -1):
+                cand = best[w - kb] + v
+                if cand > best[w]:
+                    best[w] = cand
+                    row[w] = 1
+        take.append(row)
+    chosen, w = set(), budget_kb
+    for i in range(len(items) - 1, -1, -1):
+        if take[i][w]:
+            chosen.add(items[i][0])
+            w -= items[i][1]
+    return chosen
+
+
+def plan(items, budget_kb, cap):
+    chosen = knapsack(items, budget_kb, 0.0)
+    if len(chosen) <= cap:
+        return chosen
+    lo, hi = 0.0, max(v for _, _, v in items)
+    for _ in range(24):   # raise the per-entry price until the cap holds
+        mid = (lo + hi) / 2
+        c = knapsack(items, budget_kb, mid)
+        if len(c) > cap:
+            lo = mid
+        else:
+            hi, chosen = mid, c
+    return chosen
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__,
+                                 formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("root", help="SD card root containing manifest.csv")
+    ap.add_argument("-o", "--out", help="write the manifest with the planned precache column")
+    ap.add_argument("--budget-kb", type=int, default=6144, help="PSRAM for the precache (KB)")
+    ap.add_argument("--level-weights", default="1,1,3",
+                    help="relative number of rounds played at levels 1,2,3")
+    ap.add_argument("--rounds", type=int, default=20000, help="simulated rounds")
+    ap.add_argument("--seed", type=int, default=1)
+    args = ap.parse_args()
+
+    with open(os.path.join(args.root, "manifest.csv"), "r") as f:
+        lines = [l.rstrip("\r\n") for l in f]
+    clips = []
+    for line in lines:
+        fields = line.split(",")
+        if line and line[0].isdigit() and len(fields) >= N_FIELDS and int(fields[0]) != 0:
+            clips.append(Clip(fields))
+    if not clips:
+        raise SystemExit("no clips in manifest")
+
+    files = {}
+    for c in clips:
+        if c.base.lower() == "tones":
+            continue
+        try:
+            with wave.open(os.path.join(args.root, c.path.lstrip("/")), "rb") as w:
+                n = w.getnframes()
+        except (OSError, wave.Error):
+            continue
+        ts, te = c.trim
+        c.bytes = ((te or n) - ts) * 2
+        files[c.id] = c
+
+    weights = [float(x) for x in args.level_weights.split(",")]
+    loads, scenes = simulate(clips, args.rounds, weights, args.seed)
+
+    items = [(cid, max(1, (c.bytes + 1023) // 1024), loads.get(cid, 0.0))
+             for cid, c in files.items() if loads.get(cid, 0.0) > 0]
+    chosen = plan(items, args.budget_kb, CACHE_ENTRIES)
+
+    before = {cid for cid, c in files.items() if c.precache}
+    print("  id     loads/round   KB  before after  path")
+    for cid, kb, v in sorted(items, key=lambda t: -t[2]):
+        print(f"  {cid:>5}  {v:10.4f}  {kb:5d}    {'x' if cid in before else ' '}     "
+              f"{'x' if cid in chosen else ' '}   {files[cid].path}")
+
+    kb_before = sum((files[c].bytes + 1023) // 1024 for c in before)
+    kb_after = sum(kb for cid, kb, _ in items if cid in chosen)
+    print(f"\nbefore: {len(before):3d} clips {kb_before:6d} KB  "
+          f"SD reads/round/side {sd_reads(scenes, before, files):.2f}")
+    print(f"after:  {len(chosen):3d} clips {kb_after:6d} KB  "
+          f"SD reads/round/side {sd_reads(scenes, chosen, files):.2f}  "
+          f"(budget {args.budget_kb} KB, {CACHE_ENTRIES} entries)")
+
+    if args.out:
+        with open(args.out, "w") as f:
+            for line in lines:
+                fields = line.split(",")
+                if line and line[0].isdigit() and len(fields) >= N_FIELDS:
+                    fields[3] = "1" if int(fields[0]) in chosen else "0"
+                    line = ",".join(fields)
+                f.write(line + "\n")
+        print(f"wrote {args.out}")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,207 @@
+#!/usr/bin/env python3
+"""
+Merge Seashells event traces (Trace.h) from Master and Sides onto one timeline.
+
+Capture the serial output of each device after pressing 't' (a whole serial log
+is fine; only the #TRACE block is used), then:
+
+    python3 tools/trace_merge.py master.log sideA.log sideB.log
+
+Clock alignment: every Side clock is mapped onto the Master clock using the
+packets that cross between them. For Master->Side packets rx_side - tx_master =
+offset + latency, for Side->Master packets rx_master - tx_side = -offset +
+latency. Taking the minimum of each direction and assuming symmetric one-way
+latency gives offset = (min_down - min_up) / 2. With traffic in only one
+direction the minimum one-way delta is used (biased by the radio latency).
+"""
+
+import argparse
+import re
+import sys
+from collections import Counter, defaultdict
+
+EVENTS = {
+    1: "PKT_TX", 2: "PKT_RX", 3: "SCENE_COMMIT", 4: "FIRST_AUDIO",
+    5: "BTN_EDGE", 6: "BLINK_START", 7: "MARK",
+}
+
+MSG_TYPES = {
+    0: "HELLO_REQ", 1: "HELLO", 2: "SET_SCENE", 3: "REQUEST_RANDOM_SET",
+    4: "RANDOM_SET_REPLY", 5: "PLAY_SLOT", 6: "LED_ALL_WHITE", 7: "BLINK_ALL",
+    8: "GAME_MODE", 9: "BTN_EVENT", 10: "START_LOOP_ALL", 11: "STOP_ALL",
+    12: "OTA_UPDATE", 13: "OTA_STATUS", 14: "ROLE_ASSIGN", 15: "HEARTBEAT",
+    16: "PLAY_ONESHOT",
+    17: "FW_OFFER",
+    18: "FW_CHUNK",
+    19: "FW_NACK",
+    20: "FW_COMMIT",
+    21: "ASSET_SYNC",
+    22: "MANIFEST_RELOAD",
+}
+
+PEER_MASTER = 0xFF
+BIN_US = 2_000             # histogram bin used to find matching packet pairs
+MATCH_WINDOW_US = 50_000   # a packet that takes longer than this is not a match
+
+HDR_RE = re.compile(r"#TRACE dev=(\S)")
+REC_RE = re.compile(r"^T ([0-9a-fA-F]{8}) ([0-9a-fA-F]{2}) ([0-9a-fA-F]{2}) ([0-9a-fA-F]{4})\s*$")
+
+
+def parse_dump(path):
+    """Return (dev, [(t_us, ev, a, b), ...]) with 32-bit timestamps unwrapped."""
+    dev, recs, in_block = None, [], False
+    with open(path, "r", errors="replace") as f:
+        for line in f:
+            line = line.strip()
+            m = HDR_RE.match(line)
+            if m and not line.startswith("#TRACE end"):
+                dev, recs, in_block = m.group(1), [], True   # keep the last dump only
+                continue
+            if line.startswith("#TRACE end"):
+                in_block = False
+                continue
+            if not in_block:
+                continue
+            m = REC_RE.match(line)
+            if m:
+                recs.append(tuple(int(g, 16) for g in m.groups()))
+    if dev is None:
+        sys.exit(f"{path}: no #TRACE block found")
+
+    out, wrap, last = [], 0, None
+    for t, ev, a, b in recs:
+        if ev == 0:
+            continue
+        if last is not None and t < last and last - t > (1 << 31):
+            wrap += 1 << 32
+        last = t
+        out.append((t + wrap, ev, a, b))
+    return dev, out
+
+
+def min_delta(tx, rx):
+    """Smallest one-way rx - tx delta over matching packets of the same type.
+
+    The two clocks start at unrelated boot times, so pairs are matched first:
+    every same-type (tx, rx) pair votes for its delta in a coarse histogram,
+    true pairs pile up on offset + latency, and the minimum is taken inside
+    that cluster only.
+    """
+    by_type = defaultdict(list)
+    for t, typ in tx:
+        by_type[typ].append(t)
+    deltas = [t_rx - t_tx for t_rx, typ in rx for t_tx in by_type.get(typ, ())]
+    if not deltas:
+        return None
+
+    votes = Counter(d // BIN_US for d in deltas)
+    best = max(votes, key=lambda k: votes[k] + votes.get(k + 1, 0))
+    lo, hi = best * BIN_US, best * BIN_US + MATCH_WINDOW_US
+    return min(d for d in deltas if lo <= d < hi)
+
+
+def side_offset(master, side, side_idx):
+    """Offset to add to side timestamps to land on the Master clock."""
+    m_tx = [(t, a) for t, ev, a, b in master if ev == 1 and b == side_idx]
+    m_rx = [(t, a) for t, ev, a, b in master if ev == 2 and b == side_idx]
+    s_tx = [(t, a) for t, ev, a, b in side if ev == 1 and b == PEER_MASTER]
+    s_rx = [(t, a) for t, ev, a, b in side if ev == 2 and b == PEER_MASTER]
+
+    down = min_delta(m_tx, s_rx)   # offset_side_minus_master + latency
+    up = min_delta(s_tx, m_rx)     # -(offset_side_minus_master) + latency
+    if down is not None and up is not None:
+        return -(down - up) / 2.0
+    if down is not None:
+        return -float(down)
+    if up is not None:
+        return float(up)
+    return None
+
+
+def describe(ev, a, b):
+    name = EVENTS.get(ev, f"EV{ev}")
+    if ev in (1, 2):
+        peer = {0: "A", 1: "B", PEER_MASTER: "M"}.get(b, str(b))
+        arrow = "->" if ev == 1 else "<-"
+        return f"{name:<12} {arrow} {peer}  {MSG_TYPES.get(a, a)}"
+    if ev == 3:
+        return f"{name:<12} mask={a:04b} id0={b}"
+    if ev == 4:
+        return f"{name:<12} slot={a} sample={b}"
+    if ev == 5:
+        return f"{name:<12} slot={a} {'press' if b else 'release'}"
+    if ev == 6:
+        color = {0: "red", 1: "green", 2: "white"}.get(a, a)
+        return f"{name:<12} {color} on={b}ms"
+    return f"{name:<12} a={a} b={b}"
+
+
+def latency_report(timeline):
+    """Press -> Master sees it -> first feedback (blink or audio) per press."""
+    rows = []
+    for i, (t, dev, ev, a, b) in enumerate(timeline):
+        if ev != 5 or b != 1:
+            continue
+        seen = fb = None
+        for t2, dev2, ev2, a2, b2 in timeline[i + 1:]:
+            if t2 - t > 5_000_000:
+                break
+            if seen is None and dev2 == "M" and ev2 == 2 and a2 == 9:
+                seen = t2
+            if ev2 == 6 or (ev2 == 4 and dev2 == dev and a2 == a):
+                fb = (t2, dev2, EVENTS[ev2])
+                break
+        rows.append((t, dev, a, seen, fb))
+
+    if not rows:
+        print("\nNo button presses in trace.")
+        return
+    print("\nPress -> feedback latency")
+    lat = []
+    for t, dev, slot, seen, fb in rows:
+        s = f"  {dev} slot{slot} @{t / 1000:10.3f}ms"
+        if seen is not None:
+            s += f"  master+{(seen - t) / 1000:7.2f}ms"
+        if fb is not None:
+            lat.append(fb[0] - t)
+            s += f"  {fb[2]}({fb[1]})+{(fb[0] - t) / 1000:7.2f}ms"
+        else:
+            s += "  (no feedback)"
+        print(s)
+    if lat:
+        lat.sort()
+        print(f"  n={len(lat)} min={lat[0] / 1000:.2f}ms "
+              f"median={lat[len(lat) // 2] / 1000:.2f}ms max={lat[-1] / 1000:.2f}ms")
+
+
+def main():
+    ap = argparse.ArgumentParser(description=__doc__,
+                                 formatter_class=argparse.RawDescriptionHelpFormatter)
+    ap.add_argument("logs", nargs="+", help="serial logs containing a #TRACE dump")
+    args = ap.parse_args()
+
+    dumps = dict(parse_dump(p) for p in args.logs)
+    master = dumps.get("M")
+    timeline = []
+    for dev, recs in dumps.items():
+        off = 0.0
+        if dev != "M":
+            idx = {"A": 0, "B": 1}.get(dev)
+            off = side_offset(master, recs, idx) if (master and idx is not None) else None
+            if off is None:
+                print(f"# {dev}: no packets shared with Master, clock left unaligned")
+                off = 0.0
+            else:
+                print(f"# {dev}: clock offset {off / 1000:+.3f} ms vs Master")
+        timeline.extend((t + off, dev, ev, a, b) for t, ev, a, b in recs)
+
+    timeline.sort(key=lambda r: r[0])
+    t0 = timeline[0][0] if timeline else 0
+    for t, dev, ev, a, b in timeline:
+        print(f"{(t - t0) / 1000:12.3f} ms  {dev}  {describe(ev, a, b)}")
+
+    latency_report([(t - t0, d, e, a, b) for t, d, e, a, b in timeline])
+
+
+if __name__ == "__main__":
+    main()